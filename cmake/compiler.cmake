@@ -113,3 +113,31 @@ if (WITH_PYTHON)
         list(APPEND LINK_LIBS ${PYTHON_LIBRARIES})
     endif()
 endif()
+
+#lock-based queues of mini-batches instead of the lock-free ones
+if (USE_BLOCK_QUEUE)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DUSE_BLOCK_QUEUE")
+else()
+    set(USE_BLOCK_QUEUE OFF)
+endif()
+
+#detect compression libraries for compressed input
+find_package(ZLIB)
+if (ZLIB_FOUND)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAS_ZLIB")
+    include_directories(${ZLIB_INCLUDE_DIRS})
+    list(APPEND LINK_LIBS ${ZLIB_LIBRARIES})
+else()
+    set(ZLIB_FOUND FALSE)
+endif()
+
+find_path(ZSTD_INCLUDE_DIR zstd.h)
+find_library(ZSTD_LIBRARY NAMES zstd zstd_static)
+if (ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+    set(ZSTD_FOUND TRUE)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAS_ZSTD")
+    include_directories(${ZSTD_INCLUDE_DIR})
+    list(APPEND LINK_LIBS ${ZSTD_LIBRARY})
+else()
+    set(ZSTD_FOUND FALSE)
+endif()
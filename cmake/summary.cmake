@@ -33,4 +33,13 @@ if(WIN32)
     message(STATUS "    Linker flags (Debug):"    ${CMAKE_SHARED_LINKER_FLAGS_DEBUG})
 endif()
 
+message(STATUS "")
+message(STATUS "  Mini-batch queue:")
+message(STATUS "    lock-based (USE_BLOCK_QUEUE):" ${USE_BLOCK_QUEUE})
+
+message(STATUS "")
+message(STATUS "  Compressed input:")
+message(STATUS "    gzip (zlib):"      ${ZLIB_FOUND})
+message(STATUS "    zstd:"             ${ZSTD_FOUND})
+
 #message(STATUS "    Linked Libraries"       ${LINKED_LIBS})
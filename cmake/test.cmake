@@ -1,4 +1,4 @@
-set(src_dirs util pario model)
+set(src_dirs util pario model tools)
 foreach (src_dir ${src_dirs})
     file(GLOB ${src_dir}_src
         "${PROJECT_SOURCE_DIR}/test/${src_dir}/*.cpp"
@@ -13,3 +13,8 @@ foreach (src_dir ${src_dirs})
         list(APPEND test_targets ${tgt_name})
     endforeach()
 endforeach()
+
+# the tools are run by their tests
+if (TARGET test_sol_server)
+    add_dependencies(test_sol_server sol_server sol_test)
+endif()
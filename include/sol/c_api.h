@@ -51,6 +51,14 @@ SOL_EXPORTS void sol_ReleaseDataIter(void** data_iter);
 SOL_EXPORTS int sol_LoadData(void* data_iter, const char* path,
                              const char* format, int pass_num);
 
+/// \brief  set the maximum number of data readers running at the same time,
+/// each call of sol_LoadData adds a reader
+///
+/// \param data_iter data iteration instance
+/// \param reader_num maximum number of running readers, 1 to read the loaded
+/// data one after another
+SOL_EXPORTS void sol_SetMaxRunningReaderNum(void* data_iter, int reader_num);
+
 /// \brief  create a new model for learning or prediction
 ///
 /// \param name name of the model (algorithm)
@@ -59,7 +67,8 @@ SOL_EXPORTS int sol_LoadData(void* data_iter, const char* path,
 /// \return pointer to the created model
 SOL_EXPORTS void* sol_CreateModel(const char* name, int class_num);
 
-/// \brief  restore a model from a saved file
+/// \brief  restore a model from a saved file, in either the text or the
+/// binary format
 ///
 /// \param model_path path to the saved file
 ///
@@ -74,6 +83,15 @@ SOL_EXPORTS void* sol_RestoreModel(const char* model_path);
 /// \return status code, 0 if succeed
 SOL_EXPORTS int sol_SaveModel(void* model, const char* model_path);
 
+/// \brief  save a model to a file in the binary format, the parameters of the
+/// restored model are mapped from the file without parsing
+///
+/// \param model model to be saved
+/// \param model_path path to save the model
+///
+/// \return status code, 0 if succeed
+SOL_EXPORTS int sol_SaveModelBinary(void* model, const char* model_path);
+
 /// \brief  release model instance
 ///
 /// \param model pointer to model pointer
@@ -137,17 +155,44 @@ typedef void (*sol_predict_callback)(void* user_context, double label,
                                      double predict, int cls_num,
                                      float* scores);
 
-/// \brief  predict the scores on the given data
+/// \brief  predict the scores on the given data, with multiple threads if the
+/// model parameter 'threads' is set
 ///
 /// \param model model to be tested
 /// \param data_iter data iterator
-/// \param callback callback to handle the predicted results
+/// \param callback callback to handle the predicted results, called on the
+/// calling thread in the order of the data
 /// \param user_context flexible place to handle predicted results
 ///
 /// \return number of samples processed
 SOL_EXPORTS int sol_Predict(void* model, void* data_iter,
                             sol_predict_callback callback, void* user_context);
 
+/// \brief  predict the data into arrays of the caller, with multiple threads if
+/// the model parameter 'threads' is set
+///
+/// \param model model to be tested
+/// \param data_iter data iterator
+/// \param n_samples number of samples the arrays can hold
+/// \param labels groundtruth labels, shape = [n_samples], may be NULL
+/// \param predicts predicted labels, shape = [n_samples], may be NULL
+/// \param scores predicted scores, shape = [n_samples, clf_num] in row-major
+/// order, may be NULL
+///
+/// \return number of samples processed, or -1 if the data has more than
+/// n_samples samples
+SOL_EXPORTS int sol_PredictBatch(void* model, void* data_iter, int n_samples,
+                                 double* labels, double* predicts,
+                                 float* scores);
+
+/// \brief  get the number of classifiers of the model, which is the number of
+/// scores of each sample
+///
+/// \param model model
+///
+/// \return number of classifiers
+SOL_EXPORTS int sol_model_clf_num(void* model);
+
 /// \brief  get the model sparsity
 ///
 /// \param model pretrained model
@@ -176,6 +221,104 @@ typedef void (*sol_inspect_iterate_callback)(void* user_context,
 SOL_EXPORTS void sol_InspectOnlineIteration(
     void* model, sol_inspect_iterate_callback callback, void* user_context);
 
+/// \brief  element types of the arrays in memory
+enum sol_data_type {
+  sol_float32 = 0,
+  sol_float64 = 1,
+  sol_int32 = 2,
+  sol_int64 = 3,
+};
+
+/// \brief  load a dense matrix in memory, the arrays are read in place and
+/// must be kept unchanged until the data is iterated
+///
+/// \param data_iter data iteration instance
+/// \param X feature values, row i starts at (char*)X + i * row_stride, zero
+/// values are skipped
+/// \param x_type element type of X, sol_float32 or sol_float64
+/// \param Y labels, NULL if not labeled
+/// \param y_type element type of Y
+/// \param n_samples number of rows
+/// \param n_features number of columns
+/// \param row_stride number of bytes between the starts of two rows
+/// \param pass_num number of passes to iterate the data
+///
+/// \return status code, 0 if succeed
+SOL_EXPORTS int sol_LoadDenseData(void* data_iter, const void* X, int x_type,
+                                  const void* Y, int y_type,
+                                  long long n_samples, long long n_features,
+                                  long long row_stride, int pass_num);
+
+/// \brief  load a matrix in compressed sparse row format in memory, the
+/// arrays are read in place and must be kept unchanged until the data is
+/// iterated
+///
+/// \param data_iter data iteration instance
+/// \param indptr row i is in [indptr[i], indptr[i + 1]) of indices and values
+/// \param indptr_type element type of indptr, sol_int32 or sol_int64
+/// \param indices zero-based column indexes
+/// \param index_type element type of indices, sol_int32 or sol_int64
+/// \param values feature values
+/// \param value_type element type of values, sol_float32 or sol_float64
+/// \param Y labels, NULL if not labeled
+/// \param y_type element type of Y
+/// \param n_samples number of rows
+/// \param canonical non-zero if the indexes of each row are sorted and unique,
+/// the rows are not sorted then
+/// \param pass_num number of passes to iterate the data
+///
+/// \return status code, 0 if succeed
+SOL_EXPORTS int sol_LoadCsrData(void* data_iter, const void* indptr,
+                                int indptr_type, const void* indices,
+                                int index_type, const void* values,
+                                int value_type, const void* Y, int y_type,
+                                long long n_samples, int canonical,
+                                int pass_num);
+
+/// \brief  continue training an online model with a dense matrix in memory on
+/// the calling thread, see sol_LoadDenseData for the arguments
+///
+/// \param model online model to be trained
+///
+/// \return training error rate on the matrix, -1 if failed
+SOL_EXPORTS float sol_PartialFitDense(void* model, const void* X, int x_type,
+                                      const void* Y, int y_type,
+                                      long long n_samples,
+                                      long long n_features,
+                                      long long row_stride);
+
+/// \brief  continue training an online model with a csr matrix in memory on
+/// the calling thread, see sol_LoadCsrData for the arguments
+///
+/// \param model online model to be trained
+///
+/// \return training error rate on the matrix, -1 if failed
+SOL_EXPORTS float sol_PartialFitCsr(void* model, const void* indptr,
+                                    int indptr_type, const void* indices,
+                                    int index_type, const void* values,
+                                    int value_type, const void* Y, int y_type,
+                                    long long n_samples, int canonical);
+
+/// \brief  enable or disable the timing counters of the pipeline stages
+/// (read, wait, preprocess, predict, gradient, update), the counters are kept
+/// when disabled
+///
+/// \param enable non-zero to enable
+SOL_EXPORTS void sol_EnableProfiling(int enable);
+
+/// \brief  clear the timing counters of the pipeline stages
+SOL_EXPORTS void sol_ResetProfiling();
+
+/// \brief  get the report of the timing counters in json, the report includes
+/// the elapsed time, so its length may change between calls
+///
+/// \param buf buffer to hold the report, NULL to get the length only
+/// \param buf_size size of the buffer, the report is truncated if it is not
+/// less than buf_size
+///
+/// \return length of the report
+SOL_EXPORTS int sol_GetProfilingReport(char* buf, int buf_size);
+
 #ifdef HAS_NUMPY_DEV
 #include <Python.h>
 #include <numpy/arrayobject.h>
@@ -147,6 +147,31 @@ inline DType reduce(const Exp<EType, DType, ExprType::kDense> &exp) {
 }
 
 // dense matrix with sparse matrix operations
+
+/// \brief  kernel to apply the first sz elements of a sparse expression to
+/// a dense array, specialized in sparse_vector.h for sparse vectors
+template <typename OP, typename EType, typename DType, typename = void>
+struct DenseSparseKernel {
+  inline static void Calc(DType *pdata, const EType &svec, size_t sz) {
+    for (size_t idx = 0; idx < sz; ++idx) {
+      OP::template map<DType>(pdata[svec.index(idx)], svec.value(idx));
+    }
+  }
+};
+
+/// \brief  kernel of the dot product of a dense expression and the first sz
+/// elements of a sparse expression, specialized in sparse_vector.h
+template <typename OP, typename EType1, typename EType2, typename DType>
+struct DenseSparseDotKernel {
+  inline static DType Calc(const EType1 &lhs, const EType2 &rhs, size_t sz) {
+    DType val = 0;
+    for (size_t idx = 0; idx < sz; ++idx) {
+      val += OP::template map<DType>(lhs[rhs.index(idx)], rhs.value(idx));
+    }
+    return val;
+  }
+};
+
 template <typename OP, typename CType, typename DType, typename EType>
 void CalcExp(MatrixExp<CType, DType, ExprType::kDense> &dst,
              const Exp<EType, DType, ExprType::kSparse> &exp) {
@@ -158,9 +183,7 @@ void CalcExp(MatrixExp<CType, DType, ExprType::kDense> &dst,
   size_t sz = svec.shape().size();
   while (sz > 0 && svec.index(sz - 1) >= dsz) --sz;
 
-  for (size_t idx = 0; idx < sz; ++idx) {
-    OP::template map<DType>(pdata[svec.index(idx)], svec.value(idx));
-  }
+  DenseSparseKernel<OP, EType, DType>::Calc(pdata, svec, sz);
 }
 
 template <typename OP, typename EType1, typename EType2, typename DType>
@@ -171,12 +194,8 @@ inline DType dot(const Exp<EType1, DType, ExprType::kDense> &lhs,
   size_t lhs_sz = exp_val1.shape().size();
   size_t sz = exp_val2.shape().size();
   while (sz > 0 && exp_val2.index(sz - 1) >= lhs_sz) --sz;
-  DType val = 0;
-  for (size_t idx = 0; idx < sz; ++idx) {
-    val += OP::template map<DType>(exp_val1[exp_val2.index(idx)],
-                                   exp_val2.value(idx));
-  }
-  return val;
+  return DenseSparseDotKernel<OP, EType1, EType2, DType>::Calc(exp_val1,
+                                                               exp_val2, sz);
 }
 
 // sparse matrix operations
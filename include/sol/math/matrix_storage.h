@@ -18,9 +18,11 @@ namespace math {
 template <typename DType>
 class MatrixStorage {
  public:
-  MatrixStorage() : begin_(nullptr), size_(0) {}
+  MatrixStorage() : begin_(nullptr), size_(0), owned_(true) {}
 
-  ~MatrixStorage() { DeleteArray(this->begin_); }
+  ~MatrixStorage() {
+    if (this->owned_) DeleteArray(this->begin_);
+  }
 
  public:
   /// \brief  resize the storage
@@ -30,14 +32,30 @@ class MatrixStorage {
     if (new_size > this->size_) {
       DType* new_begin = new DType[new_size];
       memset(new_begin, 0, sizeof(DType) * new_size);
-      // copy data
-      std::memcpy(new_begin, this->begin_, sizeof(DType) * this->size());
-      DeleteArray(this->begin_);
+      // copy data, begin_ is null before the first allocation
+      if (this->size_ > 0) {
+        std::memcpy(new_begin, this->begin_, sizeof(DType) * this->size());
+      }
+      if (this->owned_) DeleteArray(this->begin_);
       this->begin_ = new_begin;
       this->size_ = new_size;
+      this->owned_ = true;
     }
   }
 
+  /// \brief  use an external memory space as the storage, the space is not
+  /// released by the storage, and the elements are copied to an owned space
+  /// when the storage is resized to be larger
+  ///
+  /// \param data begin of the external space
+  /// \param size number of elements of the external space
+  void attach(DType* data, size_t size) {
+    if (this->owned_) DeleteArray(this->begin_);
+    this->begin_ = data;
+    this->size_ = size;
+    this->owned_ = false;
+  }
+
   DISABLE_COPY_AND_ASSIGN(MatrixStorage);
 
  public:
@@ -48,12 +66,15 @@ class MatrixStorage {
   inline DType* end() { return this->end_ + this->size_; }
 
   inline size_t size() const { return this->size_; }
+  inline bool owned() const { return this->owned_; }
 
  protected:
   // point to the first element
   DType* begin_;
   // capacity of the array
   size_t size_;
+  // whether the array is allocated by the storage
+  bool owned_;
 };
 
 }  // namespace math
@@ -0,0 +1,60 @@
+/*********************************************************************************
+*     File Name           :     simd.h
+*     Created By          :     yuewu
+*     Description         :     SIMD kernels of sparse-dense operations
+**********************************************************************************/
+
+#ifndef SOL_MATH_SIMD_H__
+#define SOL_MATH_SIMD_H__
+
+#include <cstddef>
+
+#include <sol/util/types.h>
+
+namespace sol {
+namespace math {
+
+/// \brief  instruction sets of the sparse-dense kernels
+enum class SIMDLevel {
+  Scalar = 0,
+  AVX2 = 1,
+  AVX512 = 2,
+};
+
+/// \brief  instruction set used by the kernels, the best one supported by the
+/// cpu is selected at the first call
+SOL_EXPORTS SIMDLevel simd_level();
+
+/// \brief  change the instruction set used by the kernels, not thread-safe
+///
+/// \param level required instruction set
+///
+/// \return instruction set actually used, which is capped by the cpu
+SOL_EXPORTS SIMDLevel set_simd_level(SIMDLevel level);
+
+/// \brief  dot product of a dense array and a sparse vector
+///
+/// \param dense dense array
+/// \param indexes indexes of the sparse vector
+/// \param values values of the sparse vector
+/// \param n number of elements of the sparse vector
+///
+/// \return sum of dense[indexes[i]] * values[i]
+SOL_EXPORTS float sparse_dot(const float* dense, const index_t* indexes,
+                             const float* values, size_t n);
+
+/// \brief  add a scaled sparse vector to a dense array, dense[indexes[i]] +=
+/// alpha * values[i]
+///
+/// \param alpha scale of the sparse vector
+/// \param indexes indexes of the sparse vector
+/// \param values values of the sparse vector
+/// \param n number of elements of the sparse vector
+/// \param dense dense array
+SOL_EXPORTS void sparse_axpy(float alpha, const index_t* indexes,
+                             const float* values, size_t n, float* dense);
+
+}  // namespace math
+}  // namespace sol
+
+#endif
@@ -12,6 +12,7 @@
 #include <sol/math/shape.h>
 #include <sol/math/vector.h>
 #include <sol/math/matrix_expression.h>
+#include <sol/math/simd.h>
 
 namespace sol {
 namespace math {
@@ -112,6 +113,17 @@ class SVector
 
   inline void clear() { this->resize(0); }
 
+  /// \brief  Use external memory spaces to store indexes and values
+  ///
+  /// \param indexes external space of indexes
+  /// \param values external space of values
+  /// \param capacity number of elements of the external spaces
+  inline void attach(index_t* indexes, DType* values, size_t capacity) {
+    this->init();
+    this->indexes_->attach(indexes, capacity);
+    this->values_->attach(values, capacity);
+  }
+
  public:
   inline size_t capacity() const {
     return this->values_ == nullptr ? 0 : this->values_->size();
@@ -169,6 +181,86 @@ std::ostream& operator<<(std::ostream& os, const SVector<DType>& svec) {
   return os;
 }
 
+namespace expr {
+
+// SIMD kernels of float dense matrices with sparse vectors
+
+template <>
+struct DenseSparseDotKernel<op::mul, Matrix<float>, SVector<float>, float> {
+  inline static float Calc(const Matrix<float>& lhs, const SVector<float>& rhs,
+                           size_t sz) {
+    if (sz == 0) return 0;
+    return sparse_dot(lhs.data(), rhs.indexes().begin(), rhs.values().begin(),
+                      sz);
+  }
+};
+
+/// \brief  sign of the sparse vector in the axpy kernel for operator OP
+template <typename OP>
+struct SparseAxpySign {
+  static const bool valid = false;
+};
+template <>
+struct SparseAxpySign<op::plusto> {
+  static const bool valid = true;
+  inline static float value() { return 1.f; }
+};
+template <>
+struct SparseAxpySign<op::minusto> {
+  static const bool valid = true;
+  inline static float value() { return -1.f; }
+};
+
+/// \brief  dense += / -= sparse vector
+template <typename OP>
+struct DenseSparseKernel<
+    OP, SVector<float>, float,
+    typename std::enable_if<SparseAxpySign<OP>::valid>::type> {
+  inline static void Calc(float* pdata, const SVector<float>& svec,
+                          size_t sz) {
+    if (sz == 0) return;
+    sparse_axpy(SparseAxpySign<OP>::value(), svec.indexes().begin(),
+                svec.values().begin(), sz, pdata);
+  }
+};
+
+/// \brief  dense += / -= scalar * sparse vector
+template <typename OP>
+struct DenseSparseKernel<
+    OP, BinaryMapExp<op::mul, ExprType::kSparse, ScalarExp<float>,
+                     ExprType::kValue, SVector<float>, ExprType::kSparse, float>,
+    float, typename std::enable_if<SparseAxpySign<OP>::valid>::type> {
+  typedef BinaryMapExp<op::mul, ExprType::kSparse, ScalarExp<float>,
+                       ExprType::kValue, SVector<float>, ExprType::kSparse,
+                       float> EType;
+  inline static void Calc(float* pdata, const EType& svec, size_t sz) {
+    if (sz == 0) return;
+    sparse_axpy(SparseAxpySign<OP>::value() * svec.lhs.value_,
+                svec.rhs.indexes().begin(), svec.rhs.values().begin(), sz,
+                pdata);
+  }
+};
+
+/// \brief  dense += / -= sparse vector * scalar
+template <typename OP>
+struct DenseSparseKernel<
+    OP, BinaryMapExp<op::mul, ExprType::kSparse, SVector<float>,
+                     ExprType::kSparse, ScalarExp<float>, ExprType::kValue,
+                     float>,
+    float, typename std::enable_if<SparseAxpySign<OP>::valid>::type> {
+  typedef BinaryMapExp<op::mul, ExprType::kSparse, SVector<float>,
+                       ExprType::kSparse, ScalarExp<float>, ExprType::kValue,
+                       float> EType;
+  inline static void Calc(float* pdata, const EType& svec, size_t sz) {
+    if (sz == 0) return;
+    sparse_axpy(SparseAxpySign<OP>::value() * svec.rhs.value_,
+                svec.lhs.indexes().begin(), svec.lhs.values().begin(), sz,
+                pdata);
+  }
+};
+
+}  // namespace expr
+
 }  // namespace math
 }  // namespace sol
 
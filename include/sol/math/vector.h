@@ -88,6 +88,19 @@ class Vector : public Matrix<DType> {
   /// \brief  Resize the array to be of size zero
   inline void clear(void) { this->resize(0); }
 
+  /// \brief  Use an external memory space to store the elements, the vector
+  /// is resized to be empty, and moves to an owned space when it grows beyond
+  /// the capacity of the external space
+  ///
+  /// \param data begin of the external space
+  /// \param capacity number of elements of the external space
+  inline void attach(DType* data, size_t capacity) {
+    this->init();
+    this->storage_->attach(data, capacity);
+    (*this->shape_)[0] = 1;
+    (*this->shape_)[1] = 0;
+  }
+
   inline void slice_op(const std::function<void(DType&)>& op, size_t start = 0,
                        size_t end = -1) {
     DType* start_iter = this->begin() + start;
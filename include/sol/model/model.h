@@ -13,12 +13,16 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <memory>
+#include <vector>
+#include <functional>
 
 #include <json/json.h>
 
 #include <sol/util/types.h>
 #include <sol/util/reflector.h>
 #include <sol/util/error_code.h>
+#include <sol/util/mmap_file.h>
 #include <sol/loss/loss.h>
 #include <sol/pario/data_point.h>
 #include <sol/pario/data_iter.h>
@@ -76,15 +80,50 @@ class SOL_EXPORTS Model {
   /// \return predicted class label
   virtual label_t Predict(const pario::DataPoint &dp, float *predicts) = 0;
 
+  /// \brief  prepare the model so that Predict can be called from multiple
+  /// threads
+  virtual void BeginPredict() {}
+
+  /// \brief  predicted results of a mini-batch
+  struct PredictResult {
+    // the preprocessed data
+    pario::MiniBatch *mini_batch;
+    // predicted labels
+    std::vector<label_t> labels;
+    // predicted scores, clf_num scores for each data
+    std::vector<float> scores;
+    // results formatted as the lines of Test
+    std::string text;
+  };
+
+  /// \brief  predict the data with thread_num_ threads
+  ///
+  /// \param data_iter data iterator
+  /// \param format whether to format the results as text
+  /// \param handler function to handle the results of a mini-batch, called on
+  /// the calling thread in the order of the data
+  ///
+  /// \return number of predicted data
+  size_t PredictBatches(
+      pario::DataIter &data_iter, bool format,
+      const std::function<void(const PredictResult &)> &handler);
+
+ protected:
+  /// \brief  preprocess and predict the data of a mini-batch
+  void PredictMiniBatch(PredictResult &result, bool format);
+
  public:
   /// \brief  Save model to file
   ///
   /// \param path path to save the model
+  /// \param binary whether to save in the binary format, which stores the
+  /// model info in json and then the raw parameter arrays, and is loaded by
+  /// mapping the file into memory
   ///
   /// \return status code, 0 if saved successfully
-  int Save(const std::string &path) const;
+  int Save(const std::string &path, bool binary = false) const;
 
-  /// \brief  load model from file
+  /// \brief  load model from file, the format is detected automatically
   ///
   /// \param path file path of the model
   ///
@@ -105,6 +144,31 @@ class SOL_EXPORTS Model {
   void model_info(Json::Value &info) const;
 
  protected:
+  /// \brief  named parameter array of the model
+  struct ModelArray {
+    ModelArray(const std::string &name, const math::Vector<real_t> &data)
+        : name(name), data(data) {}
+
+    std::string name;
+    // shares the storage with the model if it is not a temporary copy
+    math::Vector<real_t> data;
+  };
+
+  /// \brief  get the parameter arrays of the model in the order of
+  /// GetModelParam, the arrays are used to save and load binary models
+  ///
+  /// \param arrays list to add the arrays to
+  virtual void GetModelArrays(std::vector<ModelArray> &arrays) const {}
+
+  /// \brief  save the model in the text format
+  int SaveText(const std::string &path) const;
+
+  /// \brief  save the model in the binary format
+  int SaveBinary(const std::string &path) const;
+
+  /// \brief  load a binary model
+  static Model *LoadBinary(const std::string &path);
+
   /// \brief  serialize model parameters
   ///
   /// \param os output stream to write parameters
@@ -187,9 +251,14 @@ class SOL_EXPORTS Model {
 
   // number of updates during the training
   size_t update_num_;
+  // number of threads to train or test the model
+  int thread_num_;
 
   std::string name_;
 
+  // mapped binary model file the parameter arrays are attached to
+  std::shared_ptr<MMapFile> model_file_;
+
  public:
   bool model_updated() const { return model_updated_; }
 
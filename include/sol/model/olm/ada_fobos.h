@@ -27,7 +27,9 @@ class AdaFOBOS : public OnlineLinearModel {
 
   virtual void GetModelInfo(Json::Value& root) const;
   virtual void GetModelParam(std::ostream& os) const;
+  virtual void GetModelArrays(std::vector<ModelArray>& arrays) const;
   virtual int SetModelParam(std::istream& is);
+  virtual int ShareStates(const OnlineLinearModel& model);
 
  protected:
   float delta_;
@@ -27,6 +27,7 @@ class AROW : public OnlineLinearModel {
 
   virtual void GetModelInfo(Json::Value& root) const;
   virtual void GetModelParam(std::ostream& os) const;
+  virtual void GetModelArrays(std::vector<ModelArray>& arrays) const;
   virtual int SetModelParam(std::istream& is);
 
  protected:
@@ -29,6 +29,7 @@ class CW : public OnlineLinearModel {
 
   virtual void GetModelInfo(Json::Value& root) const;
   virtual void GetModelParam(std::ostream& os) const;
+  virtual void GetModelArrays(std::vector<ModelArray>& arrays) const;
   virtual int SetModelParam(std::istream& is);
 
  protected:
@@ -32,6 +32,7 @@ class ECCW : public OnlineLinearModel {
  protected:
   virtual void GetModelInfo(Json::Value& root) const;
   virtual void GetModelParam(std::ostream& os) const;
+  virtual void GetModelArrays(std::vector<ModelArray>& arrays) const;
   virtual int SetModelParam(std::istream& is);
 
  protected:
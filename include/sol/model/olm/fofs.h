@@ -20,22 +20,44 @@ class FOFS : public OnlineLinearModel {
 
   virtual void SetParameter(const std::string& name, const std::string& value);
   virtual void BeginTrain();
+  virtual void EndTrain();
+
+  virtual float Train(pario::DataIter& data_iter);
 
  protected:
+  virtual label_t TrainPredict(const pario::DataPoint& dp, float* predicts);
   virtual void Update(const pario::DataPoint& dp, const float* predict,
                       float loss);
   virtual void update_dim(index_t dim);
 
   virtual void GetModelInfo(Json::Value& root) const;
+  virtual void GetModelParam(std::ostream& os) const;
+  virtual void GetModelArrays(std::vector<ModelArray>& arrays) const;
+
+  /// \brief  multiply the weights of class c with its scale factor and reset
+  /// the scale factor to 1
+  void ApplyScale(int c);
+
+  /// \brief  set the weights of features outside the top B features to zero
+  ///
+  /// \param dp the instance updated in the current iteration
+  void TruncateWeights(const pario::DataPoint& dp);
 
  protected:
   float lambda_;
   index_t B_;
   math::Vector<real_t> abs_weights_;
   MinHeap min_heap_;
+  // whether weights outside the heap are all zero
+  bool heap_synced_;
 
   float norm_coeff_;
   float momentum_;
+
+  // weights of class c are scales_[c] * w(c)
+  math::Vector<real_t> scales_;
+  // squared L2 norm of w(c)
+  math::Vector<double> sq_norms_;
 };
 
 }  // namespace model
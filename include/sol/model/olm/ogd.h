@@ -25,6 +25,7 @@ class OGD : public OnlineLinearModel {
   virtual void Update(const pario::DataPoint& dp, const float* predict,
                       float loss);
   virtual void GetModelInfo(Json::Value& root) const;
+  virtual int ShareStates(const OnlineLinearModel& model);
 
  protected:
   void set_power_t(float power_t);
@@ -88,10 +89,17 @@ class PET : public OGD {
                       float loss);
   virtual void update_dim(index_t dim);
 
+  /// \brief  set the weights of features outside the top B features to zero
+  ///
+  /// \param dp the instance updated in the current iteration
+  void TruncateWeights(const pario::DataPoint& dp);
+
  protected:
   math::Vector<real_t> abs_weights_;
   OnlineRegularizer l0_;
   MinHeap min_heap_;
+  // whether weights outside the heap are all zero
+  bool heap_synced_;
 };
 
 }  // namespace model
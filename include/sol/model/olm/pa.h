@@ -18,6 +18,7 @@ class PA : public OnlineLinearModel {
  protected:
   virtual void Update(const pario::DataPoint& dp, const float* predict,
                       float loss);
+  virtual int ShareStates(const OnlineLinearModel& model);
 
  protected:
   // the coeffient difference between binary and multiclass classification
@@ -20,6 +20,7 @@ class Perceptron : public OnlineLinearModel {
  protected:
   virtual void Update(const pario::DataPoint& dp, const float* predict,
                       float loss);
+  virtual int ShareStates(const OnlineLinearModel& model);
 };  // class Perceptron
 
 }  // namespace model
@@ -20,6 +20,12 @@ class OnlineLinearModel : public OnlineModel {
   OnlineLinearModel(int class_num);
   virtual ~OnlineLinearModel();
 
+  /// \brief  set model parameters
+  ///
+  /// \param name name of the parameter
+  /// \param value value of the parameter in string
+  virtual void SetParameter(const std::string& name, const std::string& value);
+
  public:
   virtual void BeginTrain() { OnlineModel::BeginTrain(); }
 
@@ -29,10 +35,20 @@ class OnlineLinearModel : public OnlineModel {
         this->regularizer_->FinalizeRegularization(w(c));
       }
     }
+    this->interleaved_dirty_ = true;
     OnlineModel::EndTrain();
   }
+  /// \brief  predict with the interleaved weights if they are up to date,
+  /// otherwise class by class; the model is not modified, so that it can be
+  /// called concurrently
   virtual label_t Predict(const pario::DataPoint& dp, float* predicts);
 
+  /// \brief  build the interleaved weights for scoring, must be called
+  /// before the predictions that should use them
+  virtual void BeginPredict() {
+    if (this->interleave_ && this->interleaved_dirty_) this->InterleaveWeights();
+  }
+
   virtual label_t Iterate(const pario::DataPoint& dp, float* predicts);
 
  protected:
@@ -47,11 +63,37 @@ class OnlineLinearModel : public OnlineModel {
 
   virtual label_t TrainPredict(const pario::DataPoint& dp, float* predicts);
 
+  virtual OnlineModel* CreateWorker();
+
+  /// \brief  share the model states with the model to be trained together
+  ///
+  /// \param model model to share states with, which is of the same type
+  ///
+  /// \return Status_OK if succeed, Status_Invalid_Argument if the algorithm
+  /// does not allow the states to be updated by multiple threads
+  virtual int ShareStates(const OnlineLinearModel& model) {
+    return Status_Invalid_Argument;
+  }
+
+  /// \brief  share the weights of all classes with the model
+  void ShareWeights(const OnlineLinearModel& model);
+
+  /// \brief  copy the weights of all classes into the feature-major
+  /// interleaved matrix used for scoring
+  void InterleaveWeights();
+
+  /// \brief  free the interleaved matrix, so that only the per-class weights
+  /// are kept in memory when training
+  void ReleaseInterleavedWeights();
+
  public:
   virtual float model_sparsity();
 
  protected:
+  virtual void GetModelInfo(Json::Value& root) const;
+
   virtual void GetModelParam(std::ostream& os) const;
+  virtual void GetModelArrays(std::vector<ModelArray>& arrays) const;
 
   virtual int SetModelParam(std::istream& is);
 
@@ -61,6 +103,9 @@ class OnlineLinearModel : public OnlineModel {
   }
   math::Vector<real_t>& w(int cls_id) { return this->weights_[cls_id]; }
 
+  /// \brief  whether multi-class data is scored with the interleaved weights
+  bool interleave() const { return this->interleave_; }
+
   inline real_t g(int cls_id) const { return this->gradients_[cls_id]; }
   inline real_t& g(int cls_id) { return this->gradients_[cls_id]; }
 
@@ -69,6 +114,17 @@ class OnlineLinearModel : public OnlineModel {
   math::Vector<real_t>* weights_;
   // gradients for each class
   real_t* gradients_;
+
+  // whether to score multi-class data with the interleaved weights, the
+  // per-class weights are still the ones trained, saved and loaded
+  bool interleave_;
+  // scoring-only copy of the weights, weights of feature i are in
+  // [i * clf_num_, (i + 1) * clf_num_); built by BeginPredict and freed
+  // when training goes on. Updates still walk the per-class weights, the
+  // copy only speeds up scoring
+  math::Vector<real_t> interleaved_weights_;
+  // whether weights_ is changed since last interleave
+  bool interleaved_dirty_;
 };  // class OnlineLinearModel
 }  // namespace model
 }  // namespace sol
@@ -11,8 +11,10 @@
 #include <sol/model/model.h>
 
 #include <vector>
+#include <ostream>
 
 #include <sol/pario/data_point.h>
+#include <sol/util/profiler.h>
 
 namespace sol {
 namespace model {
@@ -39,6 +41,16 @@ class OnlineModel : public Model {
   /// \return training error rate
   virtual float Train(pario::DataIter& data_iter);
 
+  /// \brief  continue training with the data of a reader on the calling
+  /// thread, the data is iterated once without the mini-batch pipeline
+  ///
+  /// \param reader opened data reader, like a MemoryReader over a chunk of
+  /// data
+  ///
+  /// \return training error rate on the data, -1 if the model can not be
+  /// trained
+  float PartialFit(pario::DataReader& reader);
+
  public:
   /// \brief  iterate the model with one new instance
   ///
@@ -49,6 +61,28 @@ class OnlineModel : public Model {
   virtual label_t Iterate(const pario::DataPoint& dp, float* predicts);
 
  protected:
+  /// \brief  create a replica of the model for multi-threaded training, the
+  /// replica shares the model states with this model and updates them without
+  /// locks
+  ///
+  /// \return the replica, nullptr if not supported by the algorithm
+  virtual OnlineModel* CreateWorker() { return nullptr; }
+
+  /// \brief  train with thread_num_ workers created by CreateWorker
+  ///
+  /// \param data_iter data iterator
+  /// \param next_show_time next data number to show the iteration status
+  ///
+  /// \return false if the workers can not be created
+  bool ParallelTrain(pario::DataIter& data_iter, size_t& next_show_time);
+
+  /// \brief  get the next data number to show the iteration status, and show
+  /// the header of the status at the beginning of training
+  size_t BeginShowIterStatus();
+
+  /// \brief  show the iteration status if next_show_time is reached
+  void ShowIterStatus(size_t& next_show_time);
+
   /// \brief  predict the label of data in the trainig phase
   ///
   /// \param dp input data
@@ -119,6 +153,11 @@ class OnlineModel : public Model {
 
     virtual size_t next_show_time() { return size_t(-1); }
     virtual void next() {}
+    /// \brief  show the time spent in each pipeline stage along with the
+    /// default iteration status, called only if profiling is enabled
+    virtual void show_profile(std::ostream& os) {
+      os << Profiler::Summary() << "\n";
+    }
   };
 
   /// \brief  C type to inspect iteration callback
@@ -0,0 +1,181 @@
+/*********************************************************************************
+*     File Name           :     block_binary_format.h
+*     Created By          :     yuewu
+*     Description         :     layout of the block binary format (v2)
+**********************************************************************************/
+
+#ifndef SOL_PARIO_BLOCK_BINARY_FORMAT_H__
+#define SOL_PARIO_BLOCK_BINARY_FORMAT_H__
+
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+#include <sol/util/types.h>
+
+namespace sol {
+namespace pario {
+
+/// The block binary format groups the instances of the binary format (v1)
+/// into blocks, each block is compressed separately:
+///
+///   file header  : magic "SOLB", uint32 version, uint32 index codec
+///   block        : block header (BlockHeader::kSize bytes), payload
+///   ...
+///   end mark     : block header of 0 instances
+///   block index  : uint64 offset, uint64 first instance of each block
+///   trailer      : uint64 block number, uint64 offset of the index,
+///                  uint32 checksum of the index, magic "SOLI"
+///
+/// The payload is the v1 records of the instances of the block, compressed
+/// by the codec in the block header. The indexes of the records are coded by
+/// the index codec in the file header (see IndexCodecType) instead of the
+/// varint of the v1 format, the values are prefixed by a byte of the value
+/// encoding of the record (see ValueEncoding) instead of raw floats. All
+/// numbers are in the native byte order like the v1 format.
+namespace block_binary {
+
+static const char kFileMagic[4] = {'S', 'O', 'L', 'B'};
+static const char kBlockMagic[4] = {'S', 'B', 'L', 'K'};
+static const char kIndexMagic[4] = {'S', 'O', 'L', 'I'};
+static const uint32_t kVersion = 2;
+
+static const size_t kFileHeaderSize = 12;
+static const size_t kIndexEntrySize = 16;
+static const size_t kTrailerSize = 24;
+
+/// \brief  codecs of the block payload
+enum Codec {
+  kCodecNone = 0,
+  kCodecZlib = 1,
+};
+
+/// \brief  header of a block
+struct BlockHeader {
+  /// \brief  max number of distinct labels in the histogram
+  static const int kMaxLabelNum = 8;
+  /// \brief  size of the serialized header
+  static const size_t kSize = 4 + 4 * 4 + 8 * 3 + 4 + kMaxLabelNum * 8;
+
+  uint32_t inst_num;
+  uint32_t codec;
+  // crc32 of the payload
+  uint32_t checksum;
+  uint32_t label_num;
+  uint64_t raw_len;
+  uint64_t payload_len;
+  uint64_t max_index;
+  // instances of the labels beyond the histogram
+  uint32_t other_label_count;
+  label_t labels[kMaxLabelNum];
+  uint32_t label_counts[kMaxLabelNum];
+
+  BlockHeader() { this->Clear(); }
+
+  void Clear() { memset(this, 0, sizeof(BlockHeader)); }
+
+  /// \brief  add an instance to the statistics
+  void AddInstance(label_t label, index_t max_idx) {
+    ++this->inst_num;
+    if (max_idx > this->max_index) this->max_index = max_idx;
+    for (uint32_t i = 0; i < this->label_num; ++i) {
+      if (this->labels[i] == label) {
+        ++this->label_counts[i];
+        return;
+      }
+    }
+    if (this->label_num < uint32_t(kMaxLabelNum)) {
+      this->labels[this->label_num] = label;
+      this->label_counts[this->label_num++] = 1;
+    } else {
+      ++this->other_label_count;
+    }
+  }
+
+  void Serialize(char* dst) const {
+    memcpy(dst, kBlockMagic, 4);
+    dst += 4;
+    Put(dst, this->inst_num);
+    Put(dst, this->codec);
+    Put(dst, this->checksum);
+    Put(dst, this->label_num);
+    Put(dst, this->raw_len);
+    Put(dst, this->payload_len);
+    Put(dst, this->max_index);
+    Put(dst, this->other_label_count);
+    for (int i = 0; i < kMaxLabelNum; ++i) {
+      float label = float(this->labels[i]);
+      Put(dst, label);
+      Put(dst, this->label_counts[i]);
+    }
+  }
+
+  /// \brief  deserialize the header
+  ///
+  /// \return false if the magic or the header is not valid
+  bool Deserialize(const char* src) {
+    if (memcmp(src, kBlockMagic, 4) != 0) return false;
+    src += 4;
+    Get(src, this->inst_num);
+    Get(src, this->codec);
+    Get(src, this->checksum);
+    Get(src, this->label_num);
+    Get(src, this->raw_len);
+    Get(src, this->payload_len);
+    Get(src, this->max_index);
+    Get(src, this->other_label_count);
+    for (int i = 0; i < kMaxLabelNum; ++i) {
+      float label;
+      Get(src, label);
+      this->labels[i] = label_t(label);
+      Get(src, this->label_counts[i]);
+    }
+    return this->label_num <= uint32_t(kMaxLabelNum);
+  }
+
+  template <typename T>
+  static inline void Put(char*& dst, const T& val) {
+    memcpy(dst, &val, sizeof(T));
+    dst += sizeof(T);
+  }
+  template <typename T>
+  static inline void Get(const char*& src, T& val) {
+    memcpy(&val, src, sizeof(T));
+    src += sizeof(T);
+  }
+};
+
+/// \brief  crc32 (IEEE) of the data
+SOL_EXPORTS uint32_t Crc32(const char* data, size_t len);
+
+/// \brief  test if the codec is compiled in
+SOL_EXPORTS bool CodecSupported(int codec);
+
+/// \brief  compress a block
+///
+/// \param codec codec of the block
+/// \param src uncompressed data
+/// \param len length of the uncompressed data
+/// \param dst compressed data
+///
+/// \return Status code, Status_OK if succeed
+SOL_EXPORTS int Compress(int codec, const char* src, size_t len,
+                         std::vector<char>& dst);
+
+/// \brief  decompress a block
+///
+/// \param codec codec of the block
+/// \param src compressed data
+/// \param len length of the compressed data
+/// \param dst buffer of the uncompressed data
+/// \param dst_len length of the uncompressed data
+///
+/// \return Status code, Status_OK if succeed
+SOL_EXPORTS int Decompress(int codec, const char* src, size_t len, char* dst,
+                           size_t dst_len);
+
+}  // namespace block_binary
+}  // namespace pario
+}  // namespace sol
+
+#endif
@@ -0,0 +1,117 @@
+/*********************************************************************************
+*     File Name           :     block_binary_reader.h
+*     Created By          :     yuewu
+*     Description         :     block binary format (v2) data reader
+**********************************************************************************/
+
+#ifndef SOL_PARIO_BLOCK_BINARY_READER_H__
+#define SOL_PARIO_BLOCK_BINARY_READER_H__
+
+#include <vector>
+
+#include <sol/pario/data_reader.h>
+#include <sol/pario/block_binary_format.h>
+#include <sol/pario/index_codec.h>
+
+namespace sol {
+namespace pario {
+
+/// \brief  Reader of the block binary format
+///
+/// Blocks are read and decompressed one at a time. With the block index at
+/// the end of the file, the reader can be restricted to the blocks starting
+/// in a byte range (so the file can be parsed by ParallelReadTask), or moved
+/// to any block to skip data or to resume reading.
+class SOL_EXPORTS BlockBinaryReader : public DataFileReader {
+ public:
+  BlockBinaryReader();
+
+ public:
+  /// \brief  Open a new file
+  ///
+  /// \param path Path to the file, '-' when if use stdin
+  /// \param mode open mode, "rb"
+  ///
+  /// \return Status code,  Status_OK if succeed
+  virtual int Open(const std::string& path, const char* mode = "rb");
+
+  /// \brief  Rewind the reader to the first block (of the range)
+  virtual void Rewind();
+
+  /// \brief  Restrict the reader to the blocks starting in the byte range
+  /// [begin, end), requires the block index
+  virtual int SetRange(int64_t begin, int64_t end);
+
+ public:
+  /// \brief  Read next data point
+  ///
+  /// \param dst_data Destination data point
+  ///
+  /// \return  Status code, Status_OK if everything ok, Status_EndOfFile if
+  /// read to file end
+  virtual int Next(DataPoint& dst_data);
+
+  /// \brief  Move the reader to the beginning of a block, requires the block
+  /// index
+  ///
+  /// \param block index of the block, block_num() to move to the end
+  ///
+  /// \return Status code,  Status_OK if succeed
+  int SeekBlock(size_t block);
+
+ public:
+  /// \brief  number of blocks, 0 if the file has no block index
+  inline size_t block_num() const { return this->block_offsets_.size(); }
+  /// \brief  byte offset of a block
+  inline uint64_t block_offset(size_t block) const {
+    return this->block_offsets_[block];
+  }
+  /// \brief  index of the first instance of a block in the file
+  inline uint64_t block_first_instance(size_t block) const {
+    return this->block_first_insts_[block];
+  }
+  /// \brief  index of the next block to load, reading can be resumed from
+  /// it by SeekBlock
+  inline size_t next_block() const { return this->next_block_; }
+  /// \brief  codec of the indexes
+  inline const IndexCodec* index_codec() const { return this->index_codec_; }
+  /// \brief  header of the last loaded block
+  inline const block_binary::BlockHeader& block_header() const {
+    return this->header_;
+  }
+
+ protected:
+  /// \brief  read the block index at the end of the file
+  int ReadIndex();
+
+  /// \brief  read and decompress the next block
+  ///
+  /// \return Status code, Status_EndOfFile if no more blocks
+  int LoadBlock();
+
+ private:
+  const IndexCodec* index_codec_;
+  // block index
+  std::vector<uint64_t> block_offsets_;
+  std::vector<uint64_t> block_first_insts_;
+  // offset of the end of the blocks, -1 if unknown
+  int64_t data_end_;
+  // blocks to read
+  size_t first_block_;
+  size_t end_block_;
+
+  // the loaded block
+  size_t next_block_;
+  block_binary::BlockHeader header_;
+  std::vector<char> payload_;
+  std::vector<char> raw_;
+  // position of the next instance in raw_
+  size_t raw_pos_;
+  // instances left in the loaded block
+  uint32_t inst_left_;
+};  // class BlockBinaryReader
+
+}  // namespace pario
+}  // namespace sol
+
+#endif
@@ -0,0 +1,105 @@
+/*********************************************************************************
+*     File Name           :     block_binary_writer.h
+*     Created By          :     yuewu
+*     Description         :     block binary format (v2) data writer
+**********************************************************************************/
+
+#ifndef SOL_PARIO_BLOCK_BINARY_WRITER_H__
+#define SOL_PARIO_BLOCK_BINARY_WRITER_H__
+
+#include <vector>
+
+#include <sol/pario/data_writer.h>
+#include <sol/pario/block_binary_format.h>
+#include <sol/pario/index_codec.h>
+#include <sol/math/vector.h>
+
+namespace sol {
+namespace pario {
+
+/// \brief  Writer of the block binary format, instances are buffered and
+/// written in compressed blocks, the block index is written on Close
+class SOL_EXPORTS BlockBinaryWriter : public DataWriter {
+ public:
+  BlockBinaryWriter();
+  virtual ~BlockBinaryWriter();
+
+ public:
+  /// \brief  Open a new file
+  ///
+  /// \param path Path to the file, '-' when if use stdout
+  /// \param mode open mode, "wb"
+  ///
+  /// \return Status code,  Status_OK if succeed
+  virtual int Open(const std::string& path, const char* mode = "wb");
+
+  /// \brief  Write the last block and the block index, and close the file
+  virtual void Close();
+
+ public:
+  /// \brief  Write a new data into the file
+  ///
+  /// \param data Data to be saved
+  ///
+  /// \return Status code,  Status_OK if succeed
+  virtual int Write(const DataPoint& data);
+
+  /// \brief  Set the options of the format, "codec=none|zlib",
+  /// "index_codec=varint|streamvbyte", "values=lossless|fp16|bf16|int8" and
+  /// "block_size=<bytes>", separated by ','
+  ///
+  /// \param extra_info options
+  ///
+  /// \return Status code,  Status_OK if succeed
+  virtual int SetExtraInfo(const char* extra_info);
+
+ public:
+  /// \brief  size of the uncompressed instances in a block
+  inline size_t block_size() const { return this->block_size_; }
+  inline void set_block_size(size_t block_size) {
+    this->block_size_ = block_size > 0 ? block_size : 1;
+  }
+
+  inline int codec() const { return this->codec_; }
+  /// \brief  set the codec of blocks, see block_binary::Codec
+  int set_codec(int codec);
+
+  inline int value_precision() const { return this->value_precision_; }
+  /// \brief  set the precision of the values, see ValuePrecision
+  inline void set_value_precision(int precision) {
+    this->value_precision_ = precision;
+  }
+
+  inline int index_codec() const { return this->index_codec_->type(); }
+  /// \brief  set the codec of indexes before Open, see IndexCodecType
+  int set_index_codec(int index_codec);
+
+ protected:
+  /// \brief  compress and write the buffered instances as a block
+  int FlushBlock();
+
+ private:
+  bool opened_;
+  size_t block_size_;
+  int codec_;
+  const IndexCodec* index_codec_;
+  // precision of the values, see ValuePrecision
+  int value_precision_;
+  // bytes written to the file
+  uint64_t offset_;
+  // buffered instances in the v1 format
+  std::vector<char> raw_;
+  std::vector<char> payload_;
+  block_binary::BlockHeader header_;
+  // offsets and first instances of the written blocks
+  std::vector<uint64_t> block_offsets_;
+  std::vector<uint64_t> block_first_insts_;
+  uint64_t inst_num_;
+  // compressed codes of indexes
+  math::Vector<char> comp_codes_;
+};  // class BlockBinaryWriter
+
+}  // namespace pario
+}  // namespace sol
+
+#endif
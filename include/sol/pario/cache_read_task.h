@@ -0,0 +1,114 @@
+/*********************************************************************************
+*     File Name           :     cache_read_task.h
+*     Created By          :     yuewu
+*     Description         :     Thread task to read a data once and serve the
+*                                 later passes from a cache
+**********************************************************************************/
+#ifndef SOL_PARIO_CACHE_READ_TASK_H__
+#define SOL_PARIO_CACHE_READ_TASK_H__
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <sol/pario/mini_batch.h>
+#include <sol/pario/data_reader.h>
+#include <sol/pario/data_writer.h>
+#include <sol/util/block_queue.h>
+#include <sol/util/thread_task.h>
+
+namespace sol {
+namespace pario {
+
+/// \brief  Thread task to read a data with multiple passes, the data is
+/// parsed only in the first pass
+///
+/// Points of the first pass are appended to an in-memory cache in CSR layout,
+/// later passes copy the points from the cache to the mini-batches, in a
+/// shuffled order if required. When the cache grows beyond max_cache_size
+/// bytes, it is spilled to cache_path in the binary format and later passes
+/// read the binary file instead. Without cache_path, the data is parsed again
+/// in each pass like DataReadTask.
+class CacheReadTask : public ThreadTask {
+ public:
+  /// \brief  Initialize the Cache Read Task
+  ///
+  /// \param path data file path
+  /// \param dtype data type (svm, bin, csv, etc.)
+  /// \param mini_batch_factory factory of empty mini batch
+  /// \param mini_batch_buf place to store the loaded mini batched
+  /// \param pass_num number of passes to read the data
+  /// \param shuffle whether to shuffle the cached data before each pass
+  /// \param max_cache_size maximum bytes of the in-memory cache, 0 for no
+  /// limit
+  /// \param cache_path path to spill the cache, empty for no spilling
+  CacheReadTask(const std::string& path, const std::string& dtype,
+                MiniBatchQueue& mini_batch_factory,
+                MiniBatchQueue& mini_batch_buf, int pass_num,
+                bool shuffle = false, size_t max_cache_size = 0,
+                const std::string& cache_path = "");
+  virtual ~CacheReadTask();
+
+ public:
+  inline bool Good() { return this->reader_ != nullptr; }
+
+  /// \brief  bytes of the in-memory cache
+  size_t cache_size() const;
+
+ protected:
+  virtual void run();
+
+  /// \brief  parse the first pass and fill the cache
+  ///
+  /// \return Status_OK if the pass is finished
+  int ReadFirstPass();
+
+  /// \brief  read a later pass from the in-memory cache
+  ///
+  /// \return Status_OK if the pass is finished
+  int ReadCache(int pass);
+
+  /// \brief  read a later pass from the reader
+  ///
+  /// \return Status_OK if the pass is finished
+  int ReadPass();
+
+  /// \brief  add a parsed point to the cache or the spilled file
+  void CachePoint(const DataPoint& pt);
+
+  /// \brief  write the in-memory cache to the spilled file
+  ///
+  /// \return Status_OK if succeed
+  int Spill();
+
+  /// \brief  drop the in-memory cache, later passes parse the data again
+  void DropCache();
+
+  /// \brief  get an empty mini-batch, nullptr if exit signal received
+  MiniBatch* NewMiniBatch();
+
+ private:
+  std::unique_ptr<DataReader> reader_;
+  std::unique_ptr<DataWriter> spill_writer_;
+  MiniBatchQueue& mini_batch_factory_;
+  MiniBatchQueue& mini_batch_buf_;
+  int pass_num_;
+  bool shuffle_;
+  size_t max_cache_size_;
+  std::string cache_path_;
+
+  // whether the points of the first pass are cached in memory
+  bool cached_;
+  // whether the cache is spilled to cache_path_
+  bool spilled_;
+
+  // cached points in CSR layout
+  std::vector<label_t> labels_;
+  std::vector<size_t> offsets_;
+  std::vector<index_t> indexes_;
+  std::vector<real_t> features_;
+};
+
+}  // namespace pario
+}  // namespace sol
+#endif
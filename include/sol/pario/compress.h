@@ -33,8 +33,8 @@ inline void run_len_encode(math::Vector<char>& codes, uint64_t i) {
 inline const char* run_len_decode(
     const char* p, uint64_t& i) {  // read an int 7 bits at a time.
   size_t count = 0;
-  while (*p & 128) i = i | ((*(p++) & 127) << 7 * count++);
-  i = i | (*(p++) << 7 * count);
+  while (*p & 128) i = i | (uint64_t(*(p++) & 127) << 7 * count++);
+  i = i | (uint64_t(*(p++)) << 7 * count);
   return p;
 }
 
@@ -84,6 +84,33 @@ inline void decomp_index(const math::Vector<char>& codes,
 #endif
 }
 
+/**
+ * decomp_index : de-compress the codes to a pre-allocated index array
+ *
+ * @Param codes: begin of input codes
+ * @Param codes_end: end of input codes
+ * @Param indexes: output indexes
+ * @Param max_num: max number of indexes to decode
+ *
+ * @Return: number of decoded indexes
+ */
+template <typename T, typename index_type_traits<T>::type* = nullptr>
+inline size_t decomp_index(const char* codes, const char* codes_end,
+                           T* indexes, size_t max_num) {
+  uint64_t last = 0;
+  uint64_t index = 0;
+  size_t num = 0;
+  const char* p = codes;
+  while (p < codes_end && num < max_num) {
+    index = 0;
+    p = run_len_decode(p, index);
+    index += last;
+    last = index;
+    indexes[num++] = T(index);
+  }
+  return p == codes_end ? num : size_t(-1);
+}
+
 }  // namespace pario
 }  // namespace sol
 #endif
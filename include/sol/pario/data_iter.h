@@ -12,11 +12,15 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
 
 #include <sol/pario/data_point.h>
 #include <sol/pario/mini_batch.h>
 #include <sol/pario/data_reader.h>
 #include <sol/pario/data_read_task.h>
+#include <sol/pario/parallel_read_task.h>
+#include <sol/pario/cache_read_task.h>
+#include <sol/pario/shuffle_buffer.h>
 #include <sol/util/block_queue.h>
 
 namespace sol {
@@ -36,10 +40,41 @@ class SOL_EXPORTS DataIter {
   ///
   /// \param path data file path
   /// \param dtype data type (svm, bin, csv, etc.)
+  /// \param pass_num number of passes to read the data
+  /// \param thread_num number of threads to parse the data, text data (svm,
+  /// csv) is split into newline-aligned blocks if thread_num > 1
+  /// \param keep_order whether to keep the original order of the data when
+  /// parsed with multiple threads
   ///
   /// \return
   int AddReader(const std::string& path, const std::string& dtype,
-                int pass_num = 1);
+                int pass_num = 1, int thread_num = 1, bool keep_order = false);
+
+  /// \brief  Load the data of an opened reader, like the matrices in memory
+  ///
+  /// \param reader data reader, owned by the iterator after the call
+  /// \param pass_num number of passes to read the data
+  ///
+  /// \return
+  int AddReader(DataReader* reader, int pass_num = 1);
+
+  /// \brief  Load a new data with multiple passes, the data is parsed in the
+  /// first pass and cached, later passes are read from the cache
+  ///
+  /// \param path data file path
+  /// \param dtype data type (svm, bin, csv, etc.)
+  /// \param pass_num number of passes to read the data
+  /// \param shuffle whether to shuffle the cached data before each later pass
+  /// \param max_cache_size maximum bytes of the in-memory cache, 0 for no
+  /// limit
+  /// \param cache_path path to spill the cache if it exceeds max_cache_size,
+  /// the data is parsed again in each pass if empty
+  ///
+  /// \return
+  int AddCachedReader(const std::string& path, const std::string& dtype,
+                      int pass_num, bool shuffle = false,
+                      size_t max_cache_size = 0,
+                      const std::string& cache_path = "");
 
   /// \brief  get the next mini-batch
   ///
@@ -48,17 +83,70 @@ class SOL_EXPORTS DataIter {
   /// \return
   virtual MiniBatch* Next(MiniBatch* prev_batch = nullptr);
 
+  /// \brief  return a mini-batch got from Next without fetching a new one,
+  /// consumers on different threads call Next(nullptr) and Recycle so that
+  /// no batch is held while waiting for the data
+  ///
+  /// \param batch mini-batch to recycle
+  void Recycle(MiniBatch* batch);
+
+  /// \brief  set the maximum number of readers running at the same time,
+  /// mini-batches of running readers are interleaved, batch_num should be
+  /// larger than the number to overlap the reading of different readers
+  ///
+  /// \param num maximum number of running readers, 1 to read the data one
+  /// after another
+  void set_max_running_reader_num(int num);
+
+  /// \brief  shuffle the data with a window of points, each mini-batch is
+  /// sampled uniformly from the window, which is refilled by the readers
+  ///
+  /// \param window_size number of points in the window, 0 to iterate the data
+  /// in the original order. The window is refilled with whole loaded
+  /// mini-batches until it holds window_size points, so it holds up to
+  /// window_size + batch_size - 1 points, and the points of each loaded
+  /// mini-batch are shuffled even if window_size is smaller.
+  /// \param seed seed of the random generator
+  void set_shuffle_window(size_t window_size, unsigned int seed = 0);
+  size_t shuffle_window() const {
+    return this->shuffle_buf_ == nullptr ? 0
+                                         : this->shuffle_buf_->window_size();
+  }
+  int max_running_reader_num() const {
+    return this->max_running_reader_num_;
+  }
+
+ protected:
+  /// \brief  start readers until the concurrency limit is reached
+  void StartReaders();
+
+  /// \brief  get the next mini-batch loaded by the readers
+  MiniBatch* ReadNext(MiniBatch* prev_batch);
+
+  /// \brief  get the next mini-batch sampled from the shuffle window
+  MiniBatch* ShuffleNext(MiniBatch* prev_batch);
+
  protected:
   // mini-batch size
   int batch_size_;
   // factory to store not used mini batches
-  BlockQueue<MiniBatch*> mini_batch_factory_;
+  MiniBatchQueue mini_batch_factory_;
   // mini-batch number in buffer
-  BlockQueue<MiniBatch*> mini_batch_buf_;
+  MiniBatchQueue mini_batch_buf_;
   // data reader threads
-  std::vector<std::shared_ptr<DataReadTask>> readers_;
-  // index of running reader
-  int running_reader_idx_;
+  std::vector<std::shared_ptr<ThreadTask>> readers_;
+  // index of the next reader to start
+  int next_reader_idx_;
+  // number of running readers
+  int running_reader_num_;
+  // maximum number of readers running at the same time
+  int max_running_reader_num_;
+  // mini-batch returned by Next and not recycled yet
+  std::atomic<MiniBatch*> cur_batch_;
+  // window to shuffle the data, nullptr if not shuffled
+  std::unique_ptr<ShuffleBuffer> shuffle_buf_;
+  // whether all readers exit
+  bool read_end_;
 };  // class DataIter
 }  // namespace pario
 }  // namespace sol
@@ -48,6 +48,21 @@ class SOL_EXPORTS DataPoint {
   /// \brief  clear the label, indexes, and features
   void Clear();
 
+  /// \brief  clear the point and store the features in external buffers, the
+  /// features are moved to owned buffers if more than capacity features are
+  /// added
+  ///
+  /// \param indexes buffer of indexes
+  /// \param features buffer of feature values
+  /// \param capacity number of features the buffers can hold
+  void Attach(index_t* indexes, real_t* features, size_t capacity);
+
+  /// \brief  Check if the features are stored in the given buffers
+  inline bool IsAttached(const index_t* indexes, const real_t* features) const {
+    return this->indexes().begin() == indexes &&
+           this->features().begin() == features;
+  }
+
   /// \brief  Check if the indexes are sorted from small to large
   ///
   /// \return true of sorted, false otherwise
@@ -28,8 +28,17 @@ class DataReadTask : public ThreadTask {
   /// \param mini_batch_buf place to store the loaded mini batched
   /// \param pass_num number of passes to read the data
   DataReadTask(const std::string& path, const std::string& dtype,
-               BlockQueue<MiniBatch*>& mini_batch_factory,
-               BlockQueue<MiniBatch*>& mini_batch_buf, int pass_num);
+               MiniBatchQueue& mini_batch_factory,
+               MiniBatchQueue& mini_batch_buf, int pass_num);
+
+  /// \brief  Initialize the Data Read Task with an opened reader
+  ///
+  /// \param reader data reader, owned by the task
+  /// \param mini_batch_factory factory of empty mini batch
+  /// \param mini_batch_buf place to store the loaded mini batched
+  /// \param pass_num number of passes to read the data
+  DataReadTask(DataReader* reader, MiniBatchQueue& mini_batch_factory,
+               MiniBatchQueue& mini_batch_buf, int pass_num);
 
  public:
   inline bool Good() { return this->reader_ != nullptr; }
@@ -39,8 +48,8 @@ class DataReadTask : public ThreadTask {
 
  private:
   std::unique_ptr<DataReader> reader_;
-  BlockQueue<MiniBatch*>& mini_batch_factory_;
-  BlockQueue<MiniBatch*>& mini_batch_buf_;
+  MiniBatchQueue& mini_batch_factory_;
+  MiniBatchQueue& mini_batch_buf_;
   int pass_num_;
 };
 
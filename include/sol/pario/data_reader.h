@@ -46,6 +46,20 @@ class SOL_EXPORTS DataReader {
   /// \brief  Rewind the dataset to the beginning of the file
   virtual void Rewind() = 0;
 
+  /// \brief  Restrict the reader to the records starting in the byte range
+  /// [begin, end) of the file, the reader is moved to the first record in the
+  /// range, and Rewind moves back to it
+  ///
+  /// \param begin begin offset of the range
+  /// \param end end offset of the range
+  ///
+  /// \return Status code, Status_OK if succeed, Status_Invalid_Argument if
+  /// the reader can not be split into ranges
+  virtual int SetRange(int64_t begin, int64_t end);
+
+  /// \brief  whether the opened data can be split into ranges by SetRange
+  virtual bool SupportRange() { return false; }
+
  public:
   /// \brief  Read next data point
   ///
@@ -72,8 +86,15 @@ class SOL_EXPORTS DataFileReader : public DataReader {
   /// \return True if everything is ok
   virtual bool Good() { return this->is_good_ && this->file_reader_.Good(); }
 
-  /// \brief  Rewind the dataset to the beginning of the file
-  virtual void Rewind() { this->file_reader_.Rewind(); }
+  /// \brief  Rewind the dataset to the beginning of the file (or range)
+  virtual void Rewind();
+
+  /// \brief  Restrict the reader to the lines starting in the byte range
+  /// [begin, end), only supported by text readers
+  virtual int SetRange(int64_t begin, int64_t end);
+
+  /// \brief  only text data can be split into ranges
+  virtual bool SupportRange() { return this->file_reader_.IsText(); }
 
  public:
   /// \brief  Read next data point
@@ -84,15 +105,25 @@ class SOL_EXPORTS DataFileReader : public DataReader {
   /// read to file end
   virtual int Next(DataPoint& dst_data) = 0;
 
+ protected:
+  /// \brief  read the next line (within the range), read_buf_ points to the
+  /// line in the buffer of file_reader_, terminated by '\0'
+  ///
+  /// \return Status code, Status_EndOfFile if no more lines
+  int ReadLine();
+
  protected:
   FileReader file_reader_;
   /// \brief  flag to denote whether any parse error occurs
   bool is_good_;
-  /// \brief  read buffer
+  /// \brief  the last line read, valid until the next read
   char* read_buf_;
-  int read_buf_size_;
+  size_t read_len_;
   /// \brief  path to the opened file
   std::string file_path_;
+  /// \brief  byte range of lines to read, range_end_ < 0 if not restricted
+  int64_t range_begin_;
+  int64_t range_end_;
 
  public:
   const std::string& file_path() const { return file_path_; }
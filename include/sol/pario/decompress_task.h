@@ -0,0 +1,106 @@
+/*********************************************************************************
+*     File Name           :     decompress_task.h
+*     Created By          :     yuewu
+*     Description         :     Thread task to decompress a gzip or zstd file
+*                                 ahead of the reader
+**********************************************************************************/
+#ifndef SOL_PARIO_DECOMPRESS_TASK_H__
+#define SOL_PARIO_DECOMPRESS_TASK_H__
+
+#include <cstdio>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <sol/util/types.h>
+#include <sol/util/block_queue.h>
+#include <sol/util/thread_task.h>
+
+namespace sol {
+namespace pario {
+
+/// \brief  Thread task to decompress a file
+///
+/// The decompressed data is written to a ring of chunks, the thread stays at
+/// most a few chunks ahead of the reader, so that decompression overlaps
+/// with parsing. Gzip is supported when compiled with zlib (HAS_ZLIB), zstd
+/// when compiled with libzstd (HAS_ZSTD).
+class DecompressTask : public ThreadTask {
+ public:
+  enum Format {
+    kNone = 0,
+    kGzip = 1,
+    kZstd = 2
+  };
+
+  /// \brief  detect the compression format by the magic bytes, the file is
+  /// rewound to the beginning
+  ///
+  /// \param file file to detect
+  ///
+  /// \return compression format, kNone if not compressed
+  static Format Detect(FILE* file);
+
+  /// \brief  name of the compression format
+  static const char* FormatName(Format format);
+
+  /// \brief  test if the compression format is compiled in
+  static bool Supported(Format format);
+
+ public:
+  /// \brief  Create a decompression task, the thread is started by Start
+  ///
+  /// \param file compressed file, owned by the caller
+  /// \param format compression format
+  DecompressTask(FILE* file, Format format);
+  virtual ~DecompressTask();
+
+ public:
+  /// \brief  Read the decompressed data, block until the data is available
+  ///
+  /// \param dst Destination buffer to store the data
+  /// \param length Length of data to read
+  ///
+  /// \return number of bytes read, less than length only at the end of file
+  /// or on errors
+  size_t Read(char* dst, size_t length);
+
+  /// \brief  Stop the thread and decompress from the beginning of the file
+  void Restart();
+
+  /// \brief  Stop the thread, the unread data is dropped
+  void Stop();
+
+  /// \brief  Test if no error occurs in reading and decompression
+  inline bool Good() const { return this->failed_ == false; }
+
+ protected:
+  virtual void run();
+
+ private:
+  struct Chunk {
+    std::vector<char> data;
+    size_t len;
+  };
+
+ private:
+  FILE* file_;
+  Format format_;
+
+  // all chunks, empty chunks are in free_chunks_, decompressed ones in
+  // full_chunks_, nullptr in full_chunks_ marks the end of data, nullptr in
+  // free_chunks_ stops the thread
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  BlockQueue<Chunk*> free_chunks_;
+  BlockQueue<Chunk*> full_chunks_;
+
+  // chunk being read and the offset of the unread data
+  Chunk* cur_chunk_;
+  size_t cur_pos_;
+  bool ended_;
+  std::atomic<bool> failed_;
+};
+
+}  // namespace pario
+}  // namespace sol
+#endif
@@ -10,11 +10,14 @@
 #define SOL_PARIO_FILE_READER_H__
 
 #include <cstdio>
+#include <memory>
 #include <sol/util/types.h>
 
 namespace sol {
 namespace pario {
 
+class DecompressTask;
+
 class SOL_EXPORTS FileReader {
   enum ReadMode {
     kUnknown = 0,
@@ -29,7 +32,8 @@ class SOL_EXPORTS FileReader {
 
  public:
   /**
-   * \brief  open a file to read
+   * \brief  open a file to read, gzip and zstd files are detected by the
+   * magic bytes and decompressed in a separate thread
    *
    * \param path Path to the file, set to '-' if read from stdin
    * \param mode 'r' or 'rb'
@@ -55,6 +59,37 @@ class SOL_EXPORTS FileReader {
    */
   bool Good();
 
+  /**
+   * \brief  Move the file reader to the specified byte offset, compressed
+   * files can only be moved to the beginning
+   *
+   * \param offset byte offset from the beginning of the file
+   *
+   * \return Status code, Status_OK if succeed
+   */
+  int Seek(int64_t offset);
+
+  /**
+   * \brief  Byte offset of the next char to read
+   */
+  inline int64_t Tell() const { return this->pos_; }
+
+  /**
+   * \brief  Size of the opened file in bytes, -1 if unknown (stdin or
+   * compressed files)
+   */
+  int64_t Size();
+
+  /**
+   * \brief  Test if the file is compressed
+   */
+  inline bool IsCompressed() const { return this->decompressor_ != nullptr; }
+
+  /**
+   * \brief  Test if the file is opened in `text` mode
+   */
+  inline bool IsText() const { return this->mode_ == kText; }
+
  public:
   /**
    * \brief  Read the data from file with specified length
@@ -77,9 +112,56 @@ class SOL_EXPORTS FileReader {
    */
   int ReadLine(char*& dst, int& dst_len);
 
+  /**
+   * \brief  Read a line without copying, the line is kept in the internal
+   * buffer of the reader, with the newline replaced by '\0'
+   *
+   * \param line pointer to the line, valid until the next read
+   * \param len length of the line, not including the newline
+   *
+   * \return   Status code, Status_OK if succeed
+   */
+  int ReadLine(char*& line, size_t& len);
+
+ private:
+  /**
+   * \brief  Move the unread data to the beginning of the buffer and read the
+   * next chunk of the file after it, the buffer is enlarged if it is full
+   *
+   * \return Status code, Status_EndOfFile if no more data
+   */
+  int FillBuffer();
+
+  /**
+   * \brief  Read the data from the file, or from the decompressor if the
+   * file is compressed
+   *
+   * \return number of bytes read
+   */
+  size_t ReadFile(char* dst, size_t length);
+
+  /**
+   * \brief  Drop the buffered data after the file position is changed
+   */
+  inline void ClearBuffer() {
+    this->buf_begin_ = 0;
+    this->buf_end_ = 0;
+  }
+
  private:
   FILE* file_;
   ReadMode mode_;
+  // decompression thread of compressed files
+  std::unique_ptr<DecompressTask> decompressor_;
+  // byte offset of the next char to read
+  int64_t pos_;
+  // buffer of the data read from file, one extra byte is allocated to
+  // terminate the last line, followed by the padding of NumericParser
+  char* buf_;
+  size_t buf_size_;
+  // unread data in the buffer
+  size_t buf_begin_;
+  size_t buf_end_;
 };  // class FileReader
 
 }  // namespace pario
@@ -0,0 +1,80 @@
+/*********************************************************************************
+*     File Name           :     index_codec.h
+*     Created By          :     yuewu
+*     Description         :     codecs of the sorted feature indexes in the
+*                                 binary formats
+**********************************************************************************/
+
+#ifndef SOL_PARIO_INDEX_CODEC_H__
+#define SOL_PARIO_INDEX_CODEC_H__
+
+#include <string>
+
+#include <sol/math/vector.h>
+#include <sol/util/types.h>
+
+namespace sol {
+namespace pario {
+
+/// \brief  ids of the index codecs, stored in the file header of the block
+/// binary format
+enum IndexCodecType {
+  // 7-bit varint of the deltas, the codec of the binary format (v1)
+  kIndexCodecVarint = 0,
+  // stream-vbyte of the deltas: a 2-bit length of each delta packed in
+  // control bytes, followed by the 1-4 bytes of the deltas
+  kIndexCodecStreamVByte = 1,
+};
+
+/// \brief  Codec of the sorted feature indexes of an instance
+///
+/// Indexes are coded as the deltas to the previous indexes. The number of
+/// indexes is stored by the caller, so that the decoders write straight into
+/// a preallocated index array.
+class SOL_EXPORTS IndexCodec {
+ public:
+  /// \brief  get the codec by id
+  ///
+  /// \return the codec, nullptr if the id is unknown
+  static const IndexCodec* Get(int type);
+
+  /// \brief  get the codec by name ("varint", "streamvbyte")
+  ///
+  /// \return the codec, nullptr if the name is unknown
+  static const IndexCodec* Get(const std::string& name);
+
+ public:
+  virtual ~IndexCodec() {}
+
+  /// \brief  id of the codec, see IndexCodecType
+  virtual int type() const = 0;
+  /// \brief  name of the codec
+  virtual const char* name() const = 0;
+
+  /// \brief  encode the sorted indexes and append the codes
+  ///
+  /// \param indexes indexes sorted from small to big
+  /// \param num number of indexes
+  /// \param codes output codes, not cleared by the function
+  ///
+  /// \return Status code, Status_OK if succeed
+  virtual int Encode(const index_t* indexes, size_t num,
+                     math::Vector<char>& codes) const = 0;
+
+  /// \brief  decode the codes to a preallocated index array
+  ///
+  /// \param codes input codes
+  /// \param code_len length of the codes
+  /// \param indexes output indexes
+  /// \param num number of indexes to decode
+  ///
+  /// \return Status code, Status_Invalid_Format if the codes are not exactly
+  /// num indexes
+  virtual int Decode(const char* codes, size_t code_len, index_t* indexes,
+                     size_t num) const = 0;
+};
+
+}  // namespace pario
+}  // namespace sol
+
+#endif
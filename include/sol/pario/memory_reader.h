@@ -0,0 +1,118 @@
+/*********************************************************************************
+*     File Name           :     memory_reader.h
+*     Created By          :     yuewu
+*     Description         :     reader for dense and csr matrices in memory
+**********************************************************************************/
+
+#ifndef SOL_PARIO_MEMORY_READER_H__
+#define SOL_PARIO_MEMORY_READER_H__
+
+#include <cstddef>
+
+#include <sol/pario/data_reader.h>
+
+namespace sol {
+namespace pario {
+
+/// \brief  element types of the arrays in memory
+enum MemoryDataType {
+  kMemFloat32 = 0,
+  kMemFloat64 = 1,
+  kMemInt32 = 2,
+  kMemInt64 = 3,
+};
+
+/// \brief  Reader of matrices in the memory of the caller
+///
+/// The arrays are read in place with their own element types, each row is
+/// converted into the data point in a single pass. The arrays must stay
+/// valid and unchanged until the reader is released. The reader is not
+/// created by name, use CreateDense or CreateCsr and add it to a DataIter
+/// directly.
+class SOL_EXPORTS MemoryReader : public DataReader {
+ public:
+  MemoryReader();
+  virtual ~MemoryReader() {}
+
+  /// \brief  Create a reader of a dense matrix, zero values are skipped
+  ///
+  /// \param X feature values, row i starts at (char*)X + i * row_stride
+  /// \param x_type element type of X, float32 or float64
+  /// \param Y labels, nullptr if not labeled
+  /// \param y_type element type of Y
+  /// \param rows number of rows
+  /// \param cols number of columns
+  /// \param row_stride number of bytes between the starts of two rows
+  ///
+  /// \return the reader, nullptr if the arguments are invalid
+  static MemoryReader* CreateDense(const void* X, int x_type, const void* Y,
+                                   int y_type, size_t rows, size_t cols,
+                                   size_t row_stride);
+
+  /// \brief  Create a reader of a matrix in compressed sparse row format
+  ///
+  /// \param indptr row i is in [indptr[i], indptr[i + 1]) of indices and
+  /// values
+  /// \param indptr_type element type of indptr, int32 or int64
+  /// \param indices zero-based column indexes
+  /// \param index_type element type of indices, int32 or int64
+  /// \param values feature values
+  /// \param value_type element type of values, float32 or float64
+  /// \param Y labels, nullptr if not labeled
+  /// \param y_type element type of Y
+  /// \param rows number of rows
+  /// \param canonical whether the indexes of each row are sorted and unique,
+  /// the rows are not sorted if true
+  ///
+  /// \return the reader, nullptr if the arguments are invalid
+  static MemoryReader* CreateCsr(const void* indptr, int indptr_type,
+                                 const void* indices, int index_type,
+                                 const void* values, int value_type,
+                                 const void* Y, int y_type, size_t rows,
+                                 bool canonical);
+
+ public:
+  /// \brief  the matrix is set on creation, the path is ignored
+  virtual int Open(const std::string& path, const char* mode = "r");
+  virtual void Close() {}
+  virtual bool Good() { return true; }
+  virtual void Rewind() { this->row_ = 0; }
+
+ public:
+  virtual int Next(DataPoint& dst_data);
+
+ protected:
+  /// \brief  type of the function to convert a row
+  typedef void (*RowReader)(const MemoryReader& reader, size_t row,
+                            DataPoint& dst_data);
+
+  template <typename XType>
+  static void ReadDenseRow(const MemoryReader& reader, size_t row,
+                           DataPoint& dst_data);
+  template <typename PtrType, typename IndexType, typename ValueType>
+  static void ReadCsrRow(const MemoryReader& reader, size_t row,
+                         DataPoint& dst_data);
+
+ protected:
+  RowReader row_reader_;
+  // dense matrix
+  const char* X_;
+  size_t cols_;
+  size_t row_stride_;
+  // csr matrix
+  const void* indptr_;
+  const void* indices_;
+  const void* values_;
+  bool canonical_;
+
+  const void* Y_;
+  int y_type_;
+  size_t rows_;
+  // index of the next row
+  size_t row_;
+};
+
+}  // namespace pario
+}  // namespace sol
+
+#endif
@@ -12,20 +12,50 @@
 #include <vector>
 
 #include <sol/util/types.h>
+#include <sol/util/util.h>
+#include <sol/util/block_queue.h>
+#include <sol/util/ring_queue.h>
 #include <sol/pario/data_point.h>
 
 namespace sol {
 namespace pario {
 
+/// \brief  A batch of data points, indexes and feature values of the points
+/// are stored in two contiguous buffers shared by the batch (in CSR layout),
+/// points are loaded in the order of NextPoint/PushPoint
 class SOL_EXPORTS MiniBatch {
  public:
-  MiniBatch(int batch_size = 0)
-      : data_num(0), points_(nullptr), capacity_(batch_size) {
-    this->points_ = new DataPoint[this->capacity_];
+  /// \brief  Create a mini-batch
+  ///
+  /// \param batch_size max number of points in the batch
+  /// \param feat_capacity initial number of features the shared buffers can
+  /// hold, 0 for default
+  MiniBatch(int batch_size = 0, size_t feat_capacity = 0);
+  ~MiniBatch();
+
+ public:
+  /// \brief  Clear the mini-batch to load new points, the shared buffers are
+  /// enlarged if they overflowed in the last loading
+  void Clear();
+
+  /// \brief  Get the next point to be loaded, the features of the point are
+  /// stored in the remaining space of the shared buffers
+  inline DataPoint& NextPoint() {
+    DataPoint& pt = this->points_[this->data_num];
+    pt.Attach(this->indexes_ + this->feat_num_,
+              this->features_ + this->feat_num_,
+              this->feat_capacity_ - this->feat_num_);
+    return pt;
   }
-  ~MiniBatch() {
-    if (this->points_ != nullptr) {
-      delete[] this->points_;
+
+  /// \brief  Add the point returned by NextPoint to the mini-batch
+  inline void PushPoint() {
+    const DataPoint& pt = this->points_[this->data_num++];
+    this->required_feat_num_ += pt.size();
+    // points overflowing the shared buffers keep their own buffers
+    if (pt.IsAttached(this->indexes_ + this->feat_num_,
+                      this->features_ + this->feat_num_)) {
+      this->feat_num_ += pt.size();
     }
   }
 
@@ -38,13 +68,40 @@ class SOL_EXPORTS MiniBatch {
   }
   inline DataPoint& operator[](size_t index) { return this->points_[index]; }
 
+  /// \brief  number of features stored in the shared buffers
+  inline size_t feat_num() const { return this->feat_num_; }
+  inline size_t feat_capacity() const { return this->feat_capacity_; }
+
   int data_num;
 
+ private:
+  /// \brief  reallocate the shared buffers
+  void ReserveFeatures(size_t feat_capacity);
+
  private:
   DataPoint* points_;
   int capacity_;
+
+  // shared buffers of indexes and features
+  index_t* indexes_;
+  real_t* features_;
+  size_t feat_capacity_;
+  // number of features stored in the shared buffers
+  size_t feat_num_;
+  // number of features of the loaded points
+  size_t required_feat_num_;
+
+  DISABLE_COPY_AND_ASSIGN(MiniBatch);
 };
 
+/// \brief  queue of mini-batches between the readers and the iterator, the
+/// lock-based BlockQueue is used instead if compiled with USE_BLOCK_QUEUE
+#ifdef USE_BLOCK_QUEUE
+typedef BlockQueue<MiniBatch*> MiniBatchQueue;
+#else
+typedef RingQueue<MiniBatch*> MiniBatchQueue;
+#endif
+
 }  // namespace pario
 }  // namespace sol
 #endif
@@ -0,0 +1,63 @@
+/*********************************************************************************
+*     File Name           :     mmap_binary_reader.h
+*     Created By          :     yuewu
+*     Description         :     binary format data reader on memory mapped file
+**********************************************************************************/
+
+#ifndef SOL_PARIO_MMAP_BINARY_READER_H__
+#define SOL_PARIO_MMAP_BINARY_READER_H__
+
+#include <sol/pario/data_reader.h>
+#include <sol/util/mmap_file.h>
+
+namespace sol {
+namespace pario {
+
+/// \brief  Reader of the binary format (same as BinaryReader) which maps the
+/// whole file into memory. Instances are decoded straight from the mapped
+/// pages without any read calls, and Rewind only resets the read position.
+class SOL_EXPORTS MMapBinaryReader : public DataReader {
+ public:
+  MMapBinaryReader();
+  virtual ~MMapBinaryReader();
+
+ public:
+  /// \brief  Open a new file
+  ///
+  /// \param path Path to the file, stdin is not supported
+  /// \param mode ignored, the file is always mapped in binary mode
+  ///
+  /// \return Status code,  Status_OK if succeed
+  virtual int Open(const std::string& path, const char* mode = "rb");
+
+  /// \brief Close the reader
+  virtual void Close();
+
+  /// \brief  Check the status of the data handler
+  ///
+  /// \return True if everything is ok
+  virtual bool Good() { return this->is_good_ && this->file_.Good(); }
+
+  /// \brief  Rewind the dataset to the beginning of the file
+  virtual void Rewind() { this->pos_ = this->file_.begin(); }
+
+ public:
+  /// \brief  Read next data point
+  ///
+  /// \param dst_data Destination data point
+  ///
+  /// \return  Status code, Status_OK if everything ok, Status_EndOfFile if
+  /// read to file end
+  virtual int Next(DataPoint& dst_data);
+
+ private:
+  MMapFile file_;
+  // position of the next instance
+  const char* pos_;
+  bool is_good_;
+};  // class MMapBinaryReader
+
+}  // namespace pario
+}  // namespace sol
+
+#endif
@@ -9,6 +9,21 @@
 #define SOL_PARIO_NUMERIC_PARSER_H__
 
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <sol/util/types.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SOL_SWAR_PARSE 0
+#else
+#define SOL_SWAR_PARSE 1
+#endif
 
 namespace sol {
 namespace pario {
@@ -148,6 +163,143 @@ class SOL_EXPORTS NumericParser {
     }
   }
 
+  //---------------
+  // fast parsers
+  // --------------
+  // The following functions parse long runs of digits 8 bytes at a time with
+  // SWAR (SIMD within a register) operations. The strings must be followed by
+  // kPadding readable bytes after the terminating '\0', like the lines of
+  // FileReader.
+
+  /// \brief  number of bytes that can be read after the end of the strings
+  static const int kPadding = 16;
+  /// \brief  maximum number of digits of the mantissa in uint64_t
+  static const int kMaxFastDigits = 19;
+
+  static inline int ParseIntFast(char* p, char*& end) {
+#if SOL_SWAR_PARSE
+    end = p;
+    char* begin = p;
+    p = strip_line(p);
+    int s = 1;
+    if (*p == '+') {
+      p++;
+    } else if (*p == '-') {
+      s = -1;
+      p++;
+    }
+    char* digits = p;
+    unsigned int acc = 0;
+    while (*p >= '0' && *p <= '9') acc = acc * 10 + (*p++ - '0');
+    if (p == digits || *p == '.' || *p == 'e' || *p == 'E') {
+      return ParseInt(begin, end);
+    }
+    end = strip_line(p);
+    return s * int(acc);
+#else
+    return ParseInt(p, end);
+#endif
+  }
+
+  static inline unsigned int ParseUintFast(char* p, char*& end) {
+#if SOL_SWAR_PARSE
+    end = p;
+    char* begin = p;
+    p = strip_line(p);
+    char* digits = p;
+    unsigned int acc = 0;
+    while (*p >= '0' && *p <= '9') acc = acc * 10 + (*p++ - '0');
+    if (p == digits || *p == '.' || *p == 'e' || *p == 'E') {
+      return ParseUint(begin, end);
+    }
+    end = strip_line(p);
+    return acc;
+#else
+    return ParseUint(p, end);
+#endif
+  }
+
+  /// \brief  parse a float, the result is correctly rounded like strtof
+  static inline float ParseFloatFast(char* p, char*& end) {
+#if SOL_SWAR_PARSE
+    // most values of sparse data are short integers like the binary features,
+    // they are parsed inline as ParseFloat does, the others by ParseFloatLong
+    end = p;
+    char* begin = p;
+    p = strip_line(p);
+    int s = 1;
+    if (*p == '+') {
+      p++;
+    } else if (*p == '-') {
+      s = -1;
+      p++;
+    }
+    char* digits = p;
+    unsigned int acc = 0;
+    while (*p >= '0' && *p <= '9') acc = acc * 10 + unsigned(*p++ - '0');
+    // integers of less than 8 digits are exact in float
+    if (p == digits || p - digits > 7 || *p == '.' || *p == 'e' ||
+        *p == 'E') {
+      return ParseFloatLong(begin, end);
+    }
+    end = strip_line(p);
+    return float(s) * float(int(acc));
+#else
+    return ParseFloat(p, end);
+#endif
+  }
+
+  /// \brief  parse a float with SWAR, mantissas of at most 53 bits with
+  /// exponents in [-22, 22] are converted with one multiplication or division
+  /// in double, the others by strtof
+  static float ParseFloatLong(char* p, char*& end);
+
+ protected:
+  /// \brief  exact powers of ten in double, up to 1e22
+  static inline double Pow10(int exponent) {
+    static const double kPow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    return kPow10[exponent];
+  }
+
+  /// \brief  mask of the high bits of the non-digit bytes in val
+  static inline uint64_t NonDigitMask(uint64_t val) {
+    // a byte is a digit if (byte ^ '0') < 10, the additions do not carry
+    // between bytes as the high bits are masked
+    uint64_t x = val ^ 0x3030303030303030ULL;
+    uint64_t y = (x & 0x7F7F7F7F7F7F7F7FULL) + 0x7676767676767676ULL;
+    return (x | y) & 0x8080808080808080ULL;
+  }
+
+  /// \brief  parse a run of digits and append them to acc, short runs are
+  /// parsed byte by byte as their lengths are well predicted, runs of at
+  /// least 8 digits are parsed 8 bytes at a time
+  ///
+  /// \param p pointer to the digits, moved to the first non-digit char
+  /// \param acc accumulated value
+  ///
+  /// \return number of digits
+  static inline int ParseDigits(char*& p, uint64_t& acc) {
+    char* begin = p;
+    uint64_t val;
+    memcpy(&val, p, sizeof(val));
+    uint64_t non_digits = NonDigitMask(val);
+    while (non_digits == 0) {
+      // 8 digits: "12345678" -> 12345678
+      val -= 0x3030303030303030ULL;
+      val = (val * 10) + (val >> 8);
+      val = (((val & 0x000000FF000000FFULL) * 0x000F424000000064ULL) +
+             (((val >> 16) & 0x000000FF000000FFULL) *
+              0x0000271000000001ULL)) >> 32;
+      acc = acc * 100000000ULL + val;
+      p += 8;
+      memcpy(&val, p, sizeof(val));
+      non_digits = NonDigitMask(val);
+    }
+    while (*p >= '0' && *p <= '9') acc = acc * 10 + uint64_t(*p++ - '0');
+    return int(p - begin);
+  }
 };  // class NumericParser
 
 }  // namespace pario
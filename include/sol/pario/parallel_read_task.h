@@ -0,0 +1,76 @@
+/*********************************************************************************
+*     File Name           :     parallel_read_task.h
+*     Created By          :     yuewu
+*     Description         :     Thread task to parse a text data in parallel
+**********************************************************************************/
+#ifndef SOL_PARIO_PARALLEL_READ_TASK_H__
+#define SOL_PARIO_PARALLEL_READ_TASK_H__
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <sol/pario/mini_batch.h>
+#include <sol/pario/data_reader.h>
+#include <sol/util/block_queue.h>
+#include <sol/util/thread_task.h>
+
+namespace sol {
+namespace pario {
+
+class BlockParseTask;
+
+/// \brief  Thread task to read one text data with several parser threads
+///
+/// The file is split into newline-aligned blocks, which are assigned to the
+/// parser threads in a round-robin way. Each parser fills the mini-batches of
+/// its own pool, and the task hands the loaded mini-batches over to
+/// mini_batch_buf in exchange of empty ones from mini_batch_factory. If
+/// keep_order is set, the mini-batches are handed over in the order of the
+/// blocks, so that the data is iterated in the original order.
+class ParallelReadTask : public ThreadTask {
+ public:
+  /// \brief  Initialize the Parallel Read Task
+  ///
+  /// \param path data file path
+  /// \param dtype data type (svm, csv, etc.)
+  /// \param mini_batch_factory factory of empty mini batch
+  /// \param mini_batch_buf place to store the loaded mini batched
+  /// \param pass_num number of passes to read the data
+  /// \param thread_num number of parser threads
+  /// \param keep_order whether to keep the original order of the data
+  /// \param batch_size size of the mini-batches owned by the parsers
+  /// \param block_size size of the blocks in bytes, 0 for default
+  ParallelReadTask(const std::string& path, const std::string& dtype,
+                   MiniBatchQueue& mini_batch_factory,
+                   MiniBatchQueue& mini_batch_buf, int pass_num,
+                   int thread_num, bool keep_order, int batch_size,
+                   int64_t block_size = 0);
+  virtual ~ParallelReadTask();
+
+ public:
+  inline bool Good() { return this->parsers_.size() > 0; }
+
+ protected:
+  virtual void run();
+
+  /// \brief  stop the parsers and release their mini-batches
+  void StopParsers();
+
+ private:
+  MiniBatchQueue& mini_batch_factory_;
+  MiniBatchQueue& mini_batch_buf_;
+  int pass_num_;
+  bool keep_order_;
+  int64_t block_num_;
+
+  std::vector<std::shared_ptr<BlockParseTask>> parsers_;
+  // empty mini-batches of parsers, one queue per parser if keep_order
+  std::vector<std::shared_ptr<MiniBatchQueue>> factories_;
+  // loaded mini-batches of parsers, nullptr denotes the end of a block
+  std::vector<std::shared_ptr<MiniBatchQueue>> bufs_;
+};
+
+}  // namespace pario
+}  // namespace sol
+#endif
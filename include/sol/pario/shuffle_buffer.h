@@ -0,0 +1,73 @@
+/*********************************************************************************
+*     File Name           :     shuffle_buffer.h
+*     Created By          :     yuewu
+*     Description         :     window of data points to shuffle a data stream
+**********************************************************************************/
+#ifndef SOL_PARIO_SHUFFLE_BUFFER_H__
+#define SOL_PARIO_SHUFFLE_BUFFER_H__
+
+#include <vector>
+#include <random>
+
+#include <sol/util/types.h>
+#include <sol/pario/data_point.h>
+
+namespace sol {
+namespace pario {
+
+/// \brief  A window of data points, points are popped in a uniformly random
+/// order
+///
+/// The features of the points are stored in an arena in CSR layout, popped
+/// points leave holes in the arena, which is compacted when the holes take
+/// more space than the remaining points.
+class SOL_EXPORTS ShuffleBuffer {
+ public:
+  /// \brief  Create a shuffle buffer
+  ///
+  /// \param window_size number of points to fill the buffer to, Push does not
+  /// limit the size
+  /// \param seed seed of the random generator
+  ShuffleBuffer(size_t window_size, unsigned int seed);
+
+ public:
+  /// \brief  copy a point into the buffer
+  void Push(const DataPoint& pt);
+
+  /// \brief  remove a random point from the buffer
+  ///
+  /// \param dst_pt destination point
+  void Pop(DataPoint& dst_pt);
+
+  /// \brief  remove all points
+  void Clear();
+
+ public:
+  inline size_t size() const { return this->live_slots_.size(); }
+  inline bool full() const { return this->size() >= this->window_size_; }
+  inline size_t window_size() const { return this->window_size_; }
+
+ protected:
+  /// \brief  move the remaining points to the beginning of the arena
+  void Compact();
+
+ protected:
+  size_t window_size_;
+  std::mt19937 gen_;
+
+  // labels, offsets, and feature numbers of the slots in the arena
+  std::vector<label_t> labels_;
+  std::vector<size_t> offsets_;
+  std::vector<size_t> feat_nums_;
+  // slots of the points not popped yet
+  std::vector<size_t> live_slots_;
+  // arena of features
+  std::vector<index_t> indexes_;
+  std::vector<real_t> features_;
+  // number of features of the popped points in the arena
+  size_t dead_feat_num_;
+};
+
+}  // namespace pario
+}  // namespace sol
+#endif
@@ -23,6 +23,16 @@ class SOL_EXPORTS SVMReader : public DataFileReader {
   /// \return  Status code, Status_OK if everything ok, Status_EndOfFile if
   /// read to file end
   virtual int Next(DataPoint& dst_data);
+
+  /// \brief  Parse a line of libsvm format
+  ///
+  /// \param line line terminated by '\0', without the line break; the numbers
+  /// are parsed several bytes at a time, so NumericParser::kPadding bytes
+  /// after the '\0' must be readable
+  /// \param dst_data Destination data point
+  ///
+  /// \return  Status code, Status_Invalid_Format if the line is not valid
+  static int ParseLine(char* line, DataPoint& dst_data);
 };  // class SVMReader
 
 }  // namespace pario
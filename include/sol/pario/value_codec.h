@@ -0,0 +1,86 @@
+/*********************************************************************************
+*     File Name           :     value_codec.h
+*     Created By          :     yuewu
+*     Description         :     encodings of the feature values in the block
+*                                 binary format
+**********************************************************************************/
+
+#ifndef SOL_PARIO_VALUE_CODEC_H__
+#define SOL_PARIO_VALUE_CODEC_H__
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <sol/util/types.h>
+
+namespace sol {
+namespace pario {
+
+/// \brief  encodings of the values of a record, the encoded values start
+/// with a byte of the encoding
+enum ValueEncoding {
+  // 4-byte floats
+  kValueFloat = 0,
+  // all values are 1.0, nothing is stored
+  kValueOne = 1,
+  // IEEE half floats
+  kValueFp16 = 2,
+  // bfloat16, the higher 16 bits of the floats
+  kValueBf16 = 3,
+  // float scale followed by int8 values, value = int8 * scale
+  kValueInt8 = 4,
+};
+
+/// \brief  precision the writer may drop to encode the values
+enum ValuePrecision {
+  // the values are decoded exactly
+  kPrecisionLossless = 0,
+  // values may be rounded to fp16, bf16, or int8 with a scale
+  kPrecisionFp16 = 1,
+  kPrecisionBf16 = 2,
+  kPrecisionInt8 = 3,
+};
+
+/// \brief  convert a float to half float, rounded to the nearest even
+SOL_EXPORTS uint16_t FloatToHalf(float val);
+/// \brief  convert a half float to float
+SOL_EXPORTS float HalfToFloat(uint16_t val);
+/// \brief  convert a float to bfloat16, rounded to the nearest even
+SOL_EXPORTS uint16_t FloatToBf16(float val);
+/// \brief  convert a bfloat16 to float
+inline float Bf16ToFloat(uint16_t val) {
+  uint32_t bits = uint32_t(val) << 16;
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+/// \brief  encode the values with the smallest encoding allowed by the
+/// precision, and append them to dst
+///
+/// \param values values to encode
+/// \param num number of values
+/// \param precision see ValuePrecision
+/// \param dst output buffer
+///
+/// \return the chosen encoding, see ValueEncoding
+SOL_EXPORTS int EncodeValues(const real_t* values, size_t num, int precision,
+                             std::vector<char>& dst);
+
+/// \brief  decode the values
+///
+/// \param src encoded values
+/// \param len length of the available data
+/// \param values output values
+/// \param num number of values
+/// \param used number of bytes of the encoded values
+///
+/// \return Status code, Status_Invalid_Format if the data is not valid
+SOL_EXPORTS int DecodeValues(const char* src, size_t len, real_t* values,
+                             size_t num, size_t& used);
+
+}  // namespace pario
+}  // namespace sol
+
+#endif
@@ -6,10 +6,16 @@
 #ifndef SOL_TOOLS_H__
 #define SOL_TOOLS_H__
 
+#include <cstdint>
 #include <string>
 #include "sol/util/types.h"
 
 namespace sol {
+/// \brief  bytes of the source data of each shard loaded into memory by
+/// shuffle and split, compressed source data is measured by its
+/// decompressed size
+const int64_t kDefaultShardSize = int64_t(64) << 20;
+
 SOL_EXPORTS int analyze(const std::string& src_path,
                         const std::string& src_type,
                         const std::string& output_path);
@@ -24,10 +30,12 @@ SOL_EXPORTS int convert(const std::string& src_path,
 SOL_EXPORTS int shuffle(const std::string& src_path,
                         const std::string& src_type,
                         const std::string& output_path,
-                        const std::string& output_type);
+                        const std::string& output_type,
+                        int64_t shard_size = kDefaultShardSize);
 
 SOL_EXPORTS int split(const std::string& src_path, const std::string& src_type,
                       int fold_num, const std::string& output_prefix,
-                      const std::string& dst_type, bool shuffle);
+                      const std::string& dst_type, bool shuffle,
+                      int64_t shard_size = kDefaultShardSize);
 }
 #endif
@@ -60,7 +60,10 @@ class BlockQueue {
   /// \brief a block queue to schedule tasks
   ///
   /// \param queue_size size of the task queue
-  BlockQueue(int queue_size)
+  /// \param single_producer not used, the same interface as RingQueue
+  /// \param single_consumer not used, the same interface as RingQueue
+  BlockQueue(int queue_size, bool single_producer = false,
+             bool single_consumer = false)
       : elems_(nullptr),
         elem_num_(0),
         head_(0),
@@ -55,6 +55,12 @@ class Heap {
   /// \return element index that is moved out-of the heap
   index_t UpdateHeap(index_t idx);
 
+  /// \brief  restore the heap properties after the value of an element in the
+  // heap is changed, do nothing if idx is outside of the heap
+  ///
+  /// \param idx the index whose value is changed
+  void AdjustValue(index_t idx);
+
   /// \brief  adjust the heap to satisfy heap properties
   ///
   /// \param s r[s+1,...,m] is heap, adjust the heap so that r[s,..,m] is heap
@@ -187,6 +193,27 @@ index_t Heap<comparator>::UpdateHeap(index_t idx) {
   }
 }
 
+template <typename comparator>
+void Heap<comparator>::AdjustValue(index_t idx) {
+  index_t pos = this->id2pos_map_[idx];
+  if (pos >= this->K_) return;
+
+  real_t cur_val = this->values_[idx];
+  // move up
+  while (pos > 0) {
+    index_t parent_pos = (pos - 1) / 2;
+    index_t parent_id = this->pos2id_map_[parent_pos];
+    if (!comparator::map(cur_val, this->values_[parent_id])) break;
+    this->pos2id_map_[pos] = parent_id;
+    this->id2pos_map_[parent_id] = pos;
+    pos = parent_pos;
+  }
+  this->pos2id_map_[pos] = idx;
+  this->id2pos_map_[idx] = pos;
+  // move down
+  this->AdjustHeap(pos, this->K_ - 1);
+}
+
 template <typename comparator>
 void Heap<comparator>::AdjustHeap(index_t s, index_t m) {
   index_t tgt_id = this->pos2id_map_[s];   // parent id
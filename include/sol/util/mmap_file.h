@@ -0,0 +1,59 @@
+/*********************************************************************************
+*     File Name           :     mmap_file.h
+*     Created By          :     yuewu
+*     Description         :     memory mapped file
+**********************************************************************************/
+
+#ifndef SOL_UTIL_MMAP_FILE_H__
+#define SOL_UTIL_MMAP_FILE_H__
+
+#include <cstddef>
+#include <sol/util/types.h>
+#include <sol/util/util.h>
+
+namespace sol {
+
+/// \brief  map a whole file into memory for reading
+class SOL_EXPORTS MMapFile {
+ public:
+  MMapFile();
+  ~MMapFile();
+
+ public:
+  /// \brief  map the file into memory
+  ///
+  /// \param path path to the file
+  /// \param copy_on_write whether the mapped memory is writable, the
+  /// modified pages are private copies and never written back to the file
+  ///
+  /// \return Status code, Status_OK if succeed
+  int Open(const char* path, bool copy_on_write = false);
+
+  /// \brief  unmap the file
+  void Close();
+
+  inline bool Good() const { return this->opened_; }
+
+ public:
+  inline const char* begin() const { return this->data_; }
+  inline const char* end() const { return this->data_ + this->size_; }
+  inline size_t size() const { return this->size_; }
+  /// \brief  writable begin of the memory, only valid if copy_on_write
+  inline char* data() { return this->copy_on_write_ ? this->data_ : nullptr; }
+
+ private:
+  char* data_;
+  size_t size_;
+  bool opened_;
+  bool copy_on_write_;
+#if _WIN32
+  void* file_handle_;
+  void* map_handle_;
+#endif
+
+  DISABLE_COPY_AND_ASSIGN(MMapFile);
+};
+
+}  // namespace sol
+
+#endif
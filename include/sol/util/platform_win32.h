@@ -22,6 +22,12 @@ inline FILE* open_file(const char* path, const char* mode) {
   return file;
 }
 
+inline int seek_file(FILE* file, int64_t offset, int origin) {
+  return _fseeki64(file, offset, origin);
+}
+
+inline int64_t tell_file(FILE* file) { return _ftelli64(file); }
+
 }  // namespace sol
 
 #endif  // SOL_UTIL_PLATFORM_WIN32_H__
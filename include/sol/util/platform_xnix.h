@@ -15,6 +15,12 @@ inline FILE* open_file(const char* path, const char* mode) {
   return fopen(path, mode);
 }
 
+inline int seek_file(FILE* file, int64_t offset, int origin) {
+  return fseeko(file, off_t(offset), origin);
+}
+
+inline int64_t tell_file(FILE* file) { return int64_t(ftello(file)); }
+
 }  // namespace sol
 
 #endif
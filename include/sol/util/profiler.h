@@ -0,0 +1,98 @@
+/*********************************************************************************
+*     File Name           :     profiler.h
+*     Created By          :     yuewu
+*     Description         :     timing counters of the pipeline stages
+**********************************************************************************/
+
+#ifndef SOL_UTIL_PROFILER_H__
+#define SOL_UTIL_PROFILER_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <sol/util/types.h>
+
+namespace sol {
+
+/// \brief  stages of the training and prediction pipeline
+enum ProfileStage {
+  kStageRead = 0,    // parse data points in the reader threads
+  kStageWait = 1,    // wait for mini-batches in DataIter::Next
+  kStagePreProcess,  // Model::PreProcess
+  kStagePredict,     // OnlineModel::TrainPredict
+  kStageGradient,    // Loss::gradient
+  kStageUpdate,      // OnlineModel::Update
+  kStageNum
+};
+
+/// \brief  Per-thread cycle counters of the pipeline stages
+///
+/// Each thread accumulates the ticks and calls of the stages into its own
+/// counters, which are summed up when the report is made. The counters are
+/// only touched when profiling is enabled, otherwise a ProfileScope costs a
+/// relaxed load and a branch.
+class SOL_EXPORTS Profiler {
+ public:
+  /// \brief  enable or disable profiling, the counters are kept
+  static void Enable(bool enable);
+  static inline bool enabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /// \brief  clear the counters of all threads, better called when no stage
+  /// is running, or the running stages may be added to the old counters
+  static void Reset();
+
+  /// \brief  add the ticks of a stage to the counters of the calling thread
+  static void Add(int stage, uint64_t ticks);
+
+  /// \brief  report of the counters in json, including the total and
+  /// per-thread seconds, calls and ticks of each stage
+  static std::string Report();
+
+  /// \brief  one line of the total seconds of each stage
+  static std::string Summary();
+
+  static const char* StageName(int stage);
+
+  /// \brief  current value of the cycle counter, or nanoseconds if the cpu
+  /// has no cycle counter
+  static inline uint64_t ticks() {
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#else
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count());
+#endif
+  }
+
+ protected:
+  static std::atomic<bool> enabled_;
+};
+
+/// \brief  add the time from construction to destruction to a stage
+class ProfileScope {
+ public:
+  explicit ProfileScope(int stage)
+      : stage_(stage), start_(Profiler::enabled() ? Profiler::ticks() : 0) {}
+  ~ProfileScope() {
+    if (this->start_ != 0) {
+      Profiler::Add(this->stage_, Profiler::ticks() - this->start_);
+    }
+  }
+
+ protected:
+  int stage_;
+  uint64_t start_;
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+}  // namespace sol
+
+#endif
@@ -0,0 +1,232 @@
+/*********************************************************************************
+*     File Name           :     ring_queue.h
+*     Created By          :     yuewu
+*     Description         :     A lock-free bounded circular queue
+**********************************************************************************/
+
+#ifndef SOL_UTIL_RING_QUEUE_H__
+#define SOL_UTIL_RING_QUEUE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include <sol/util/mutex.h>
+#include <sol/util/monitor.h>
+#include <sol/util/block_queue.h>
+
+namespace sol {
+
+/// \brief  A fixed-size lock-free circular queue
+///
+/// Each slot carries a sequence number telling whether it is ready to be
+/// written or read (the bounded MPMC queue of D. Vyukov), so producers and
+/// consumers only contend on the head or tail counter. With a single producer
+/// or a single consumer, the counter of that side is advanced by a plain
+/// store instead of a CAS. Blocked threads spin for a while and then park on a
+/// condition variable, which is signaled only if some thread is parked.
+///
+/// The interface is the same as BlockQueue for single elements.
+///
+/// \tparam T Queue element type
+template <typename T, QueueType QType = QueueType::Managed>
+class RingQueue {
+ public:
+  /// \brief  Create a queue
+  ///
+  /// \param queue_size minimum size of the queue, rounded up to a power of 2
+  /// and at least 2
+  /// \param single_producer whether only one thread enqueues at a time
+  /// \param single_consumer whether only one thread dequeues at a time
+  RingQueue(int queue_size, bool single_producer = false,
+            bool single_consumer = false)
+      : single_producer_(single_producer),
+        single_consumer_(single_consumer),
+        head_(0),
+        tail_(0),
+        waiter_num_(0),
+        lock_(),
+        nonfull_(lock_),
+        nonempty_(lock_) {
+    // a single cell is ready to be written and read at the same sequence
+    // number, so that a full queue is overwritten
+    size_t size = 2;
+    while (size < size_t(queue_size > 2 ? queue_size : 2)) size <<= 1;
+    this->mask_ = size - 1;
+    this->cells_ = new Cell[size];
+    for (size_t i = 0; i < size; ++i) {
+      this->cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~RingQueue() {
+    QueueType_traits<QType> destory;
+    T elem;
+    while (this->TryDequeue(elem)) destory(elem);
+    delete[] this->cells_;
+  }
+
+ public:
+  /// \brief  Block until not full
+  ///
+  /// \param elem element to be enqueued
+  void Enqueue(const T& elem) {
+    if (this->TryEnqueue(elem)) {
+      this->Notify(this->nonempty_);
+      return;
+    }
+    this->Wait(this->nonfull_, [&]() { return this->TryEnqueue(elem); });
+    this->Notify(this->nonempty_);
+  }
+
+  /// \brief  Blocks until not empty.
+  T Dequeue() {
+    T elem;
+    if (this->TryDequeue(elem) == false) {
+      this->Wait(this->nonempty_, [&]() { return this->TryDequeue(elem); });
+    }
+    this->Notify(this->nonfull_);
+    return elem;
+  }
+
+  /// \brief  Enqueue an element if not full
+  ///
+  /// \return false if the queue is full
+  bool TryEnqueue(const T& elem) {
+    size_t pos = this->tail_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+      cell = &this->cells_[pos & this->mask_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = intptr_t(seq) - intptr_t(pos);
+      if (diff == 0) {
+        if (this->single_producer_) {
+          this->tail_.store(pos + 1, std::memory_order_relaxed);
+          break;
+        }
+        if (this->tail_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // full
+      } else {
+        pos = this->tail_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->elem = elem;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// \brief  Dequeue an element if not empty
+  ///
+  /// \return false if the queue is empty
+  bool TryDequeue(T& elem) {
+    size_t pos = this->head_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+      cell = &this->cells_[pos & this->mask_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+      if (diff == 0) {
+        if (this->single_consumer_) {
+          this->head_.store(pos + 1, std::memory_order_relaxed);
+          break;
+        }
+        if (this->head_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // empty
+      } else {
+        pos = this->head_.load(std::memory_order_relaxed);
+      }
+    }
+    elem = cell->elem;
+    cell->seq.store(pos + this->mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+ public:
+  int capacity() const { return int(this->mask_ + 1); }
+  bool empty() const { return this->size() == 0; }
+  /// \brief  number of elements, approximate if other threads are running
+  int size() const {
+    size_t head = this->head_.load(std::memory_order_acquire);
+    size_t tail = this->tail_.load(std::memory_order_acquire);
+    return tail > head ? int(tail - head) : 0;
+  }
+
+ protected:
+  /// \brief  spin, yield, and then park until the operation succeeds
+  template <typename Op>
+  void Wait(Monitor& cond, Op op) {
+    // spinning only delays the other threads on a single cpu
+    static const int spin_num =
+        std::thread::hardware_concurrency() > 1 ? kSpinNum : 0;
+    for (int i = 0; i < spin_num; ++i) {
+      Pause();
+      if (op()) return;
+    }
+    for (int i = 0; i < kYieldNum; ++i) {
+      std::this_thread::yield();
+      if (op()) return;
+    }
+    this->lock_.lock();
+    // the counter is increased before trying again, so that the operation
+    // either succeeds or a notifier sees the waiter
+    this->waiter_num_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (op() == false) cond.wait();
+    this->waiter_num_.fetch_sub(1, std::memory_order_relaxed);
+    this->lock_.unlock();
+  }
+
+  /// \brief  wake up the parked threads
+  void Notify(Monitor& cond) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->waiter_num_.load(std::memory_order_relaxed) == 0) return;
+    this->lock_.lock();
+    cond.notify_all();
+    this->lock_.unlock();
+  }
+
+  static inline void Pause() {
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#endif
+  }
+
+ protected:
+  static const int kSpinNum = 256;
+  static const int kYieldNum = 16;
+  static const size_t kCacheLineSize = 64;
+
+  struct Cell {
+    std::atomic<size_t> seq;
+    T elem;
+  };
+
+  Cell* cells_;
+  size_t mask_;
+  bool single_producer_;
+  bool single_consumer_;
+  // producers and consumers work on different cache lines
+  char pad0_[kCacheLineSize];
+  std::atomic<size_t> head_;
+  char pad1_[kCacheLineSize];
+  std::atomic<size_t> tail_;
+  char pad2_[kCacheLineSize];
+  // number of parked threads
+  std::atomic<int> waiter_num_;
+  Mutex lock_;
+  Monitor nonfull_;
+  Monitor nonempty_;
+};
+
+}  // namespace sol
+#endif
@@ -10,6 +10,7 @@
 #define SHENTU_UTIL_THREAD_TASK_H__
 
 #include <memory>
+#include <functional>
 #include <sol/util/thread.h>
 
 namespace sol {
@@ -36,5 +37,17 @@ class ThreadTask {
   std::unique_ptr<Thread> thread_;
 };  // class ThreadTask
 
+/// \brief  task to run a function in a separate thread
+class FunctionTask : public ThreadTask {
+ public:
+  FunctionTask(const std::function<void()>& func) : func_(func) {}
+
+ protected:
+  virtual void run() { this->func_(); }
+
+ protected:
+  std::function<void()> func_;
+};  // class FunctionTask
+
 }  // namespace sol
 #endif
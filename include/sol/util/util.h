@@ -10,6 +10,7 @@
 #define SOL_UTIL_PLATFORM_H__
 
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <sstream>
@@ -18,7 +18,7 @@ cdef void desicion_function_callback(void* user_context,
         double label,
         double predict,
         int cls_num,
-        float* scores):
+        float* scores) with gil:
     handler = <object>user_context
     handler[0].append(label)
     handler[1].append(predict)
@@ -28,7 +28,7 @@ cdef void predict_callback(void* user_context,
         double label,
         double predict,
         int cls_num,
-        float* scores):
+        float* scores) with gil:
     handler = <object>user_context
     handler[0].append(label)
     handler[1].append(predict)
@@ -37,20 +37,64 @@ cdef void inspect_iteration(void* user_context,
         long long data_num,
         long long iter_num,
         long long update_num,
-        double err_rate ):
+        double err_rate ) with gil:
     handler = <object>user_context
     if handler is not None:
         handler(data_num, iter_num, update_num, err_rate)
 
+# element types of the arrays read in place, see sol_data_type in c_api.h
+_data_types = {np.dtype(np.float32): 0, np.dtype(np.float64): 1,
+               np.dtype(np.int32): 2, np.dtype(np.int64): 3}
+_float_types = (np.dtype(np.float32), np.dtype(np.float64))
+_int_types = (np.dtype(np.int32), np.dtype(np.int64))
+
+def _typed_array(array, dtypes):
+    """return a contiguous array of one of the dtypes, array itself if possible"""
+    array = np.asarray(array)
+    if array.dtype not in dtypes:
+        return np.ascontiguousarray(array, dtype=dtypes[-1])
+    return np.ascontiguousarray(array)
+
+def _label_array(y):
+    """return the labels as an array to be read in place, floating labels of
+    the other types are converted to float64 instead of int64"""
+    y = np.asarray(y)
+    if y.dtype not in _data_types and np.issubdtype(y.dtype, np.floating):
+        return np.ascontiguousarray(y, dtype=np.float64)
+    return _typed_array(y, _float_types + _int_types)
+
+def _dense_array(X):
+    """return X if its rows can be read in place, or a float64 copy"""
+    # rows may be strided, but the features of a row are contiguous
+    if (X.ndim != 2 or X.dtype not in _float_types or
+            X.strides[0] < 0 or X.strides[1] != X.itemsize):
+        return np.ascontiguousarray(X, dtype=np.float64)
+    return X
+
+def _csr_arrays(X):
+    """return the indptr, indices, and data arrays of a csr_matrix to be read in place"""
+    return (_typed_array(X.indptr, _int_types),
+            _typed_array(X.indices, _int_types),
+            _typed_array(X.data, _float_types))
+
+def _bytes(s):
+    """return the bytes of a path or data type to be passed as const char*"""
+    return s if isinstance(s, bytes) else s.encode()
+
+cdef const void* _data_ptr(np.ndarray array):
+    return <const void*>array.data
+
 cdef class SOL:
     cdef void* _c_model
     cdef void* _c_data_iter
     cdef const char* algo
     cdef int class_num
     cdef bint verbose
+    cdef object _arrays
 
     def  __cinit__(self, const char* algo = NULL, int class_num = -1, int
-            batch_size=256, int buf_size = 2, verbose=False, **params):
+            batch_size=256, int buf_size = 2, int reader_num = 1,
+            verbose=False, **params):
         """Create a new Handle for SOL C Library
 
         Parameters
@@ -63,6 +107,8 @@ cdef class SOL:
             size of mini-batches in processing
         buf_size: int
             number of mini-batches for bufferring
+        reader_num: int
+            maximum number of data files read at the same time
 
         Returns
         -------
@@ -82,6 +128,7 @@ cdef class SOL:
 
         if self._c_data_iter is NULL:
             raise MemoryError()
+        sol_SetMaxRunningReaderNum(self._c_data_iter, reader_num)
 
         if verbose == False:
             self.inspect_learning(None)
@@ -148,7 +195,8 @@ cdef class SOL:
 
         Parameters
         ----------
-        param1: string, data path or {array-like or sparse matrix}, shape = [n_samples, n_features]
+        param1: string, data path, list of data paths read by up to
+            reader_num readers at the same time, or {array-like or sparse matrix}, shape = [n_samples, n_features]
             Training vector, where n_samples is the number of samples and n_features is the number of features
         param2: string, data type or array-like, shape=[n_samples]
             Target label vector relative to X
@@ -157,43 +205,97 @@ cdef class SOL:
         """
         cdef int ret = 0
 
-        if isinstance(param1, str):
-            ret = sol_LoadData(self._c_data_iter, <const char*>param1, <const char*>param2, pass_num)
+        if isinstance(param1, (str, list, tuple)):
+            paths = [param1] if isinstance(param1, str) else param1
+            dtype = _bytes(param2)
+            for path in paths:
+                path = _bytes(path)
+                ret = sol_LoadData(self._c_data_iter, <const char*>path, <const char*>dtype, pass_num)
+                if ret != 0:
+                    break
         else:
             if param2 is None:
                 param2 = np.zeros(param1.shape[0], dtype=np.float64)
-            assert param1.dtype == np.float64, "only float64 data are allowed"
-            assert param2.dtype == np.float64, "only float64 labels are allowed"
-            X = param1
-            y = param2
+            y = _label_array(param2)
 
             if isinstance(param1, np.ndarray):
-                ret = sol_loadArray(self._c_data_iter,
-                        (<np.ndarray[np.float64_t, ndim=2, mode='c']>X).data,
-                        (<np.ndarray[np.float64_t, ndim=1, mode='c']>y).data,
-                        (<np.ndarray[np.float64_t, ndim=2, mode='c']>X).shape,
-                        (<np.ndarray[np.float64_t, ndim=2, mode='c']>X).strides,
-                        pass_num)
+                X = _dense_array(param1)
+                if y.shape[0] != X.shape[0]:
+                    raise ValueError("numbers of samples and labels are different")
+                ret = sol_LoadDenseData(self._c_data_iter,
+                        _data_ptr(X), _data_types[X.dtype],
+                        _data_ptr(y), _data_types[y.dtype],
+                        X.shape[0], X.shape[1], X.strides[0], pass_num)
+                arrays = (X, y)
             elif isinstance(param1, csr_matrix):
-                ret= sol_loadCsrMatrix(self._c_data_iter,
-                        (<np.ndarray[np.int32_t,   ndim=1, mode='c']>X.indices).data,
-                        (<np.ndarray[np.int32_t,   ndim=1, mode='c']>X.indptr).data,
-                        (<np.ndarray[np.float64_t, ndim=1, mode='c']>X.data).data,
-                        (<np.ndarray[np.float64_t, ndim=1, mode='c']>y).data,
-                        (<np.ndarray[np.int32_t,   ndim=1, mode='c']>X.indptr).shape[0] - 1,
-                        pass_num)
+                X = param1
+                indptr, indices, values = _csr_arrays(X)
+                if y.shape[0] != indptr.shape[0] - 1:
+                    raise ValueError("numbers of samples and labels are different")
+                ret = sol_LoadCsrData(self._c_data_iter,
+                        _data_ptr(indptr), _data_types[indptr.dtype],
+                        _data_ptr(indices), _data_types[indices.dtype],
+                        _data_ptr(values), _data_types[values.dtype],
+                        _data_ptr(y), _data_types[y.dtype],
+                        X.shape[0], X.has_canonical_format, pass_num)
+                arrays = (indptr, indices, values, y)
             else:
                 raise TypeError("only data path or numpy.ndarray or csr_matrix are allowed")
+            # the arrays are read in place, keep them alive until the data is
+            # iterated
+            self._arrays = arrays
 
         if ret != 0:
             raise RuntimeError('load data failed')
 
+    cdef _predict_with_callback(self, sol_predict_callback callback, result):
+        """predict the loaded data by sol_Predict, the callback takes the GIL
+        to append the results"""
+        cdef void* model = self._c_model
+        cdef void* data_iter = self._c_data_iter
+        cdef void* context = <void*>result
+        with nogil:
+            sol_Predict(model, data_iter, callback, context)
+
+    def __predict_batch(self, int n_samples, bint get_scores):
+        """predict the loaded in-memory data into numpy arrays
+
+        Parameters
+        ----------
+        n_samples: int
+            number of samples of the loaded data
+        get_scores: bool
+            whether to return the scores
+
+        Returns
+        -------
+        scores: array, shape = [n_samples, n_classifiers], or None
+        predicts: array, shape = [n_samples]
+        labels: array, shape = [n_samples]
+        """
+        cdef int clf_num = sol_model_clf_num(self._c_model)
+        cdef np.ndarray[np.float64_t, ndim=1, mode='c'] labels = np.empty(n_samples, dtype=np.float64)
+        cdef np.ndarray[np.float64_t, ndim=1, mode='c'] predicts = np.empty(n_samples, dtype=np.float64)
+        cdef np.ndarray[np.float32_t, ndim=2, mode='c'] scores = None
+        cdef float* scores_ptr = NULL
+        cdef int ret = 0
+        if get_scores:
+            scores = np.empty((n_samples, clf_num), dtype=np.float32)
+            scores_ptr = <float*>scores.data
+
+        with nogil:
+            ret = sol_PredictBatch(self._c_model, self._c_data_iter, n_samples,
+                    <double*>labels.data, <double*>predicts.data, scores_ptr)
+        if ret != n_samples:
+            raise RuntimeError('predict data failed')
+        return scores, predicts, labels
+
     def fit(self, param1, param2, int pass_num = 1):
         """learn data from numpy array
 
         Parameters
         ----------
-        param1: string, data path or {array-like or sparse matrix}, shape = [n_samples, n_features]
+        param1: string, data path, list of data paths, or {array-like or sparse matrix}, shape = [n_samples, n_features]
             Training vector, where n_samples is the number of samples and n_features is the number of features
         param2: string, data type or array-like, shape=[n_samples]
             Target label vector relative to X
@@ -208,14 +310,77 @@ cdef class SOL:
 
         self.__load_data(param1, param2, pass_num)
 
-        return 1 - sol_Train(self._c_model, self._c_data_iter)
+        cdef void* model = self._c_model
+        cdef void* data_iter = self._c_data_iter
+        cdef float err_rate = 0
+        with nogil:
+            err_rate = sol_Train(model, data_iter)
+        return 1 - err_rate
+
+    def partial_fit(self, X, y):
+        """continue training the model with a chunk of data, the data is
+        trained on the calling thread without the GIL, so that other Python
+        threads can prepare the next chunk meanwhile
+
+        Parameters
+        ----------
+        X: {array-like or sparse matrix}, shape = [n_samples, n_features]
+            Training vector, float32 or float64 values are read in place
+        y: array-like, shape=[n_samples]
+            Target label vector relative to X
+
+        Returns
+        -------
+        float: training accuracy on the chunk
+        """
+        assert self._c_model is not NULL, "model is not initialized"
+
+        cdef void* model = self._c_model
+        cdef float err_rate = 0
+        cdef const void* x_ptr
+        cdef const void* y_ptr
+        cdef const void* indptr_ptr
+        cdef const void* indices_ptr
+        cdef int x_type, y_type, indptr_type, indices_type
+        cdef long long n_samples, n_features, row_stride
+        cdef int canonical
+
+        y = _label_array(y)
+        y_ptr, y_type = _data_ptr(y), _data_types[y.dtype]
+        n_samples = X.shape[0]
+        if y.shape[0] != n_samples:
+            raise ValueError("numbers of samples and labels are different")
+
+        if isinstance(X, np.ndarray):
+            X = _dense_array(X)
+            x_ptr, x_type = _data_ptr(X), _data_types[X.dtype]
+            n_features, row_stride = X.shape[1], X.strides[0]
+            with nogil:
+                err_rate = sol_PartialFitDense(model, x_ptr, x_type,
+                        y_ptr, y_type, n_samples, n_features, row_stride)
+        elif isinstance(X, csr_matrix):
+            indptr, indices, values = _csr_arrays(X)
+            indptr_ptr, indptr_type = _data_ptr(indptr), _data_types[indptr.dtype]
+            indices_ptr, indices_type = _data_ptr(indices), _data_types[indices.dtype]
+            x_ptr, x_type = _data_ptr(values), _data_types[values.dtype]
+            canonical = X.has_canonical_format
+            with nogil:
+                err_rate = sol_PartialFitCsr(model, indptr_ptr, indptr_type,
+                        indices_ptr, indices_type, x_ptr, x_type,
+                        y_ptr, y_type, n_samples, canonical)
+        else:
+            raise TypeError("only numpy.ndarray or csr_matrix are allowed")
+
+        if err_rate < 0:
+            raise RuntimeError('partial fit failed')
+        return 1 - err_rate
 
     def score(self, param1, param2):
         """Returns the mean accuracy on the given test data and labels
 
         Parameters
         ----------
-        param1: str, data path or {array-like or sparse matrix}, shape = [n_samples, n_features]
+        param1: str, data path, list of data paths, or {array-like or sparse matrix}, shape = [n_samples, n_features]
             Test vector, where n_samples is the number of samples and n_features is the number of features
         param2: str, data type or array-like, shape=[n_samples]
             Target label vector relative to X
@@ -228,7 +393,12 @@ cdef class SOL:
 
         self.__load_data(param1, param2, 1)
 
-        return 1 - sol_Test(self._c_model, self._c_data_iter, NULL)
+        cdef void* model = self._c_model
+        cdef void* data_iter = self._c_data_iter
+        cdef float err_rate = 0
+        with nogil:
+            err_rate = sol_Test(model, data_iter, NULL)
+        return 1 - err_rate
 
     def decision_function(self, param1, param2 = None, get_labels = False):
         """Predict confidence scores for samples in X
@@ -237,7 +407,7 @@ cdef class SOL:
         ----------
         Parameters
         ----------
-        param1: str, data path or {array-like or sparse matrix}, shape = [n_samples, n_features]
+        param1: str, data path, list of data paths, or {array-like or sparse matrix}, shape = [n_samples, n_features]
             Test vector, where n_samples is the number of samples and n_features is the number of features
         param2: str, data type or None
         get_labels: bool
@@ -252,17 +422,21 @@ cdef class SOL:
         assert self._c_model is not NULL, "model is not initialized"
 
         self.__load_data(param1, param2, 1)
-        result = [[],[], []]
-
-        sol_Predict(self._c_model, self._c_data_iter,
-                desicion_function_callback, <void*>result)
+        # data files are predicted through the data iterator
+        if isinstance(param1, (str, list, tuple)):
+            result = [[],[], []]
+            self._predict_with_callback(desicion_function_callback, result)
+            scores = np.array(result[2], dtype=np.float32)
+            scores = scores.reshape(len(result[0]), sol_model_clf_num(self._c_model))
+            predicts, labels = np.array(result[1]), np.array(result[0])
+        else:
+            scores, predicts, labels = self.__predict_batch(param1.shape[0], True)
 
-        scores = np.array(result[2])
         if scores.shape[1] == 1:
             scores = scores.reshape(scores.shape[0])
 
         if get_labels:
-            return scores, np.array(result[1]), np.array(result[0])
+            return scores, predicts, labels
         else:
             return scores
 
@@ -273,7 +447,7 @@ cdef class SOL:
         ----------
         Parameters
         ----------
-        param1: str, data path or {array-like or sparse matrix}, shape = [n_samples, n_features]
+        param1: str, data path, list of data paths, or {array-like or sparse matrix}, shape = [n_samples, n_features]
             Test vector, where n_samples is the number of samples and n_features is the number of features
         param2: str, data type or None
         get_labels: bool
@@ -286,25 +460,35 @@ cdef class SOL:
         assert self._c_model is not NULL, "model is not initialized"
 
         self.__load_data(param1, param2, 1)
-        result = [[],[]]
-
-        sol_Predict(self._c_model, self._c_data_iter, predict_callback, <void*>result)
+        # data files are predicted through the data iterator
+        if isinstance(param1, (str, list, tuple)):
+            result = [[],[]]
+            self._predict_with_callback(predict_callback, result)
+            predicts, labels = np.array(result[1]), np.array(result[0])
+        else:
+            _, predicts, labels = self.__predict_batch(param1.shape[0], False)
 
         if get_labels:
-            return np.array(result[1]), np.array(result[0])
+            return predicts, labels
         else:
-            return np.array(result[1])
+            return predicts
 
-    def save(self, const char* model_path):
+    def save(self, const char* model_path, binary=False):
         """Save the model to a file
 
         Parameters
         ----------
         model_path: str
             path to save the model
+        binary: bool
+            whether to save in the binary format, which is loaded by mapping
+            the file into memory
         """
         assert self._c_model is not NULL, "model is not initialized"
-        sol_SaveModel(self._c_model, model_path)
+        if binary:
+            sol_SaveModelBinary(self._c_model, model_path)
+        else:
+            sol_SaveModel(self._c_model, model_path)
 
     def load(self, const char* model_path):
         """Load a model from file
@@ -6,13 +6,14 @@
 
 #include "sol/c_api.h"
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <fstream>
+#include <memory>
 
 #ifdef HAS_NUMPY_DEV
 #include <numpy/arrayobject.h>
-#include "sol/pario/numpy_reader.h"
-#include "sol/pario/csr_matrix_reader.h"
 #endif
 
 #include <json/json.h>
@@ -20,6 +21,8 @@
 #include "sol/sol.h"
 #include "sol/tools.h"
 #include "sol/model/online_model.h"
+#include "sol/pario/memory_reader.h"
+#include "sol/util/profiler.h"
 
 using namespace std;
 using namespace sol;
@@ -41,6 +44,11 @@ int sol_LoadData(void* data_iter, const char* path, const char* format,
   return iter->AddReader(path, format, pass_num);
 }
 
+void sol_SetMaxRunningReaderNum(void* data_iter, int reader_num) {
+  DataIter* iter = (DataIter*)(data_iter);
+  iter->set_max_running_reader_num(reader_num);
+}
+
 void* sol_CreateModel(const char* name, int class_num) {
   return (void*)(Model::Create(name, class_num));
 }
@@ -54,6 +62,11 @@ int sol_SaveModel(void* model, const char* model_path) {
   return m->Save(model_path);
 }
 
+int sol_SaveModelBinary(void* model, const char* model_path) {
+  Model* m = (Model*)(model);
+  return m->Save(model_path, true);
+}
+
 void sol_ReleaseModel(void** model) {
   Model** m = (Model**)(model);
   DeletePointer(*m);
@@ -116,25 +129,56 @@ int sol_Predict(void* model, void* data_iter, sol_predict_callback callback,
   Model* m = (Model*)(model);
   DataIter* iter = (DataIter*)(data_iter);
 
-  if (m->model_updated()) m->EndTrain();
-
-  float* score_buf = new float[m->clf_num()];
-  MiniBatch* mb = nullptr;
-  int data_num = 0;
-  while (1) {
-    mb = iter->Next(mb);
-    if (mb == nullptr) break;
-    for (int i = 0; i < mb->size(); ++i) {
-      DataPoint& x = (*mb)[i];
-      m->PreProcess(x);
-      // predict
-      label_t label = m->Predict(x, score_buf);
-      callback(user_context, x.label(), label, m->clf_num(), score_buf);
+  int clf_num = m->clf_num();
+  size_t data_num = m->PredictBatches(
+      *iter, false, [=](const Model::PredictResult& result) {
+        const MiniBatch& mb = *result.mini_batch;
+        for (int i = 0; i < mb.size(); ++i) {
+          callback(user_context, mb[i].label(), result.labels[i], clf_num,
+                   (float*)(result.scores.data() + i * clf_num));
+        }
+      });
+  return int(data_num);
+}
+
+int sol_PredictBatch(void* model, void* data_iter, int n_samples,
+                     double* labels, double* predicts, float* scores) {
+  Model* m = (Model*)(model);
+  DataIter* iter = (DataIter*)(data_iter);
+
+  size_t clf_num = size_t(m->clf_num());
+  size_t offset = 0;
+  bool overflow = false;
+  m->PredictBatches(*iter, false, [&](const Model::PredictResult& result) {
+    const MiniBatch& mb = *result.mini_batch;
+    size_t num = size_t(mb.size());
+    if (offset + num > size_t(n_samples)) {
+      overflow = true;
+      num = offset < size_t(n_samples) ? size_t(n_samples) - offset : 0;
     }
-    data_num += mb->size();
+    for (size_t i = 0; i < num; ++i) {
+      if (labels != nullptr) labels[offset + i] = double(mb[int(i)].label());
+      if (predicts != nullptr) {
+        predicts[offset + i] = double(result.labels[i]);
+      }
+    }
+    if (scores != nullptr && num > 0) {
+      memcpy(scores + offset * clf_num, result.scores.data(),
+             num * clf_num * sizeof(float));
+    }
+    offset += num;
+  });
+  if (overflow) {
+    fprintf(stderr, "number of samples exceeds the size of the arrays (%d)\n",
+            n_samples);
+    return -1;
   }
-  delete[] score_buf;
-  return data_num;
+  return int(offset);
+}
+
+int sol_model_clf_num(void* model) {
+  Model* m = (Model*)(model);
+  return m->clf_num();
 }
 
 float sol_model_sparsity(void* model) {
@@ -150,21 +194,106 @@ SOL_EXPORTS void sol_InspectOnlineIteration(
   m->set_iterate_callback(callback, user_context);
 }
 
+static_assert(int(sol_float32) == kMemFloat32 &&
+                  int(sol_float64) == kMemFloat64 &&
+                  int(sol_int32) == kMemInt32 && int(sol_int64) == kMemInt64,
+              "data types of the C API and MemoryReader are different");
+
+int sol_LoadDenseData(void* data_iter, const void* X, int x_type,
+                      const void* Y, int y_type, long long n_samples,
+                      long long n_features, long long row_stride,
+                      int pass_num) {
+  DataIter* iter = (DataIter*)(data_iter);
+  if (n_samples < 0 || n_features < 0 || row_stride < 0) {
+    fprintf(stderr, "invalid shape of the dense matrix\n");
+    return Status_Invalid_Argument;
+  }
+  return iter->AddReader(
+      MemoryReader::CreateDense(X, x_type, Y, y_type, size_t(n_samples),
+                                size_t(n_features), size_t(row_stride)),
+      pass_num);
+}
+
+int sol_LoadCsrData(void* data_iter, const void* indptr, int indptr_type,
+                    const void* indices, int index_type, const void* values,
+                    int value_type, const void* Y, int y_type,
+                    long long n_samples, int canonical, int pass_num) {
+  DataIter* iter = (DataIter*)(data_iter);
+  if (n_samples < 0) {
+    fprintf(stderr, "invalid shape of the csr matrix\n");
+    return Status_Invalid_Argument;
+  }
+  return iter->AddReader(
+      MemoryReader::CreateCsr(indptr, indptr_type, indices, index_type, values,
+                              value_type, Y, y_type, size_t(n_samples),
+                              canonical != 0),
+      pass_num);
+}
+
+/// \brief  train an online model with the data of a reader
+static float PartialFit(void* model, MemoryReader* reader) {
+  unique_ptr<MemoryReader> guard(reader);
+  OnlineModel* m = dynamic_cast<OnlineModel*>((Model*)(model));
+  if (m == nullptr) {
+    fprintf(stderr, "partial fit is only supported by online models\n");
+    return -1.f;
+  }
+  if (reader == nullptr) return -1.f;
+  return m->PartialFit(*reader);
+}
+
+float sol_PartialFitDense(void* model, const void* X, int x_type,
+                          const void* Y, int y_type, long long n_samples,
+                          long long n_features, long long row_stride) {
+  if (n_samples < 0 || n_features < 0 || row_stride < 0) {
+    fprintf(stderr, "invalid shape of the dense matrix\n");
+    return -1.f;
+  }
+  return PartialFit(model, MemoryReader::CreateDense(
+                               X, x_type, Y, y_type, size_t(n_samples),
+                               size_t(n_features), size_t(row_stride)));
+}
+
+float sol_PartialFitCsr(void* model, const void* indptr, int indptr_type,
+                        const void* indices, int index_type,
+                        const void* values, int value_type, const void* Y,
+                        int y_type, long long n_samples, int canonical) {
+  if (n_samples < 0) {
+    fprintf(stderr, "invalid shape of the csr matrix\n");
+    return -1.f;
+  }
+  return PartialFit(model, MemoryReader::CreateCsr(
+                               indptr, indptr_type, indices, index_type,
+                               values, value_type, Y, y_type,
+                               size_t(n_samples), canonical != 0));
+}
+
+void sol_EnableProfiling(int enable) { Profiler::Enable(enable != 0); }
+
+void sol_ResetProfiling() { Profiler::Reset(); }
+
+int sol_GetProfilingReport(char* buf, int buf_size) {
+  const string& report = Profiler::Report();
+  if (buf != nullptr && buf_size > 0) {
+    size_t len = (std::min)(report.size(), size_t(buf_size - 1));
+    memcpy(buf, report.c_str(), len);
+    buf[len] = '\0';
+  }
+  return int(report.size());
+}
+
 #ifdef HAS_NUMPY_DEV
 int sol_loadArray(void* data_iter, char* X, char* Y, npy_intp* dims,
                   npy_intp* strides, int pass_num) {
-  string path = NumpyReader::GeneratePath((double*)X, (double*)Y, int(dims[0]),
-                                          int(dims[1]), int(strides[0]));
-  DataIter* iter = (DataIter*)(data_iter);
-  return iter->AddReader(path, "numpy", pass_num);
+  return sol_LoadDenseData(data_iter, X, sol_float64, Y, sol_float64, dims[0],
+                           dims[1], strides[0], pass_num);
 }
 
 int sol_loadCsrMatrix(void* data_iter, char* indices, char* indptr,
                       char* features, char* y, int n_samples, int pass_num) {
-  string path = CsrMatrixReader::GeneratePath(
-      (int*)indices, (int*)indptr, (double*)features, (double*)y, n_samples);
-  DataIter* iter = (DataIter*)(data_iter);
-  return iter->AddReader(path, "csr_matrix", pass_num);
+  return sol_LoadCsrData(data_iter, indptr, sol_int32, indices, sol_int32,
+                         features, sol_float64, y, sol_float64, n_samples, 0,
+                         pass_num);
 }
 #endif
 
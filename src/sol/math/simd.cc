@@ -0,0 +1,253 @@
+/*********************************************************************************
+*     File Name           :     simd.cc
+*     Created By          :     yuewu
+*     Description         :     SIMD kernels of sparse-dense operations
+**********************************************************************************/
+
+#include "sol/math/simd.h"
+
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define SOL_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define SOL_X86_SIMD 0
+#endif
+
+namespace sol {
+namespace math {
+
+// gather instructions take 32-bit signed offsets, indexes not less than 2^31
+// are handled by the scalar loops
+static const bool kGatherIndex = std::is_same<index_t, uint32_t>::value ||
+                                 std::is_same<index_t, int32_t>::value;
+
+//---------------
+// scalar kernels
+// --------------
+
+static float sparse_dot_scalar(const float* dense, const index_t* indexes,
+                               const float* values, size_t n) {
+  float val = 0;
+  for (size_t i = 0; i < n; ++i) {
+    val += dense[indexes[i]] * values[i];
+  }
+  return val;
+}
+
+static void sparse_axpy_scalar(float alpha, const index_t* indexes,
+                               const float* values, size_t n, float* dense) {
+  for (size_t i = 0; i < n; ++i) {
+    dense[indexes[i]] += alpha * values[i];
+  }
+}
+
+#if SOL_X86_SIMD
+
+//---------------
+// AVX2 kernels
+// --------------
+
+__attribute__((target("avx2"))) static inline float reduce_add_avx2(
+    __m256 acc) {
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc),
+                          _mm256_extractf128_ps(acc, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2,fma"))) static float sparse_dot_avx2(
+    const float* dense, const index_t* indexes, const float* values,
+    size_t n) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  float val = 0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i idx0 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indexes + i));
+    __m256i idx1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indexes + i + 8));
+    // sign bits are set by the indexes not less than 2^31
+    if (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(idx0, idx1))) !=
+        0) {
+      val += sparse_dot_scalar(dense, indexes + i, values + i, 16);
+      continue;
+    }
+    __m256 w0 = _mm256_i32gather_ps(dense, idx0, 4);
+    __m256 w1 = _mm256_i32gather_ps(dense, idx1, 4);
+    acc0 = _mm256_fmadd_ps(w0, _mm256_loadu_ps(values + i), acc0);
+    acc1 = _mm256_fmadd_ps(w1, _mm256_loadu_ps(values + i + 8), acc1);
+  }
+  val += reduce_add_avx2(_mm256_add_ps(acc0, acc1));
+  return val + sparse_dot_scalar(dense, indexes + i, values + i, n - i);
+}
+
+//---------------
+// AVX-512 kernels
+// --------------
+
+// the masked gathers and the reduction are written out, since the unmasked
+// intrinsics read undefined vectors and are warned by gcc
+__attribute__((target("avx512f"))) static inline float reduce_add_avx512(
+    __m512 acc) {
+  __m512d acc_pd = _mm512_castps_pd(acc);
+  __m256 low = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, acc_pd, 0));
+  __m256 high = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, acc_pd, 1));
+  return reduce_add_avx2(_mm256_add_ps(low, high));
+}
+
+__attribute__((target("avx512f"))) static float sparse_dot_avx512(
+    const float* dense, const index_t* indexes, const float* values,
+    size_t n) {
+  const __m512i zero = _mm512_setzero_si512();
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  float val = 0;
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m512i idx0 = _mm512_loadu_si512(indexes + i);
+    __m512i idx1 = _mm512_loadu_si512(indexes + i + 16);
+    // negative offsets are the indexes not less than 2^31
+    if (_mm512_cmplt_epi32_mask(_mm512_or_si512(idx0, idx1), zero) != 0) {
+      val += sparse_dot_scalar(dense, indexes + i, values + i, 32);
+      continue;
+    }
+    __m512 w0 =
+        _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, idx0, dense, 4);
+    __m512 w1 =
+        _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, idx1, dense, 4);
+    acc0 = _mm512_fmadd_ps(w0, _mm512_loadu_ps(values + i), acc0);
+    acc1 = _mm512_fmadd_ps(w1, _mm512_loadu_ps(values + i + 16), acc1);
+  }
+  for (; i < n; i += 16) {
+    size_t num = n - i >= 16 ? 16 : n - i;
+    __mmask16 mask = __mmask16((1u << num) - 1);
+    __m512i idx0 = _mm512_maskz_loadu_epi32(mask, indexes + i);
+    if (_mm512_cmplt_epi32_mask(idx0, zero) != 0) {
+      val += sparse_dot_scalar(dense, indexes + i, values + i, num);
+      continue;
+    }
+    __m512 w0 = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, idx0,
+                                         dense, 4);
+    acc0 = _mm512_fmadd_ps(w0, _mm512_maskz_loadu_ps(mask, values + i), acc0);
+  }
+  return val + reduce_add_avx512(_mm512_add_ps(acc0, acc1));
+}
+
+// lanes with the same index are detected with AVX512CD and updated serially,
+// the multiplications and additions are not fused so that the results are the
+// same as the scalar kernel
+__attribute__((target("avx512f,avx512cd"), optimize("fp-contract=off")))
+static void sparse_axpy_avx512(
+    float alpha, const index_t* indexes, const float* values, size_t n,
+    float* dense) {
+  const __m512i zero = _mm512_setzero_si512();
+  __m512 scale = _mm512_set1_ps(alpha);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i idx = _mm512_loadu_si512(indexes + i);
+    __m512i conflict = _mm512_conflict_epi32(idx);
+    if (_mm512_test_epi32_mask(conflict, conflict) != 0 ||
+        _mm512_cmplt_epi32_mask(idx, zero) != 0) {
+      sparse_axpy_scalar(alpha, indexes + i, values + i, 16, dense);
+      continue;
+    }
+    __m512 w =
+        _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, idx, dense, 4);
+    w = _mm512_add_ps(w, _mm512_mul_ps(scale, _mm512_loadu_ps(values + i)));
+    _mm512_i32scatter_ps(dense, idx, w, 4);
+  }
+  for (; i < n; ++i) {
+    dense[indexes[i]] += alpha * values[i];
+  }
+}
+
+#endif  // SOL_X86_SIMD
+
+//---------------
+// dispatch
+// --------------
+
+typedef float (*SparseDotFunc)(const float*, const index_t*, const float*,
+                               size_t);
+typedef void (*SparseAxpyFunc)(float, const index_t*, const float*, size_t,
+                               float*);
+
+struct SIMDKernels {
+  SIMDLevel level;
+  SparseDotFunc dot;
+  SparseAxpyFunc axpy;
+};
+
+/// \brief  best instruction set supported by the cpu
+static SIMDLevel cpu_simd_level() {
+#if SOL_X86_SIMD
+  if (kGatherIndex == false) return SIMDLevel::Scalar;
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd")) {
+    return SIMDLevel::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return SIMDLevel::AVX2;
+  }
+#endif
+  return SIMDLevel::Scalar;
+}
+
+static void select_kernels(SIMDKernels& kernels, SIMDLevel level) {
+  SIMDLevel cpu_level = cpu_simd_level();
+  if (int(level) > int(cpu_level)) level = cpu_level;
+  kernels.level = level;
+  switch (level) {
+#if SOL_X86_SIMD
+    case SIMDLevel::AVX512:
+      kernels.dot = sparse_dot_avx512;
+      kernels.axpy = sparse_axpy_avx512;
+      break;
+    case SIMDLevel::AVX2:
+      // without scatter and conflict detection, the updates of AVX2 are not
+      // faster than the scalar loop
+      kernels.dot = sparse_dot_avx2;
+      kernels.axpy = sparse_axpy_scalar;
+      break;
+#endif
+    default:
+      kernels.level = SIMDLevel::Scalar;
+      kernels.dot = sparse_dot_scalar;
+      kernels.axpy = sparse_axpy_scalar;
+      break;
+  }
+}
+
+static SIMDKernels& simd_kernels() {
+  static SIMDKernels kernels = []() {
+    SIMDKernels k;
+    select_kernels(k, SIMDLevel::AVX512);
+    return k;
+  }();
+  return kernels;
+}
+
+SIMDLevel simd_level() { return simd_kernels().level; }
+
+SIMDLevel set_simd_level(SIMDLevel level) {
+  select_kernels(simd_kernels(), level);
+  return simd_kernels().level;
+}
+
+float sparse_dot(const float* dense, const index_t* indexes,
+                 const float* values, size_t n) {
+  return simd_kernels().dot(dense, indexes, values, n);
+}
+
+void sparse_axpy(float alpha, const index_t* indexes, const float* values,
+                 size_t n, float* dense) {
+  simd_kernels().axpy(alpha, indexes, values, n, dense);
+}
+
+}  // namespace math
+}  // namespace sol
@@ -12,9 +12,13 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <cstring>
 
 #include "sol/util/util.h"
 #include "sol/util/error_code.h"
+#include "sol/util/monitor.h"
+#include "sol/util/profiler.h"
+#include "sol/util/thread_task.h"
 
 using namespace std;
 using namespace sol::math::expr;
@@ -23,6 +27,17 @@ using namespace sol::pario;
 namespace sol {
 namespace model {
 
+// binary model file: magic, version, length of the json model info, the model
+// info, and then the parameter arrays, each aligned to kBinaryModelAlign
+static const char kBinaryModelMagic[8] = {'S', 'O', 'L', 'M', 'O', 'D', 'E', 'L'};
+static const uint32_t kBinaryModelVersion = 1;
+static const size_t kBinaryModelHeaderSize = 16;
+static const size_t kBinaryModelAlign = 64;
+
+inline size_t align_size(size_t size) {
+  return (size + kBinaryModelAlign - 1) / kBinaryModelAlign * kBinaryModelAlign;
+}
+
 Model* Model::Create(const std::string& name, int class_num) {
   auto create_func = CreateObject<Model>(std::string(name) + "_model");
   Model* ins = nullptr;
@@ -46,6 +61,7 @@ Model::Model(int class_num, const std::string& type)
       max_index_(0) {
   Check(class_num > 1);
   this->update_num_ = 0;
+  this->thread_num_ = 1;
   this->require_reinit_ = true;
   this->model_updated_ = false;
 }
@@ -98,6 +114,9 @@ void Model::SetParameter(const std::string& name, const std::string& value) {
       oss << "unknown norm type " << value;
       throw invalid_argument(oss.str());
     }
+  } else if (name == "threads") {
+    this->thread_num_ = stoi(value);
+    Check(thread_num_ > 0);
   } else if (name == "filter") {
     if (this->LoadPreSelFeatures(value) != Status_OK) {
       ostringstream oss;
@@ -115,39 +134,149 @@ void Model::SetParameter(const std::string& name, const std::string& value) {
 }
 
 float Model::Test(DataIter& data_iter, std::ostream* os) {
-  if (this->model_updated_) this->EndTrain();
-
   size_t err_num = 0;
-  size_t data_num = 0;
 
   if (os != nullptr) {
     (*os) << "label\tpredict\tscores\n";
   }
 
-  float* predicts = new float[this->clf_num()];
-  MiniBatch* mb = nullptr;
-  while (1) {
-    mb = data_iter.Next(mb);
-    if (mb == nullptr) break;
-    // data_num += mb->size();
-    for (int i = 0; i < mb->size(); ++i) {
-      DataPoint& x = (*mb)[i];
-      this->PreProcess(x);
-      // predict
-      label_t label = this->Predict(x, predicts);
-      if (label != x.label()) err_num++;
-      if (os != nullptr) {
-        (*os) << x.label() << "\t" << label;
-        for (int k = 0; k < this->clf_num_; ++k) {
-          (*os) << "\t" << predicts[k];
+  size_t data_num = this->PredictBatches(
+      data_iter, os != nullptr, [&err_num, os](const PredictResult& result) {
+        const MiniBatch& mb = *result.mini_batch;
+        for (int i = 0; i < mb.size(); ++i) {
+          if (result.labels[i] != mb[i].label()) err_num++;
         }
-        (*os) << "\n";
+        if (os != nullptr) os->write(result.text.data(), result.text.size());
+      });
+  return float(double(err_num) / data_num);
+}
+
+size_t Model::PredictBatches(
+    DataIter& data_iter, bool format,
+    const std::function<void(const PredictResult&)>& handler) {
+  if (this->model_updated_) this->EndTrain();
+  this->BeginPredict();
+
+  size_t data_num = 0;
+  if (this->thread_num_ <= 1) {
+    PredictResult result;
+    MiniBatch* mb = nullptr;
+    while ((mb = data_iter.Next(mb)) != nullptr) {
+      result.mini_batch = mb;
+      this->PredictMiniBatch(result, format);
+      handler(result);
+      data_num += mb->size();
+    }
+    return data_num;
+  }
+
+  // workers fetch and predict the mini-batches, the results are handled here
+  // by the sequence numbers of the mini-batches
+  Mutex fetch_mutex;
+  Monitor monitor;
+  size_t next_seq = 0;
+  map<size_t, PredictResult*> ready_results;
+  vector<PredictResult*> free_results;
+  int running_num = this->thread_num_;
+
+  auto predict_func = [&]() {
+    while (1) {
+      fetch_mutex.lock();
+      MiniBatch* mb = data_iter.Next();
+      size_t seq = next_seq++;
+      fetch_mutex.unlock();
+      if (mb == nullptr) break;
+
+      monitor.lock();
+      PredictResult* result = nullptr;
+      if (free_results.empty()) {
+        result = new PredictResult;
+      } else {
+        result = free_results.back();
+        free_results.pop_back();
       }
-      ++data_num;
+      monitor.unlock();
+
+      result->mini_batch = mb;
+      this->PredictMiniBatch(*result, format);
+
+      monitor.lock();
+      ready_results[seq] = result;
+      monitor.notify_all();
+      monitor.unlock();
+    }
+    monitor.lock();
+    --running_num;
+    monitor.notify_all();
+    monitor.unlock();
+  };
+
+  vector<shared_ptr<FunctionTask>> tasks;
+  for (int i = 0; i < this->thread_num_; ++i) {
+    tasks.push_back(make_shared<FunctionTask>(predict_func));
+    tasks.back()->Start();
+  }
+
+  size_t cur_seq = 0;
+  monitor.lock();
+  while (1) {
+    auto iter = ready_results.find(cur_seq);
+    if (iter == ready_results.end()) {
+      if (running_num == 0) break;
+      monitor.wait();
+      continue;
+    }
+    PredictResult* result = iter->second;
+    ready_results.erase(iter);
+    monitor.unlock();
+
+    handler(*result);
+    data_num += result->mini_batch->size();
+    data_iter.Recycle(result->mini_batch);
+    ++cur_seq;
+
+    monitor.lock();
+    free_results.push_back(result);
+  }
+  monitor.unlock();
+
+  for (shared_ptr<FunctionTask>& task : tasks) {
+    task->Join();
+  }
+  for (PredictResult*& result : free_results) DeletePointer(result);
+  return data_num;
+}
+
+/// \brief  append the results of a data point in the format of Test
+inline void FormatResult(label_t label, label_t predict, const float* scores,
+                         int clf_num, string& text) {
+  char buf[64];
+  int len = snprintf(buf, sizeof(buf), "%lld\t%lld", (long long)label,
+                     (long long)predict);
+  text.append(buf, len);
+  for (int k = 0; k < clf_num; ++k) {
+    len = snprintf(buf, sizeof(buf), "\t%g", double(scores[k]));
+    text.append(buf, len);
+  }
+  text.push_back('\n');
+}
+
+void Model::PredictMiniBatch(PredictResult& result, bool format) {
+  MiniBatch& mb = *result.mini_batch;
+  size_t clf_num = size_t(this->clf_num_);
+  result.labels.resize(mb.size());
+  result.scores.resize(mb.size() * clf_num);
+  result.text.clear();
+  for (int i = 0; i < mb.size(); ++i) {
+    DataPoint& x = mb[i];
+    this->PreProcess(x);
+    float* scores = result.scores.data() + i * clf_num;
+    result.labels[i] = this->Predict(x, scores);
+    if (format) {
+      FormatResult(x.label(), result.labels[i], scores, this->clf_num_,
+                   result.text);
     }
   }
-  delete[] predicts;
-  return float(double(err_num) / data_num);
 }
 
 void Model::BeginTrain() {
@@ -157,7 +286,25 @@ void Model::BeginTrain() {
   this->require_reinit_ = false;
 }
 
-int Model::Save(const string& path) const {
+int Model::Save(const string& path, bool binary) const {
+  // write to a temporary file and then replace the model file, so that models
+  // mapped from the old file are not affected
+  string tmp_path = path + ".tmp";
+  int ret = binary ? this->SaveBinary(tmp_path) : this->SaveText(tmp_path);
+  if (ret == Status_OK) {
+#if _WIN32
+    remove(path.c_str());
+#endif
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+      cerr << "replace model file " << path << " failed\n";
+      ret = Status_IO_Error;
+    }
+  }
+  if (ret != Status_OK) remove(tmp_path.c_str());
+  return ret;
+}
+
+int Model::SaveText(const string& path) const {
   ofstream out_file(path.c_str(), ios::out);
   if (!out_file) {
     cerr << "open file " << path << " failed\n";
@@ -184,6 +331,14 @@ Model* Model::Load(const string& path) {
     cerr << "open file " << path << " failed\n";
     return nullptr;
   }
+  char magic[sizeof(kBinaryModelMagic)] = {0};
+  in_file.read(magic, sizeof(magic));
+  if (memcmp(magic, kBinaryModelMagic, sizeof(magic)) == 0) {
+    in_file.close();
+    return Model::LoadBinary(path);
+  }
+  in_file.clear();
+  in_file.seekg(0);
   string line;
   getline(in_file, line);
   if (line != "model info:") {
@@ -233,6 +388,125 @@ Model* Model::Load(const string& path) {
   return model;
 }
 
+int Model::SaveBinary(const string& path) const {
+  ofstream out_file(path.c_str(), ios::out | ios::binary);
+  if (!out_file) {
+    cerr << "open file " << path << " failed\n";
+    return Status_IO_Error;
+  }
+  Json::Value root;
+  this->GetModelInfo(root);
+  vector<ModelArray> arrays;
+  this->GetModelArrays(arrays);
+
+  // offsets of the arrays are relative to the end of model info
+  size_t offset = 0;
+  root["real_size"] = Json::UInt64(sizeof(real_t));
+  Json::Value& array_info = root["arrays"];
+  array_info = Json::Value(Json::arrayValue);
+  for (const ModelArray& arr : arrays) {
+    Json::Value info;
+    info["name"] = arr.name;
+    info["offset"] = Json::UInt64(offset);
+    info["size"] = Json::UInt64(arr.data.size());
+    array_info.append(info);
+    offset += align_size(arr.data.size() * sizeof(real_t));
+  }
+  Json::FastWriter writer;
+  string model_info = writer.write(root);
+
+  uint32_t info_len = uint32_t(model_info.size());
+  out_file.write(kBinaryModelMagic, sizeof(kBinaryModelMagic));
+  out_file.write((const char*)&kBinaryModelVersion, sizeof(uint32_t));
+  out_file.write((const char*)&info_len, sizeof(uint32_t));
+  out_file.write(model_info.c_str(), info_len);
+
+  const char padding[kBinaryModelAlign] = {0};
+  size_t pos = kBinaryModelHeaderSize + info_len;
+  out_file.write(padding, align_size(pos) - pos);
+  for (const ModelArray& arr : arrays) {
+    size_t bytes = arr.data.size() * sizeof(real_t);
+    out_file.write((const char*)arr.data.begin(), bytes);
+    out_file.write(padding, align_size(bytes) - bytes);
+  }
+  if (!out_file) {
+    cerr << "write model to " << path << " failed\n";
+    return Status_IO_Error;
+  }
+  out_file.close();
+  return Status_OK;
+}
+
+Model* Model::LoadBinary(const string& path) {
+  shared_ptr<MMapFile> file = make_shared<MMapFile>();
+  if (file->Open(path.c_str(), true) != Status_OK) return nullptr;
+
+  uint32_t version = 0;
+  uint32_t info_len = 0;
+  if (file->size() >= kBinaryModelHeaderSize) {
+    memcpy(&version, file->begin() + 8, sizeof(uint32_t));
+    memcpy(&info_len, file->begin() + 12, sizeof(uint32_t));
+  }
+  if (version != kBinaryModelVersion ||
+      file->size() < kBinaryModelHeaderSize + info_len) {
+    cerr << "invalid binary model file " << path << "\n";
+    return nullptr;
+  }
+  const char* info_begin = file->begin() + kBinaryModelHeaderSize;
+  Json::Value root;
+  Json::Reader reader;
+  if (reader.parse(info_begin, info_begin + info_len, root) == false ||
+      root["real_size"].asUInt64() != sizeof(real_t)) {
+    cerr << "parse model file " << path << " failed\n";
+    return nullptr;
+  }
+
+  string cls_name = root.get("model", "").asString();
+  int cls_num = root.get("cls_num", "0").asInt();
+  Model* model = Model::Create(cls_name, cls_num);
+  if (model == nullptr) {
+    cerr << "create model failed: no model named " << cls_name << "\n";
+    return nullptr;
+  }
+  int ret = Status_OK;
+  try {
+    ret = model->SetModelInfo(root);
+  }
+  catch (invalid_argument& err) {
+    cerr << "set model parameter failed: " << err.what() << "\n";
+    ret = Status_Invalid_Argument;
+  }
+
+  // attach the arrays of the model to the mapped file
+  vector<ModelArray> arrays;
+  if (ret == Status_OK) model->GetModelArrays(arrays);
+  const Json::Value& array_info = root["arrays"];
+  if (ret == Status_OK && array_info.size() != arrays.size()) {
+    ret = Status_Invalid_Format;
+  }
+  size_t data_begin = align_size(kBinaryModelHeaderSize + info_len);
+  for (size_t i = 0; i < arrays.size() && ret == Status_OK; ++i) {
+    const Json::Value& info = array_info[Json::ArrayIndex(i)];
+    size_t offset = size_t(info["offset"].asUInt64());
+    size_t size = size_t(info["size"].asUInt64());
+    if (info["name"].asString() != arrays[i].name ||
+        size != arrays[i].data.size() ||
+        data_begin + offset + size * sizeof(real_t) > file->size()) {
+      ret = Status_Invalid_Format;
+      break;
+    }
+    arrays[i].data.attach((real_t*)(file->data() + data_begin + offset), size);
+    arrays[i].data.resize(size);
+  }
+  if (ret != Status_OK) {
+    cerr << "load model parameters from " << path << " failed\n";
+    DeletePointer(model);
+    return nullptr;
+  }
+  model->model_file_ = file;
+  return model;
+}
+
 void Model::GetModelInfo(Json::Value& root) const {
   root["model"] = this->name();
   root["cls_num"] = this->class_num();
@@ -291,6 +565,7 @@ string Model::model_info() const {
 void Model::model_info(Json::Value& info) const { this->GetModelInfo(info); }
 
 void Model::PreProcess(DataPoint& x) {
+  ProfileScope scope(kStagePreProcess);
   // calibrate label
   x.set_label(this->CalibrateLabel(x.label()));
   // filter features
@@ -81,6 +81,13 @@ void AdaFOBOS::GetModelParam(std::ostream& os) const {
   }
 }
 
+void AdaFOBOS::GetModelArrays(std::vector<ModelArray>& arrays) const {
+  OnlineLinearModel::GetModelArrays(arrays);
+  for (int c = 0; c < this->clf_num_; ++c) {
+    arrays.emplace_back("H[" + to_string(c) + "]", this->H_[c]);
+  }
+}
+
 int AdaFOBOS::SetModelParam(std::istream& is) {
   OnlineLinearModel::SetModelParam(is);
 
@@ -91,6 +98,16 @@ int AdaFOBOS::SetModelParam(std::istream& is) {
   return Status_OK;
 }
 
+int AdaFOBOS::ShareStates(const OnlineLinearModel& model) {
+  if (this->regularizer_ != nullptr) return Status_Invalid_Argument;
+  this->ShareWeights(model);
+  const AdaFOBOS& src = static_cast<const AdaFOBOS&>(model);
+  for (int c = 0; c < this->clf_num_; ++c) {
+    this->H_[c] = src.H_[c];
+  }
+  return Status_OK;
+}
+
 RegisterModel(AdaFOBOS, "ada-fobos", "Adaptive Subgradient FOBOS");
 
 AdaFOBOS_L1::AdaFOBOS_L1(int class_num) : AdaFOBOS(class_num) {
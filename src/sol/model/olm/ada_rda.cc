@@ -107,6 +107,16 @@ void AdaRDA::GetModelParam(std::ostream& os) const {
   }
 }
 
+void AdaRDA::GetModelArrays(std::vector<ModelArray>& arrays) const {
+  OnlineLinearModel::GetModelArrays(arrays);
+  for (int c = 0; c < this->clf_num_; ++c) {
+    arrays.emplace_back("H[" + to_string(c) + "]", this->H_[c]);
+  }
+  for (int c = 0; c < this->clf_num_; ++c) {
+    arrays.emplace_back("ut[" + to_string(c) + "]", this->ut_[c]);
+  }
+}
+
 int AdaRDA::SetModelParam(std::istream& is) {
   OnlineLinearModel::SetModelParam(is);
 
@@ -121,6 +131,17 @@ int AdaRDA::SetModelParam(std::istream& is) {
   return Status_OK;
 }
 
+int AdaRDA::ShareStates(const OnlineLinearModel& model) {
+  if (this->regularizer_ != nullptr) return Status_Invalid_Argument;
+  this->ShareWeights(model);
+  const AdaRDA& src = static_cast<const AdaRDA&>(model);
+  for (int c = 0; c < this->clf_num_; ++c) {
+    this->H_[c] = src.H_[c];
+    this->ut_[c] = src.ut_[c];
+  }
+  return Status_OK;
+}
+
 RegisterModel(AdaRDA, "ada-rda", "Adaptive Subgradient RDA");
 
 AdaRDA_L1::AdaRDA_L1(int class_num) : AdaRDA(class_num) {
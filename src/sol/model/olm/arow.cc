@@ -99,6 +99,13 @@ void AROW::GetModelParam(std::ostream& os) const {
   }
 }
 
+void AROW::GetModelArrays(std::vector<ModelArray>& arrays) const {
+  OnlineLinearModel::GetModelArrays(arrays);
+  for (int c = 0; c < this->clf_num_; ++c) {
+    arrays.emplace_back("Sigma[" + to_string(c) + "]", this->Sigmas_[c]);
+  }
+}
+
 int AROW::SetModelParam(std::istream& is) {
   OnlineLinearModel::SetModelParam(is);
 
@@ -130,6 +130,13 @@ void CW::GetModelParam(std::ostream& os) const {
   }
 }
 
+void CW::GetModelArrays(std::vector<ModelArray>& arrays) const {
+  OnlineLinearModel::GetModelArrays(arrays);
+  for (int c = 0; c < this->clf_num_; ++c) {
+    arrays.emplace_back("Sigma[" + to_string(c) + "]", this->Sigmas_[c]);
+  }
+}
+
 int CW::SetModelParam(std::istream& is) {
   OnlineLinearModel::SetModelParam(is);
 
@@ -140,6 +140,13 @@ void ECCW::GetModelParam(std::ostream& os) const {
   }
 }
 
+void ECCW::GetModelArrays(std::vector<ModelArray>& arrays) const {
+  OnlineLinearModel::GetModelArrays(arrays);
+  for (int c = 0; c < this->clf_num_; ++c) {
+    arrays.emplace_back("Sigma[" + to_string(c) + "]", this->Sigmas_[c]);
+  }
+}
+
 int ECCW::SetModelParam(std::istream& is) {
   OnlineLinearModel::SetModelParam(is);
 
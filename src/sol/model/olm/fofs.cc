@@ -6,13 +6,27 @@
 
 #include "sol/model/olm/fofs.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "sol/loss/loss.h"
+
 using namespace std;
 using namespace sol::math;
 
 namespace sol {
 namespace model {
 
-FOFS::FOFS(int class_num) : OnlineLinearModel(class_num), lambda_(0.f), B_(0) {}
+// minimum scale factor before it is applied to the weights
+static const real_t kMinScale = 1e-3f;
+
+FOFS::FOFS(int class_num)
+    : OnlineLinearModel(class_num), lambda_(0.f), B_(0), heap_synced_(false) {
+  this->scales_.resize(this->clf_num_);
+  this->scales_ = 1;
+  this->sq_norms_.resize(this->clf_num_);
+  this->sq_norms_ = 0;
+}
 
 FOFS::~FOFS() {}
 
@@ -49,50 +63,138 @@ void FOFS::BeginTrain() {
       abs_w += L1(w(i));
     }
     this->min_heap_.Init(this->dim_ - 1, this->B_, abs_w.data() + 1);
+    this->heap_synced_ = false;
+  }
+  for (int c = 0; c < this->clf_num_; ++c) {
+    this->ApplyScale(c);
+  }
+}
+
+void FOFS::EndTrain() {
+  for (int c = 0; c < this->clf_num_; ++c) {
+    if (this->scales_[c] != 1) this->ApplyScale(c);
+  }
+  OnlineLinearModel::EndTrain();
+}
+
+float FOFS::Train(pario::DataIter& data_iter) {
+  float err_rate = OnlineLinearModel::Train(data_iter);
+  // keep the weights valid for saving
+  for (int c = 0; c < this->clf_num_; ++c) {
+    if (this->scales_[c] != 1) this->ApplyScale(c);
+  }
+  return err_rate;
+}
+
+label_t FOFS::TrainPredict(const pario::DataPoint& dp, float* predicts) {
+  const auto& x = dp.data();
+  for (int c = 0; c < this->clf_num_; ++c) {
+    predicts[c] = this->scales_[c] * (expr::dotmul(w(c), x) + w(c)[0]);
+  }
+  if (this->clf_num_ == 1) {
+    return loss::Loss::Sign(*predicts);
+  } else {
+    return label_t(max_element(predicts, predicts + this->clf_num_) - predicts);
   }
 }
 
 void FOFS::Update(const pario::DataPoint& dp, const float* predict,
                   float loss) {
-  // update with sgd
+  // update with sgd, the momentum and the projection to the L2 ball are
+  // applied to the scale factors, so the cost is linear to the features of dp
   const auto& x = dp.data();
+  size_t feat_num = x.size();
 
   for (int c = 0; c < this->clf_num_; ++c) {
     if (g(c) == 0) continue;
-    w(c) *= this->momentum_;
-    w(c) -= this->eta_ * g(c) * x;
+    real_t& scale = this->scales_[c];
+    double& sq_norm = this->sq_norms_[c];
+    auto& w_c = w(c);
+
+    scale *= this->momentum_;
+    if (scale < kMinScale) this->ApplyScale(c);
+
+    real_t step = this->eta_ * g(c) / scale;
+    for (size_t i = 0; i < feat_num; ++i) {
+      real_t& val = w_c[x.index(i)];
+      real_t new_val = val - step * x.value(i);
+      sq_norm += double(new_val) * new_val - double(val) * val;
+      val = new_val;
+    }
     // update bias
-    w(c)[0] -= bias_eta() * g(c);
+    real_t new_bias = w_c[0] - bias_eta() * g(c) / scale;
+    sq_norm += double(new_bias) * new_bias - double(w_c[0]) * w_c[0];
+    w_c[0] = new_bias;
 
-    real_t coeff = this->norm_coeff_ / sqrt(Norm2(w(c)));
+    if (sq_norm < 0) sq_norm = 0;
+    real_t norm = scale * real_t(sqrt(sq_norm));
+    real_t coeff = this->norm_coeff_ / norm;
     if (coeff < 1) {
-      w(c) *= coeff;
+      scale *= coeff;
     }
   }
 
-  if (this->B_ > 0) {
-    math::Vector<real_t>& abs_w = this->abs_weights_;
-    // update abosulte weights
-    abs_w = L1(w(0).slice(dp.data()));
-    for (int c = 1; c < this->clf_num_; ++c) {
-      abs_w += L1(w(c).slice(dp.data()));
+  if (this->B_ > 0) this->TruncateWeights(dp);
+}
+
+void FOFS::ApplyScale(int c) {
+  auto& w_c = w(c);
+  if (this->scales_[c] != 1) {
+    w_c *= this->scales_[c];
+    this->scales_[c] = 1;
+  }
+  double sq_norm = 0;
+  w_c.slice_op([&sq_norm](const real_t& val) { sq_norm += double(val) * val; });
+  this->sq_norms_[c] = sq_norm;
+}
+
+void FOFS::TruncateWeights(const pario::DataPoint& dp) {
+  const auto& x = dp.data();
+  size_t feat_num = x.size();
+  math::Vector<real_t>& abs_w = this->abs_weights_;
+
+  // update abosulte weights
+  for (size_t i = 0; i < feat_num; ++i) {
+    index_t idx = x.index(i);
+    real_t val = 0;
+    for (int c = 0; c < this->clf_num_; ++c) {
+      val += std::abs(this->scales_[c] * w(c)[idx]);
     }
+    abs_w[idx] = val;
+  }
+
+  auto truncate = [this, &abs_w](index_t idx) {
+    for (int c = 0; c < this->clf_num_; ++c) {
+      real_t& val = w(c)[idx];
+      this->sq_norms_[c] -= double(val) * val;
+      val = 0;
+    }
+    abs_w[idx] = 0;
+  };
 
-    // update heap
+  if (this->heap_synced_ == false) {
+    // the first update scans all features
     this->min_heap_.BuildHeap();
     index_t valid_dim = this->dim_ - 1;  // ignore bias
     for (index_t i = 0; i < valid_dim; ++i) {
       index_t ret_idx = this->min_heap_.UpdateHeap(i);
-      if (ret_idx != invalid_index) {
-        ++ret_idx;
-        for (int c = 0; c < this->clf_num_; ++c) {
-          w(c)[ret_idx] = 0;
-        }
-        abs_w[ret_idx] = 0;
-      }
+      if (ret_idx != invalid_index) truncate(ret_idx + 1);
     }
+    this->heap_synced_ = true;
+    return;
+  }
+
+  // weights outside the heap are zero except the updated features
+  for (size_t i = 0; i < feat_num; ++i) {
+    if (x.index(i) > 0) this->min_heap_.AdjustValue(x.index(i) - 1);
+  }
+  for (size_t i = 0; i < feat_num; ++i) {
+    if (x.index(i) == 0) continue;
+    index_t ret_idx = this->min_heap_.UpdateHeap(x.index(i) - 1);
+    if (ret_idx != invalid_index) truncate(ret_idx + 1);
   }
 }
+
 void FOFS::update_dim(index_t dim) {
   if (dim > this->dim_) {
     math::Vector<real_t>& abs_w = this->abs_weights_;
@@ -111,6 +213,30 @@ void FOFS::GetModelInfo(Json::Value& root) const {
   root["online"]["B"] = this->B_;
 }
 
+void FOFS::GetModelParam(std::ostream& os) const {
+  for (int c = 0; c < this->clf_num_; ++c) {
+    if (this->scales_[c] == 1) {
+      os << "weight[" << c << "]:" << w(c) << "\n";
+    } else {
+      math::Vector<real_t> w_c(w(c) * this->scales_[c]);
+      os << "weight[" << c << "]:" << w_c << "\n";
+    }
+  }
+}
+
+// the weights are shared with the model only if they are not scaled, which is
+// always true for a new model to be loaded
+void FOFS::GetModelArrays(std::vector<ModelArray>& arrays) const {
+  for (int c = 0; c < this->clf_num_; ++c) {
+    if (this->scales_[c] == 1) {
+      arrays.emplace_back("weight[" + to_string(c) + "]", w(c));
+    } else {
+      math::Vector<real_t> w_c(w(c) * this->scales_[c]);
+      arrays.emplace_back("weight[" + to_string(c) + "]", w_c);
+    }
+  }
+}
+
 RegisterModel(FOFS, "fofs", "First Order Online Feature Selection");
 }  // namespace mdoel
 }  // namespace sol
@@ -48,6 +48,12 @@ void OGD::GetModelInfo(Json::Value& root) const {
   root["online"]["eta"] = this->eta0_;
 }
 
+int OGD::ShareStates(const OnlineLinearModel& model) {
+  if (this->regularizer_ != nullptr) return Status_Invalid_Argument;
+  this->ShareWeights(model);
+  return Status_OK;
+}
+
 // calculate power t
 float pow_const(int iter, float power_t) { return 1; }
 float pow_sqrt(int iter, float power_t) { return sqrtf(float(iter)); }
@@ -169,7 +175,9 @@ void FOBOS_L1::EndTrain() {
 RegisterModel(FOBOS_L1, "fobos-l1",
               "Forward Backward Splitting l1 regularization");
 
-PET::PET(int class_num) : OGD(class_num) { this->regularizer_ = &(this->l0_); }
+PET::PET(int class_num) : OGD(class_num), heap_synced_(false) {
+  this->regularizer_ = &(this->l0_);
+}
 
 PET::~PET() {}
 
@@ -197,6 +205,7 @@ void PET::BeginTrain() {
       abs_w += L1(w(i));
     }
     this->min_heap_.Init(this->dim_ - 1, B, abs_w.data() + 1);
+    this->heap_synced_ = false;
   }
 }
 
@@ -205,27 +214,46 @@ void PET::Update(const pario::DataPoint& dp, const float* predict, float loss) {
 
   // number of features to select
   index_t B = static_cast<index_t>(this->l0_.lambda());
-  if (B > 0) {
-    math::Vector<real_t>& abs_w = this->abs_weights_;
-    // update abosulte weights
-    abs_w = L1(w(0).slice(dp.data()));
-    for (int c = 1; c < this->clf_num_; ++c) {
-      abs_w += L1(w(c).slice(dp.data()));
+  if (B > 0) this->TruncateWeights(dp);
+}
+
+void PET::TruncateWeights(const pario::DataPoint& dp) {
+  const auto& x = dp.data();
+  size_t feat_num = x.size();
+  math::Vector<real_t>& abs_w = this->abs_weights_;
+  // update abosulte weights
+  abs_w = L1(w(0).slice(x));
+  for (int c = 1; c < this->clf_num_; ++c) {
+    abs_w += L1(w(c).slice(x));
+  }
+
+  auto truncate = [this, &abs_w](index_t idx) {
+    for (int c = 0; c < this->clf_num_; ++c) {
+      w(c)[idx] = 0;
     }
+    abs_w[idx] = 0;
+  };
 
-    // update heap
+  if (this->heap_synced_ == false) {
+    // the first update scans all features
     this->min_heap_.BuildHeap();
     index_t valid_dim = this->dim_ - 1;  // ignore bias
     for (index_t i = 0; i < valid_dim; ++i) {
       index_t ret_idx = this->min_heap_.UpdateHeap(i);
-      if (ret_idx != invalid_index) {
-        ++ret_idx;
-        for (int c = 0; c < this->clf_num_; ++c) {
-          w(c)[ret_idx] = 0;
-        }
-        abs_w[ret_idx] = 0;
-      }
+      if (ret_idx != invalid_index) truncate(ret_idx + 1);
     }
+    this->heap_synced_ = true;
+    return;
+  }
+
+  // weights outside the heap are zero except the updated features
+  for (size_t i = 0; i < feat_num; ++i) {
+    if (x.index(i) > 0) this->min_heap_.AdjustValue(x.index(i) - 1);
+  }
+  for (size_t i = 0; i < feat_num; ++i) {
+    if (x.index(i) == 0) continue;
+    index_t ret_idx = this->min_heap_.UpdateHeap(x.index(i) - 1);
+    if (ret_idx != invalid_index) truncate(ret_idx + 1);
   }
 }
 
@@ -29,6 +29,12 @@ void PA::Update(const pario::DataPoint& dp, const float*, float loss) {
   }
 }
 
+int PA::ShareStates(const OnlineLinearModel& model) {
+  if (this->regularizer_ != nullptr) return Status_Invalid_Argument;
+  this->ShareWeights(model);
+  return Status_OK;
+}
+
 RegisterModel(PA, "pa", "Online Passive Aggressive");
 
 void PAI::SetParameter(const std::string& name, const std::string& value) {
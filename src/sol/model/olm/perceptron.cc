@@ -46,6 +46,12 @@ void Perceptron::Update(const pario::DataPoint& dp, const float*, float) {
   }
 }
 
+int Perceptron::ShareStates(const OnlineLinearModel& model) {
+  if (this->regularizer_ != nullptr) return Status_Invalid_Argument;
+  this->ShareWeights(model);
+  return Status_OK;
+}
+
 RegisterModel(Perceptron, "perceptron", "perceptron algorithm");
 
 }  // namespace model
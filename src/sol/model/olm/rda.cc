@@ -91,6 +91,13 @@ void RDA::GetModelParam(std::ostream& os) const {
   }
 }
 
+void RDA::GetModelArrays(std::vector<ModelArray>& arrays) const {
+  OnlineLinearModel::GetModelArrays(arrays);
+  for (int c = 0; c < this->clf_num_; ++c) {
+    arrays.emplace_back("ut[" + to_string(c) + "]", this->ut_[c]);
+  }
+}
+
 int RDA::SetModelParam(std::istream& is) {
   OnlineLinearModel::SetModelParam(is);
 
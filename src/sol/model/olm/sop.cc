@@ -100,6 +100,14 @@ void SOP::GetModelParam(std::ostream& os) const {
   }
 }
 
+void SOP::GetModelArrays(std::vector<ModelArray>& arrays) const {
+  OnlineLinearModel::GetModelArrays(arrays);
+  arrays.emplace_back("X", this->X_);
+  for (int c = 0; c < this->clf_num_; ++c) {
+    arrays.emplace_back("v[" + to_string(c) + "]", v(c));
+  }
+}
+
 int SOP::SetModelParam(std::istream& is) {
   OnlineLinearModel::SetModelParam(is);
 
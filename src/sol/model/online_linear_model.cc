@@ -13,6 +13,7 @@
 
 #include "sol/loss/hinge_loss.h"
 #include "sol/util/util.h"
+#include "sol/util/profiler.h"
 
 using namespace std;
 using namespace sol::math;
@@ -24,7 +25,9 @@ namespace model {
 OnlineLinearModel::OnlineLinearModel(int class_num)
     : OnlineModel(class_num, "online_linear"),
       weights_(nullptr),
-      gradients_(nullptr) {
+      gradients_(nullptr),
+      interleave_(false),
+      interleaved_dirty_(true) {
   this->weights_ = new Vector<real_t>[this->clf_num_];
   this->gradients_ = new real_t[this->clf_num_];
 
@@ -46,18 +49,35 @@ OnlineLinearModel::~OnlineLinearModel() {
   DeleteArray(this->gradients_);
 }
 
+void OnlineLinearModel::SetParameter(const std::string& name,
+                                     const std::string& value) {
+  if (name == "interleave") {
+    this->interleave_ = value == "true" ? true : false;
+    this->interleaved_dirty_ = true;
+  } else {
+    OnlineModel::SetParameter(name, value);
+  }
+}
+
 label_t OnlineLinearModel::Iterate(const DataPoint& dp, float* predicts) {
   OnlineModel::Iterate(dp, predicts);
+  if (this->interleaved_weights_.size() != 0) {
+    this->ReleaseInterleavedWeights();
+  }
   if (this->regularizer_ != nullptr) {
     this->online_regularizer()->BeginIterate(dp);
   }
 
-  label_t label = this->TrainPredict(dp, predicts);
+  label_t label = 0;
+  {
+    ProfileScope scope(kStagePredict);
+    label = this->TrainPredict(dp, predicts);
+  }
   // active learning
   if (this->active_smoothness_ > 0) {
-    static random_device rd;
-    static mt19937 gen(rd());
-    static uniform_real_distribution<float> dis(0, 1);
+    static thread_local random_device rd;
+    static thread_local mt19937 gen(rd());
+    static thread_local uniform_real_distribution<float> dis(0, 1);
     float margin = 0;
     if (this->clf_num_ == 1) {
       margin = abs(*predicts);
@@ -82,14 +102,14 @@ label_t OnlineLinearModel::Iterate(const DataPoint& dp, float* predicts) {
       hinge_loss->set_margin(1.f);
     }
   }
-  float loss = this->loss_->gradient(dp, predicts, label, this->gradients_,
-                                     this->clf_num_);
-  if (this->lazy_update_) {
-    if (label != dp.label()) {
-      ++this->update_num_;
-      this->Update(dp, predicts, loss);
-    }
-  } else if (loss > 0) {
+  float loss = 0;
+  {
+    ProfileScope scope(kStageGradient);
+    loss = this->loss_->gradient(dp, predicts, label, this->gradients_,
+                                 this->clf_num_);
+  }
+  if (this->lazy_update_ ? label != dp.label() : loss > 0) {
+    ProfileScope scope(kStageUpdate);
     ++this->update_num_;
     this->Update(dp, predicts, loss);
   }
@@ -116,8 +136,27 @@ label_t OnlineLinearModel::TrainPredict(const pario::DataPoint& dp,
 label_t OnlineLinearModel::Predict(const pario::DataPoint& dp,
                                    float* predicts) {
   const auto& x = dp.data();
-  for (int c = 0; c < this->clf_num_; ++c) {
-    predicts[c] = expr::dotmul(w(c), x) + w(c)[0];
+  if (this->interleave_ && this->clf_num_ > 1 &&
+      this->interleaved_dirty_ == false) {
+    // score all classes in one pass over the features
+    const real_t* weights = this->interleaved_weights_.begin();
+    size_t clf_num = size_t(this->clf_num_);
+    for (size_t c = 0; c < clf_num; ++c) predicts[c] = 0;
+    size_t feat_num = x.size();
+    for (size_t i = 0; i < feat_num; ++i) {
+      if (x.index(i) >= this->dim_) continue;
+      const real_t* w_i = weights + x.index(i) * clf_num;
+      real_t val = x.value(i);
+      for (size_t c = 0; c < clf_num; ++c) {
+        predicts[c] += w_i[c] * val;
+      }
+    }
+    for (size_t c = 0; c < clf_num; ++c) predicts[c] += weights[c];
+  } else {
+    // the interleaved copy is stale until BeginPredict rebuilds it
+    for (int c = 0; c < this->clf_num_; ++c) {
+      predicts[c] = expr::dotmul(w(c), x) + w(c)[0];
+    }
   }
   if (this->clf_num_ == 1) {
     return loss::Loss::Sign(*predicts);
@@ -134,7 +173,57 @@ void OnlineLinearModel::update_dim(index_t dim) {
       w(i).slice_op([](real_t& val) { val = 0; }, this->dim_);
     }
     OnlineModel::update_dim(dim);
+    this->interleaved_dirty_ = true;
+  }
+}
+
+OnlineModel* OnlineLinearModel::CreateWorker() {
+  Json::Value root;
+  this->GetModelInfo(root);
+  OnlineLinearModel* worker = static_cast<OnlineLinearModel*>(
+      Model::Create(this->name(), this->class_num_));
+  if (worker == nullptr) return nullptr;
+  // setting not always in the model info
+  worker->active_smoothness_ = this->active_smoothness_;
+  if (worker->SetModelInfo(root) != Status_OK ||
+      worker->ShareStates(*this) != Status_OK) {
+    DeletePointer(worker);
+    return nullptr;
+  }
+  try {
+    worker->BeginTrain();
+  }
+  catch (invalid_argument& err) {
+    fprintf(stderr, "%s\n", err.what());
+    DeletePointer(worker);
   }
+  return worker;
+}
+
+void OnlineLinearModel::ShareWeights(const OnlineLinearModel& model) {
+  for (int c = 0; c < this->clf_num_; ++c) {
+    w(c) = model.w(c);
+  }
+  this->dim_ = model.dim_;
+}
+
+void OnlineLinearModel::InterleaveWeights() {
+  size_t clf_num = size_t(this->clf_num_);
+  this->interleaved_weights_.resize(this->dim_ * clf_num);
+  real_t* weights = this->interleaved_weights_.begin();
+  for (size_t c = 0; c < clf_num; ++c) {
+    const real_t* w_c = w(int(c)).begin();
+    for (size_t i = 0; i < this->dim_; ++i) {
+      weights[i * clf_num + c] = w_c[i];
+    }
+  }
+  this->interleaved_dirty_ = false;
+}
+
+void OnlineLinearModel::ReleaseInterleavedWeights() {
+  // the storage is only freed by dropping the reference to it
+  this->interleaved_weights_ = Vector<real_t>();
+  this->interleaved_dirty_ = true;
 }
 
 float OnlineLinearModel::model_sparsity() {
@@ -149,17 +238,31 @@ float OnlineLinearModel::model_sparsity() {
   return 1.f - float(non_zero_num / double(this->clf_num_ * (this->dim_ - 1)));
 }
 
+void OnlineLinearModel::GetModelInfo(Json::Value& root) const {
+  OnlineModel::GetModelInfo(root);
+  if (this->interleave_) {
+    root["online"]["interleave"] = "true";
+  }
+}
+
 void OnlineLinearModel::GetModelParam(std::ostream& os) const {
   for (int c = 0; c < this->clf_num_; ++c) {
     os << "weight[" << c << "]:" << w(c) << "\n";
   }
 }
 
+void OnlineLinearModel::GetModelArrays(std::vector<ModelArray>& arrays) const {
+  for (int c = 0; c < this->clf_num_; ++c) {
+    arrays.emplace_back("weight[" + to_string(c) + "]", w(c));
+  }
+}
+
 int OnlineLinearModel::SetModelParam(std::istream& is) {
   string line;
   for (int c = 0; c < this->clf_num_; ++c) {
     is >> line >> w(c);
   }
+  this->interleaved_dirty_ = true;
   return Status_OK;
 }
 
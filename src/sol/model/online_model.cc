@@ -9,11 +9,14 @@
 #include "sol/model/online_model.h"
 #include "sol/util/str_util.h"
 #include "sol/util/util.h"
+#include "sol/util/monitor.h"
+#include "sol/util/thread_task.h"
 
 #include <sstream>
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 
 using namespace std;
 using namespace sol::pario;
@@ -141,40 +144,26 @@ float OnlineModel::Train(DataIter& data_iter) {
     }
   }
 
-  size_t next_show_time = size_t(-1);
+  size_t next_show_time = this->BeginShowIterStatus();
 
-  if (this->iter_displayer_ != nullptr) {
-    next_show_time = this->iter_displayer_->next_show_time();
-    if (this->iter_callback_ == DefaultIterateFunction &&
-        this->cur_data_num_ == 0) {
-      cout << "Training Process....\nData No.\tIterate No.\tError Rate\tUpdate "
-              "No.\n";
-    }
-  }
+  if (this->thread_num_ <= 1 ||
+      this->ParallelTrain(data_iter, next_show_time) == false) {
+    float* predicts = new float[this->clf_num()];
+    MiniBatch* mb = nullptr;
+    while (1) {
+      mb = data_iter.Next(mb);
+      if (mb == nullptr) break;
+      // data_num += mb->size();
+      for (int i = 0; i < mb->size(); ++i) {
+        DataPoint& x = (*mb)[i];
+        this->PreProcess(x);
+        // predict
+        if (this->Iterate(x, predicts) != x.label()) ++this->cur_err_num_;
 
-  float* predicts = new float[this->clf_num()];
-  MiniBatch* mb = nullptr;
-  while (1) {
-    mb = data_iter.Next(mb);
-    if (mb == nullptr) break;
-    // data_num += mb->size();
-    for (int i = 0; i < mb->size(); ++i) {
-      DataPoint& x = (*mb)[i];
-      this->PreProcess(x);
-      // predict
-      if (this->Iterate(x, predicts) != x.label()) ++this->cur_err_num_;
-
-      if (this->cur_data_num_ >= next_show_time) {
-        float err_rate = float(this->cur_err_num_) / this->cur_data_num_;
-        if (this->iter_callback_ != nullptr) {
-          this->iter_callback_(this->iter_callback_user_context_,
-                               this->cur_data_num_, this->cur_iter_num(),
-                               this->update_num(), err_rate);
-        }
-        this->iter_displayer_->next();
-        next_show_time = this->iter_displayer_->next_show_time();
+        this->ShowIterStatus(next_show_time);
       }
     }
+    delete[] predicts;
   }
 
   float err_rate = float(this->cur_err_num_) / this->cur_data_num_;
@@ -184,13 +173,169 @@ float OnlineModel::Train(DataIter& data_iter) {
                            this->cur_data_num_, this->cur_iter_num(),
                            this->update_num(), err_rate);
     }
+    if (Profiler::enabled() && this->iter_callback_ == DefaultIterateFunction) {
+      this->iter_displayer_->show_profile(cout);
+    }
   }
-  delete[] predicts;
   this->model_updated_ = true;
 
   return err_rate;
 }
 
+float OnlineModel::PartialFit(DataReader& reader) {
+  if (this->require_reinit_) {
+    try {
+      this->BeginTrain();
+    }
+    catch (invalid_argument& err) {
+      fprintf(stderr, "%s\n", err.what());
+      return -1.f;
+    }
+  }
+
+  size_t next_show_time = this->BeginShowIterStatus();
+  float* predicts = new float[this->clf_num()];
+  DataPoint x;
+  size_t data_num = 0;
+  size_t err_num = 0;
+  int ret = Status_OK;
+  while ((ret = reader.Next(x)) == Status_OK) {
+    this->PreProcess(x);
+    if (this->Iterate(x, predicts) != x.label()) {
+      ++err_num;
+      ++this->cur_err_num_;
+    }
+    ++data_num;
+    this->ShowIterStatus(next_show_time);
+  }
+  delete[] predicts;
+  if (data_num == 0) return 0;
+  this->model_updated_ = true;
+  // parse error in the data
+  if (ret != Status_EndOfFile) return -1.f;
+  return float(double(err_num) / data_num);
+}
+
+size_t OnlineModel::BeginShowIterStatus() {
+  if (this->iter_displayer_ == nullptr) return size_t(-1);
+  if (this->iter_callback_ == DefaultIterateFunction &&
+      this->cur_data_num_ == 0) {
+    cout << "Training Process....\nData No.\tIterate No.\tError Rate\tUpdate "
+            "No.\n";
+  }
+  return this->iter_displayer_->next_show_time();
+}
+
+bool OnlineModel::ParallelTrain(DataIter& data_iter, size_t& next_show_time) {
+  vector<OnlineModel*> workers;
+  for (int i = 0; i < this->thread_num_; ++i) {
+    OnlineModel* worker = this->CreateWorker();
+    if (worker == nullptr) break;
+    workers.push_back(worker);
+  }
+  if (int(workers.size()) < this->thread_num_) {
+    for (OnlineModel*& worker : workers) DeletePointer(worker);
+    fprintf(stderr,
+            "warning: multi-threaded training is not supported by %s, train "
+            "with one thread\n",
+            this->name().c_str());
+    return false;
+  }
+
+  // lock to fetch mini-batches from data_iter
+  Mutex fetch_mutex;
+  // lock to grow the dimension and aggregate the counters
+  Monitor monitor;
+  // number of workers updating the model
+  int active_num = 0;
+  // whether a worker is waiting to grow the dimension of the model
+  bool growing = false;
+
+  auto train_func = [&](OnlineModel* worker) {
+    float* predicts = new float[this->clf_num_];
+    while (1) {
+      fetch_mutex.lock();
+      MiniBatch* mb = data_iter.Next();
+      fetch_mutex.unlock();
+      if (mb == nullptr) break;
+
+      index_t dim = 0;
+      for (int i = 0; i < mb->size(); ++i) {
+        DataPoint& x = (*mb)[i];
+        this->PreProcess(x);
+        dim = (std::max)(dim, x.dim());
+      }
+
+      monitor.lock();
+      while (growing) monitor.wait();
+      if (dim > this->dim_) {
+        // the weights may be reallocated, wait until no one is updating
+        growing = true;
+        while (active_num > 0) monitor.wait();
+        this->update_dim(dim);
+        for (OnlineModel* w : workers) w->update_dim(dim);
+        growing = false;
+        monitor.notify_all();
+      }
+      ++active_num;
+      worker->cur_iter_num_ = this->cur_iter_num_;
+      monitor.unlock();
+
+      int iter_num = worker->cur_iter_num_;
+      size_t update_num = worker->update_num_;
+      size_t err_num = 0;
+      for (int i = 0; i < mb->size(); ++i) {
+        DataPoint& x = (*mb)[i];
+        if (worker->Iterate(x, predicts) != x.label()) ++err_num;
+      }
+
+      monitor.lock();
+      --active_num;
+      this->cur_data_num_ += mb->size();
+      this->cur_err_num_ += err_num;
+      this->cur_iter_num_ += worker->cur_iter_num_ - iter_num;
+      this->update_num_ += worker->update_num_ - update_num;
+      this->ShowIterStatus(next_show_time);
+      monitor.notify_all();
+      monitor.unlock();
+
+      data_iter.Recycle(mb);
+    }
+    delete[] predicts;
+  };
+
+  vector<shared_ptr<FunctionTask>> tasks;
+  for (OnlineModel* worker : workers) {
+    tasks.push_back(
+        make_shared<FunctionTask>(std::bind(train_func, worker)));
+    tasks.back()->Start();
+  }
+  for (shared_ptr<FunctionTask>& task : tasks) {
+    task->Join();
+  }
+  for (OnlineModel*& worker : workers) DeletePointer(worker);
+  return true;
+}
+
+void OnlineModel::ShowIterStatus(size_t& next_show_time) {
+  if (this->cur_data_num_ < next_show_time) return;
+
+  float err_rate = float(this->cur_err_num_) / this->cur_data_num_;
+  if (this->iter_callback_ != nullptr) {
+    this->iter_callback_(this->iter_callback_user_context_,
+                         this->cur_data_num_, this->cur_iter_num(),
+                         this->update_num(), err_rate);
+  }
+  if (Profiler::enabled() && this->iter_callback_ == DefaultIterateFunction) {
+    this->iter_displayer_->show_profile(cout);
+  }
+  // a mini-batch may step over several show times
+  while (next_show_time <= this->cur_data_num_) {
+    this->iter_displayer_->next();
+    next_show_time = this->iter_displayer_->next_show_time();
+  }
+}
+
 label_t OnlineModel::Iterate(const pario::DataPoint& x, float* predict) {
   this->update_dim(x.dim());
   ++this->cur_iter_num_;
@@ -9,15 +9,31 @@
 #include "sol/pario/binary_reader.h"
 
 #include <cstdlib>
+#include <cstring>
 
 #include "sol/pario/compress.h"
+#include "sol/pario/block_binary_format.h"
 #include "sol/util/error_code.h"
 
 namespace sol {
 namespace pario {
 
 int BinaryReader::Open(const std::string& path, const char* mode) {
-  return DataFileReader::Open(path, "rb");
+  int ret = DataFileReader::Open(path, "rb");
+  if (ret != Status_OK) return ret;
+  // files of the block binary format (v2) start with a magic
+  char magic[4];
+  if (this->file_reader_.Size() >= int64_t(sizeof(magic)) &&
+      this->file_reader_.Read(magic, sizeof(magic)) == Status_OK) {
+    if (memcmp(magic, block_binary::kFileMagic, sizeof(magic)) == 0) {
+      fprintf(stderr, "%s is in the block binary format, read it by bin2\n",
+              path.c_str());
+      this->is_good_ = false;
+      return Status_Invalid_Format;
+    }
+    ret = this->file_reader_.Seek(0);
+  }
+  return ret;
 }
 
 int BinaryReader::Next(DataPoint& dst_data) {
@@ -48,8 +64,8 @@ int BinaryReader::Next(DataPoint& dst_data) {
       return Status_Invalid_Format;
     }
     dst_data.Resize(feat_num);
-    decomp_index(this->comp_codes_, dst_data.indexes());
-    if (dst_data.indexes().size() != feat_num) {
+    if (decomp_index(this->comp_codes_.begin(), this->comp_codes_.end(),
+                     dst_data.indexes().begin(), feat_num) != feat_num) {
       fprintf(stderr, "decoded index number is not correct!\n");
       return Status_Invalid_Format;
     }
@@ -0,0 +1,110 @@
+/*********************************************************************************
+*     File Name           :     block_binary_format.cc
+*     Created By          :     yuewu
+*     Description         :     checksum and codecs of the block binary format
+**********************************************************************************/
+
+#include "sol/pario/block_binary_format.h"
+
+#include <cstdio>
+
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#include "sol/util/error_code.h"
+
+namespace sol {
+namespace pario {
+namespace block_binary {
+
+/// \brief  lookup table of crc32
+struct Crc32Table {
+  uint32_t table[256];
+  Crc32Table() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+      }
+      this->table[i] = c;
+    }
+  }
+};
+
+uint32_t Crc32(const char* data, size_t len) {
+  static const Crc32Table crc_table;
+  uint32_t crc = 0xFFFFFFFFU;
+  const unsigned char* p = (const unsigned char*)data;
+  for (size_t i = 0; i < len; ++i) {
+    crc = crc_table.table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFU;
+}
+
+bool CodecSupported(int codec) {
+  switch (codec) {
+    case kCodecNone:
+      return true;
+#ifdef HAS_ZLIB
+    case kCodecZlib:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+int Compress(int codec, const char* src, size_t len, std::vector<char>& dst) {
+  switch (codec) {
+    case kCodecNone:
+      dst.assign(src, src + len);
+      return Status_OK;
+#ifdef HAS_ZLIB
+    case kCodecZlib: {
+      uLongf dst_len = compressBound(uLong(len));
+      dst.resize(dst_len);
+      // the fastest level, blocks are compressed while writing
+      if (compress2((Bytef*)dst.data(), &dst_len, (const Bytef*)src,
+                    uLong(len), 1) != Z_OK) {
+        fprintf(stderr, "compress block failed\n");
+        return Status_Error;
+      }
+      dst.resize(dst_len);
+      return Status_OK;
+    }
+#endif
+    default:
+      fprintf(stderr, "codec %d is not supported\n", codec);
+      return Status_Invalid_Argument;
+  }
+}
+
+int Decompress(int codec, const char* src, size_t len, char* dst,
+               size_t dst_len) {
+  switch (codec) {
+    case kCodecNone:
+      if (len != dst_len) return Status_Invalid_Format;
+      memcpy(dst, src, len);
+      return Status_OK;
+#ifdef HAS_ZLIB
+    case kCodecZlib: {
+      uLongf out_len = uLongf(dst_len);
+      if (uncompress((Bytef*)dst, &out_len, (const Bytef*)src, uLong(len)) !=
+              Z_OK ||
+          out_len != dst_len) {
+        fprintf(stderr, "decompress block failed\n");
+        return Status_Invalid_Format;
+      }
+      return Status_OK;
+    }
+#endif
+    default:
+      fprintf(stderr, "codec %d is not supported, rebuild with zlib\n", codec);
+      return Status_Invalid_Argument;
+  }
+}
+
+}  // namespace block_binary
+}  // namespace pario
+}  // namespace sol
@@ -0,0 +1,279 @@
+/*********************************************************************************
+*     File Name           :     block_binary_reader.cc
+*     Created By          :     yuewu
+*     Description         :     block binary format (v2) data reader
+**********************************************************************************/
+
+#include "sol/pario/block_binary_reader.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include "sol/pario/value_codec.h"
+#include "sol/util/error_code.h"
+
+using namespace std;
+
+namespace sol {
+namespace pario {
+
+using namespace block_binary;
+
+// blocks are not bounded without the block index
+static const size_t kAllBlocks = size_t(-1);
+
+BlockBinaryReader::BlockBinaryReader()
+    : index_codec_(nullptr),
+      data_end_(-1),
+      first_block_(0),
+      end_block_(kAllBlocks),
+      next_block_(0),
+      raw_pos_(0),
+      inst_left_(0) {}
+
+int BlockBinaryReader::Open(const std::string& path, const char* mode) {
+  int ret = DataFileReader::Open(path, "rb");
+  if (ret != Status_OK) return ret;
+
+  this->block_offsets_.clear();
+  this->block_first_insts_.clear();
+  this->data_end_ = -1;
+  this->first_block_ = 0;
+  this->end_block_ = kAllBlocks;
+  this->next_block_ = 0;
+  this->inst_left_ = 0;
+
+  char buf[kFileHeaderSize];
+  uint32_t version = 0, index_codec = 0;
+  ret = this->file_reader_.Read(buf, kFileHeaderSize);
+  if (ret == Status_OK) {
+    memcpy(&version, buf + 4, 4);
+    memcpy(&index_codec, buf + 8, 4);
+  }
+  if (ret != Status_OK || memcmp(buf, kFileMagic, 4) != 0 ||
+      version != kVersion) {
+    fprintf(stderr, "%s is not a bin2 file\n", path.c_str());
+    this->is_good_ = false;
+    return Status_Invalid_Format;
+  }
+  this->index_codec_ = IndexCodec::Get(int(index_codec));
+  if (this->index_codec_ == nullptr) {
+    fprintf(stderr, "unknown index codec %u of %s\n", index_codec,
+            path.c_str());
+    this->is_good_ = false;
+    return Status_Invalid_Format;
+  }
+
+  // the block index is optional for sequential reading
+  if (this->file_reader_.Size() >= 0) {
+    if (this->ReadIndex() == Status_OK) {
+      this->end_block_ = this->block_num();
+    } else {
+      fprintf(stderr,
+              "warning: block index of %s is not valid, the file can only be "
+              "read sequentially\n",
+              path.c_str());
+    }
+    if (this->file_reader_.Seek(kFileHeaderSize) != Status_OK) {
+      this->is_good_ = false;
+      return Status_IO_Error;
+    }
+  }
+  return Status_OK;
+}
+
+int BlockBinaryReader::ReadIndex() {
+  int64_t size = this->file_reader_.Size();
+  if (size < int64_t(kFileHeaderSize + kTrailerSize)) {
+    return Status_Invalid_Format;
+  }
+  char trailer[kTrailerSize];
+  int ret = this->file_reader_.Seek(size - kTrailerSize);
+  if (ret == Status_OK) ret = this->file_reader_.Read(trailer, kTrailerSize);
+  if (ret != Status_OK) return ret;
+
+  uint64_t block_num, index_offset;
+  uint32_t checksum;
+  const char* p = trailer;
+  BlockHeader::Get(p, block_num);
+  BlockHeader::Get(p, index_offset);
+  BlockHeader::Get(p, checksum);
+  if (memcmp(p, kIndexMagic, 4) != 0 ||
+      index_offset + block_num * kIndexEntrySize + kTrailerSize !=
+          uint64_t(size)) {
+    return Status_Invalid_Format;
+  }
+
+  vector<char> index(block_num * kIndexEntrySize);
+  ret = this->file_reader_.Seek(int64_t(index_offset));
+  if (ret == Status_OK && block_num > 0) {
+    ret = this->file_reader_.Read(index.data(), index.size());
+  }
+  if (ret != Status_OK) return ret;
+  if (Crc32(index.data(), index.size()) != checksum) {
+    return Status_Invalid_Format;
+  }
+
+  this->block_offsets_.resize(block_num);
+  this->block_first_insts_.resize(block_num);
+  p = index.data();
+  for (size_t i = 0; i < block_num; ++i) {
+    BlockHeader::Get(p, this->block_offsets_[i]);
+    BlockHeader::Get(p, this->block_first_insts_[i]);
+  }
+  // the end mark is before the index
+  this->data_end_ = int64_t(index_offset - BlockHeader::kSize);
+  return Status_OK;
+}
+
+void BlockBinaryReader::Rewind() {
+  if (this->data_end_ >= 0) {
+    this->SeekBlock(this->first_block_);
+  } else {
+    // stdin or files without the block index
+    this->file_reader_.Rewind();
+    char buf[kFileHeaderSize];
+    this->file_reader_.Read(buf, kFileHeaderSize);
+    this->next_block_ = 0;
+    this->inst_left_ = 0;
+  }
+}
+
+int BlockBinaryReader::SetRange(int64_t begin, int64_t end) {
+  if (this->data_end_ < 0) {
+    fprintf(stderr, "bin2 file without block index can not be split\n");
+    return Status_Invalid_Argument;
+  }
+  if (begin < 0 || (end >= 0 && end < begin)) {
+    fprintf(stderr, "invalid byte range [%lld, %lld)\n", (long long)begin,
+            (long long)end);
+    return Status_Invalid_Argument;
+  }
+  this->first_block_ = size_t(
+      lower_bound(this->block_offsets_.begin(), this->block_offsets_.end(),
+                  uint64_t(begin)) -
+      this->block_offsets_.begin());
+  this->end_block_ =
+      end < 0 ? this->block_num()
+              : size_t(lower_bound(this->block_offsets_.begin(),
+                                   this->block_offsets_.end(), uint64_t(end)) -
+                       this->block_offsets_.begin());
+  return this->SeekBlock(this->first_block_);
+}
+
+int BlockBinaryReader::SeekBlock(size_t block) {
+  if (this->data_end_ < 0 || block > this->block_num()) {
+    fprintf(stderr, "seek to block %llu failed\n", (unsigned long long)block);
+    return Status_Invalid_Argument;
+  }
+  int64_t offset = block < this->block_num()
+                       ? int64_t(this->block_offsets_[block])
+                       : this->data_end_;
+  int ret = this->file_reader_.Seek(offset);
+  if (ret != Status_OK) return ret;
+  this->next_block_ = block;
+  this->inst_left_ = 0;
+  return Status_OK;
+}
+
+int BlockBinaryReader::LoadBlock() {
+  if (this->next_block_ >= this->end_block_) return Status_EndOfFile;
+
+  char buf[BlockHeader::kSize];
+  int ret = this->file_reader_.Read(buf, BlockHeader::kSize);
+  if (ret == Status_OK && this->header_.Deserialize(buf) == false) {
+    ret = Status_Invalid_Format;
+  }
+  if (ret != Status_OK) {
+    fprintf(stderr, "read header of block %llu failed\n",
+            (unsigned long long)this->next_block_);
+    this->is_good_ = false;
+    return ret == Status_EndOfFile ? Status_Invalid_Format : ret;
+  }
+  if (this->header_.inst_num == 0) return Status_EndOfFile;  // end mark
+
+  this->payload_.resize(this->header_.payload_len);
+  ret = this->file_reader_.Read(this->payload_.data(), this->payload_.size());
+  if (ret != Status_OK ||
+      Crc32(this->payload_.data(), this->payload_.size()) !=
+          this->header_.checksum) {
+    fprintf(stderr, "checksum of block %llu is not correct\n",
+            (unsigned long long)this->next_block_);
+    this->is_good_ = false;
+    return Status_Invalid_Format;
+  }
+  this->raw_.resize(this->header_.raw_len);
+  ret = Decompress(this->header_.codec, this->payload_.data(),
+                   this->payload_.size(), this->raw_.data(), this->raw_.size());
+  if (ret != Status_OK) {
+    this->is_good_ = false;
+    return ret;
+  }
+  this->raw_pos_ = 0;
+  this->inst_left_ = this->header_.inst_num;
+  ++this->next_block_;
+  return Status_OK;
+}
+
+int BlockBinaryReader::Next(DataPoint& dst_data) {
+  if (this->inst_left_ == 0) {
+    int ret = this->LoadBlock();
+    if (ret != Status_OK) return ret;
+  }
+
+  const char* p = this->raw_.data() + this->raw_pos_;
+  size_t left = this->raw_.size() - this->raw_pos_;
+  if (left < sizeof(label_t) + sizeof(size_t)) {
+    fprintf(stderr, "incomplete instance in block %llu!\n",
+            (unsigned long long)(this->next_block_ - 1));
+    this->is_good_ = false;
+    return Status_Invalid_Format;
+  }
+  label_t label;
+  memcpy(&label, p, sizeof(label_t));
+  size_t feat_num;
+  memcpy(&feat_num, p + sizeof(label_t), sizeof(size_t));
+  p += sizeof(label_t) + sizeof(size_t);
+  left -= sizeof(label_t) + sizeof(size_t);
+
+  dst_data.Clear();
+  dst_data.set_label(label);
+  if (feat_num > 0) {
+    size_t code_len = 0;
+    if (left >= sizeof(size_t)) memcpy(&code_len, p, sizeof(size_t));
+    p += sizeof(size_t);
+    // each index takes at least one byte
+    if (left < sizeof(size_t) || code_len > left - sizeof(size_t) ||
+        feat_num > code_len) {
+      fprintf(stderr, "load features failed!\n");
+      this->is_good_ = false;
+      return Status_Invalid_Format;
+    }
+    dst_data.Resize(feat_num);
+    if (this->index_codec_->Decode(p, code_len, dst_data.indexes().begin(),
+                                   feat_num) != Status_OK) {
+      fprintf(stderr, "decoded index number is not correct!\n");
+      this->is_good_ = false;
+      return Status_Invalid_Format;
+    }
+    p += code_len;
+    size_t used = 0;
+    if (DecodeValues(p, left - sizeof(size_t) - code_len,
+                     dst_data.features().begin(), feat_num,
+                     used) != Status_OK) {
+      fprintf(stderr, "load features failed!\n");
+      this->is_good_ = false;
+      return Status_Invalid_Format;
+    }
+    p += used;
+  }
+  this->raw_pos_ = size_t(p - this->raw_.data());
+  --this->inst_left_;
+  return Status_OK;
+}
+
+RegisterDataReader(BlockBinaryReader, "bin2",
+                   "block binary format (v2) data reader");
+
+}  // namespace pario
+}  // namespace sol
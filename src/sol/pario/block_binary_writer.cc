@@ -0,0 +1,216 @@
+/*********************************************************************************
+*     File Name           :     block_binary_writer.cc
+*     Created By          :     yuewu
+*     Description         :     block binary format (v2) data writer
+**********************************************************************************/
+#include "sol/pario/block_binary_writer.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "sol/pario/value_codec.h"
+#include "sol/util/str_util.h"
+#include "sol/util/error_code.h"
+
+using namespace std;
+
+namespace sol {
+namespace pario {
+
+using namespace block_binary;
+
+// default size of the uncompressed instances in a block
+static const size_t kDefaultBlockSize = 1 << 20;
+
+BlockBinaryWriter::BlockBinaryWriter()
+    : opened_(false),
+      block_size_(kDefaultBlockSize),
+      codec_(CodecSupported(kCodecZlib) ? kCodecZlib : kCodecNone),
+      index_codec_(IndexCodec::Get(kIndexCodecStreamVByte)),
+      value_precision_(kPrecisionLossless),
+      offset_(0),
+      inst_num_(0) {}
+
+BlockBinaryWriter::~BlockBinaryWriter() { this->Close(); }
+
+int BlockBinaryWriter::Open(const std::string& path, const char* mode) {
+  this->Close();
+  int ret = DataWriter::Open(path, "wb");
+  if (ret != Status_OK) return ret;
+  this->opened_ = true;
+  this->offset_ = 0;
+  this->inst_num_ = 0;
+  this->raw_.clear();
+  this->header_.Clear();
+  this->block_offsets_.clear();
+  this->block_first_insts_.clear();
+
+  char buf[kFileHeaderSize];
+  memcpy(buf, kFileMagic, 4);
+  memcpy(buf + 4, &kVersion, 4);
+  uint32_t index_codec = uint32_t(this->index_codec_->type());
+  memcpy(buf + 8, &index_codec, 4);
+  ret = this->file_writer_.Write(buf, kFileHeaderSize);
+  this->offset_ += kFileHeaderSize;
+  return ret;
+}
+
+void BlockBinaryWriter::Close() {
+  if (this->opened_ == false) return;
+  this->opened_ = false;
+  if (this->FlushBlock() != Status_OK) this->is_good_ = false;
+
+  // end mark for the readers without the block index
+  char buf[BlockHeader::kSize];
+  this->header_.Clear();
+  this->header_.Serialize(buf);
+  if (this->file_writer_.Write(buf, BlockHeader::kSize) != Status_OK) {
+    this->is_good_ = false;
+  }
+  this->offset_ += BlockHeader::kSize;
+
+  // block index and trailer
+  uint64_t index_offset = this->offset_;
+  uint64_t block_num = this->block_offsets_.size();
+  vector<char> index(block_num * kIndexEntrySize + kTrailerSize);
+  char* p = index.data();
+  for (size_t i = 0; i < block_num; ++i) {
+    BlockHeader::Put(p, this->block_offsets_[i]);
+    BlockHeader::Put(p, this->block_first_insts_[i]);
+  }
+  uint32_t checksum = Crc32(index.data(), block_num * kIndexEntrySize);
+  BlockHeader::Put(p, block_num);
+  BlockHeader::Put(p, index_offset);
+  BlockHeader::Put(p, checksum);
+  memcpy(p, kIndexMagic, 4);
+  if (this->file_writer_.Write(index.data(), index.size()) != Status_OK) {
+    this->is_good_ = false;
+  }
+  DataWriter::Close();
+}
+
+int BlockBinaryWriter::Write(const DataPoint& data) {
+  label_t label = data.label();
+  size_t feat_num = data.indexes().size();
+  this->header_.AddInstance(label,
+                            feat_num > 0 ? data.indexes().back() : 0);
+
+  // the record of the v1 format, except that the indexes are coded by the
+  // index codec and the values by the value encodings
+  const char* label_ptr = (const char*)&label;
+  this->raw_.insert(this->raw_.end(), label_ptr, label_ptr + sizeof(label));
+  const char* num_ptr = (const char*)&feat_num;
+  this->raw_.insert(this->raw_.end(), num_ptr, num_ptr + sizeof(feat_num));
+  if (feat_num > 0) {
+    this->comp_codes_.clear();
+    int ret = this->index_codec_->Encode(data.indexes().begin(), feat_num,
+                                         this->comp_codes_);
+    if (ret != Status_OK) {
+      fprintf(stderr, "encode indexes by %s failed\n",
+              this->index_codec_->name());
+      return ret;
+    }
+    size_t code_len = this->comp_codes_.size();
+    const char* len_ptr = (const char*)&code_len;
+    this->raw_.insert(this->raw_.end(), len_ptr, len_ptr + sizeof(code_len));
+    this->raw_.insert(this->raw_.end(), this->comp_codes_.begin(),
+                      this->comp_codes_.end());
+    EncodeValues(data.features().begin(), feat_num, this->value_precision_,
+                  this->raw_);
+  }
+
+  if (this->raw_.size() >= this->block_size_) return this->FlushBlock();
+  return Status_OK;
+}
+
+int BlockBinaryWriter::FlushBlock() {
+  if (this->header_.inst_num == 0) return Status_OK;
+
+  int ret = Compress(this->codec_, this->raw_.data(), this->raw_.size(),
+                     this->payload_);
+  if (ret != Status_OK) return ret;
+  this->header_.codec = uint32_t(this->codec_);
+  this->header_.raw_len = this->raw_.size();
+  this->header_.payload_len = this->payload_.size();
+  this->header_.checksum = Crc32(this->payload_.data(), this->payload_.size());
+
+  char buf[BlockHeader::kSize];
+  this->header_.Serialize(buf);
+  ret = this->file_writer_.Write(buf, BlockHeader::kSize);
+  if (ret == Status_OK) {
+    ret = this->file_writer_.Write(this->payload_.data(),
+                                   this->payload_.size());
+  }
+  if (ret != Status_OK) return ret;
+
+  this->block_offsets_.push_back(this->offset_);
+  this->block_first_insts_.push_back(this->inst_num_);
+  this->offset_ += BlockHeader::kSize + this->payload_.size();
+  this->inst_num_ += this->header_.inst_num;
+  this->raw_.clear();
+  this->header_.Clear();
+  return Status_OK;
+}
+
+int BlockBinaryWriter::SetExtraInfo(const char* extra_info) {
+  vector<string> options = split(extra_info, ',');
+  for (const string& option : options) {
+    if (option.empty()) continue;
+    vector<string> kv = split(option, '=');
+    if (kv.size() == 2 && kv[0] == "codec") {
+      int codec = kv[1] == "none" ? kCodecNone
+                                  : (kv[1] == "zlib" ? kCodecZlib : -1);
+      if (this->set_codec(codec) != Status_OK) return Status_Invalid_Argument;
+    } else if (kv.size() == 2 && kv[0] == "index_codec") {
+      const IndexCodec* index_codec = IndexCodec::Get(kv[1]);
+      if (index_codec == nullptr ||
+          this->set_index_codec(index_codec->type()) != Status_OK) {
+        fprintf(stderr, "unknown index codec (%s)\n", kv[1].c_str());
+        return Status_Invalid_Argument;
+      }
+    } else if (kv.size() == 2 && kv[0] == "values") {
+      const char* names[] = {"lossless", "fp16", "bf16", "int8"};
+      int precision = -1;
+      for (int i = 0; i < 4; ++i) {
+        if (kv[1] == names[i]) precision = i;
+      }
+      if (precision < 0) {
+        fprintf(stderr, "unknown value precision (%s)\n", kv[1].c_str());
+        return Status_Invalid_Argument;
+      }
+      this->value_precision_ = precision;
+    } else if (kv.size() == 2 && kv[0] == "block_size") {
+      this->set_block_size(size_t(strtoull(kv[1].c_str(), nullptr, 10)));
+    } else {
+      fprintf(stderr, "unknown option (%s) of the bin2 format\n",
+              option.c_str());
+      return Status_Invalid_Argument;
+    }
+  }
+  return Status_OK;
+}
+
+int BlockBinaryWriter::set_codec(int codec) {
+  if (CodecSupported(codec) == false) {
+    fprintf(stderr, "codec %d of the bin2 format is not supported\n", codec);
+    return Status_Invalid_Argument;
+  }
+  this->codec_ = codec;
+  return Status_OK;
+}
+
+int BlockBinaryWriter::set_index_codec(int index_codec) {
+  const IndexCodec* codec = IndexCodec::Get(index_codec);
+  if (codec == nullptr || this->opened_) {
+    fprintf(stderr, "index codec %d can not be set\n", index_codec);
+    return Status_Invalid_Argument;
+  }
+  this->index_codec_ = codec;
+  return Status_OK;
+}
+
+RegisterDataWriter(BlockBinaryWriter, "bin2",
+                   "block binary format (v2) data writer");
+
+}  // namespace pario
+}  // namespace sol
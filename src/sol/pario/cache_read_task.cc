@@ -0,0 +1,245 @@
+/*********************************************************************************
+*     File Name           :     cache_read_task.cc
+*     Created By          :     yuewu
+*     Description         :     Thread task to read a data once and serve the
+*                                 later passes from a cache
+**********************************************************************************/
+
+#include "sol/pario/cache_read_task.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <random>
+
+#include "sol/util/util.h"
+#include "sol/util/error_code.h"
+
+using namespace std;
+
+namespace sol {
+namespace pario {
+
+CacheReadTask::CacheReadTask(const std::string& path, const std::string& dtype,
+                             MiniBatchQueue& mini_batch_factory,
+                             MiniBatchQueue& mini_batch_buf,
+                             int pass_num, bool shuffle, size_t max_cache_size,
+                             const std::string& cache_path)
+    : mini_batch_factory_(mini_batch_factory),
+      mini_batch_buf_(mini_batch_buf),
+      pass_num_(pass_num),
+      shuffle_(shuffle),
+      max_cache_size_(max_cache_size),
+      cache_path_(cache_path),
+      cached_(pass_num > 1),
+      spilled_(false) {
+  DataReader* reader = DataReader::Create(dtype);
+  if (reader != nullptr) {
+    if (reader->Open(path) != Status_OK) {
+      delete reader;
+      reader = nullptr;
+    }
+  }
+  this->reader_.reset(reader);
+  this->offsets_.push_back(0);
+}
+
+CacheReadTask::~CacheReadTask() {
+  if (this->spilled_) remove(this->cache_path_.c_str());
+}
+
+size_t CacheReadTask::cache_size() const {
+  return this->labels_.size() * sizeof(label_t) +
+         this->offsets_.size() * sizeof(size_t) +
+         this->indexes_.size() * sizeof(index_t) +
+         this->features_.size() * sizeof(real_t);
+}
+
+void CacheReadTask::run() {
+  int status = this->ReadFirstPass();
+  for (int pass = 1; pass < this->pass_num_ && status == Status_OK; ++pass) {
+    if (this->cached_ && this->spilled_ == false) {
+      status = this->ReadCache(pass);
+    } else {
+      status = this->ReadPass();
+    }
+  }
+  this->reader_->Close();
+  this->mini_batch_buf_.Enqueue(nullptr);
+}
+
+int CacheReadTask::ReadFirstPass() {
+  int status = Status_OK;
+  while (status == Status_OK) {
+    MiniBatch* mini_batch = this->NewMiniBatch();
+    if (mini_batch == nullptr) return Status_Error;  // exit signal
+    while (mini_batch->size() < mini_batch->capacity()) {
+      status = this->reader_->Next(mini_batch->NextPoint());
+      if (status != Status_OK) break;
+      mini_batch->PushPoint();
+      if (this->cached_) {
+        this->CachePoint((*mini_batch)[mini_batch->size() - 1]);
+      }
+    }
+    this->mini_batch_buf_.Enqueue(mini_batch);
+  }
+  if (status != Status_EndOfFile) return status;
+
+  if (this->spilled_) {
+    // later passes read the spilled binary file
+    bool good = this->spill_writer_->Good();
+    this->spill_writer_->Close();
+    this->spill_writer_.reset();
+    DataReader* reader = DataReader::Create("bin");
+    if (good == false || reader == nullptr ||
+        reader->Open(this->cache_path_, "rb") != Status_OK) {
+      fprintf(stderr, "open spilled cache (%s) failed\n",
+              this->cache_path_.c_str());
+      DeletePointer(reader);
+      return Status_IO_Error;
+    }
+    this->reader_->Close();
+    this->reader_.reset(reader);
+  } else {
+    this->reader_->Rewind();
+  }
+  return Status_OK;
+}
+
+int CacheReadTask::ReadCache(int pass) {
+  size_t data_num = this->labels_.size();
+  vector<size_t> order;
+  if (this->shuffle_) {
+    order.resize(data_num);
+    for (size_t i = 0; i < data_num; ++i) order[i] = i;
+    random_device rd;
+    mt19937 g(rd());
+    std::shuffle(order.begin(), order.end(), g);
+  }
+
+  size_t i = 0;
+  while (i < data_num) {
+    MiniBatch* mini_batch = this->NewMiniBatch();
+    if (mini_batch == nullptr) return Status_Error;  // exit signal
+    for (; i < data_num && mini_batch->size() < mini_batch->capacity(); ++i) {
+      size_t idx = this->shuffle_ ? order[i] : i;
+      size_t offset = this->offsets_[idx];
+      size_t feat_num = this->offsets_[idx + 1] - offset;
+      DataPoint& pt = mini_batch->NextPoint();
+      pt.set_label(this->labels_[idx]);
+      pt.Resize(feat_num);
+      memcpy(pt.indexes().begin(), this->indexes_.data() + offset,
+             feat_num * sizeof(index_t));
+      memcpy(pt.features().begin(), this->features_.data() + offset,
+             feat_num * sizeof(real_t));
+      mini_batch->PushPoint();
+    }
+    this->mini_batch_buf_.Enqueue(mini_batch);
+  }
+  return Status_OK;
+}
+
+int CacheReadTask::ReadPass() {
+  int status = Status_OK;
+  while (status == Status_OK) {
+    MiniBatch* mini_batch = this->NewMiniBatch();
+    if (mini_batch == nullptr) return Status_Error;  // exit signal
+    while (mini_batch->size() < mini_batch->capacity()) {
+      status = this->reader_->Next(mini_batch->NextPoint());
+      if (status != Status_OK) break;
+      mini_batch->PushPoint();
+    }
+    this->mini_batch_buf_.Enqueue(mini_batch);
+  }
+  if (status != Status_EndOfFile) return status;
+  this->reader_->Rewind();
+  return Status_OK;
+}
+
+void CacheReadTask::CachePoint(const DataPoint& pt) {
+  if (this->spilled_) {
+    if (this->spill_writer_->Write(pt) != Status_OK) this->DropCache();
+    return;
+  }
+
+  this->labels_.push_back(pt.label());
+  this->indexes_.insert(this->indexes_.end(), pt.indexes().begin(),
+                        pt.indexes().end());
+  this->features_.insert(this->features_.end(), pt.features().begin(),
+                         pt.features().end());
+  this->offsets_.push_back(this->indexes_.size());
+
+  if (this->max_cache_size_ > 0 &&
+      this->cache_size() > this->max_cache_size_) {
+    if (this->cache_path_.empty() || this->Spill() != Status_OK) {
+      fprintf(stderr,
+              "warning: data cache exceeds %llu bytes, the data is parsed "
+              "again in each pass\n",
+              (unsigned long long)this->max_cache_size_);
+      this->DropCache();
+    }
+  }
+}
+
+int CacheReadTask::Spill() {
+  DataWriter* writer = DataWriter::Create("bin");
+  if (writer == nullptr || writer->Open(this->cache_path_, "wb") != Status_OK) {
+    fprintf(stderr, "open cache file (%s) failed\n", this->cache_path_.c_str());
+    DeletePointer(writer);
+    return Status_IO_Error;
+  }
+  this->spill_writer_.reset(writer);
+  this->spilled_ = true;
+
+  DataPoint pt;
+  size_t data_num = this->labels_.size();
+  for (size_t i = 0; i < data_num; ++i) {
+    size_t offset = this->offsets_[i];
+    size_t feat_num = this->offsets_[i + 1] - offset;
+    pt.set_label(this->labels_[i]);
+    pt.Resize(feat_num);
+    memcpy(pt.indexes().begin(), this->indexes_.data() + offset,
+           feat_num * sizeof(index_t));
+    memcpy(pt.features().begin(), this->features_.data() + offset,
+           feat_num * sizeof(real_t));
+    if (writer->Write(pt) != Status_OK) return Status_IO_Error;
+  }
+  if (this->shuffle_) {
+    fprintf(stderr,
+            "warning: data cache is spilled to %s, the data is not shuffled\n",
+            this->cache_path_.c_str());
+  }
+
+  // release the in-memory cache
+  vector<label_t>().swap(this->labels_);
+  vector<size_t>().swap(this->offsets_);
+  vector<index_t>().swap(this->indexes_);
+  vector<real_t>().swap(this->features_);
+  return Status_OK;
+}
+
+void CacheReadTask::DropCache() {
+  if (this->spilled_) {
+    this->spill_writer_.reset();
+    remove(this->cache_path_.c_str());
+    this->spilled_ = false;
+  }
+  this->cached_ = false;
+  vector<label_t>().swap(this->labels_);
+  vector<size_t>().swap(this->offsets_);
+  vector<index_t>().swap(this->indexes_);
+  vector<real_t>().swap(this->features_);
+}
+
+MiniBatch* CacheReadTask::NewMiniBatch() {
+  MiniBatch* mini_batch = this->mini_batch_factory_.Dequeue();
+  if (mini_batch == nullptr) {  // exit signal
+    this->mini_batch_factory_.Enqueue(nullptr);
+  } else {
+    mini_batch->Clear();
+  }
+  return mini_batch;
+}
+
+}  // namespace pario
+}  // namespace sol
@@ -27,12 +27,14 @@ int CSVReader::Open(const std::string& path, const char* mode) {
 
 void CSVReader::Rewind() {
   DataFileReader::Rewind();
-  // read the first line for csv
-  this->file_reader_.ReadLine(this->read_buf_, this->read_buf_size_);
+  // skip the first line for csv
+  if (this->range_begin_ == 0) {
+    this->file_reader_.ReadLine(this->read_buf_, this->read_len_);
+  }
 }
 
 int CSVReader::Next(DataPoint& dst_data) {
-  int ret = this->file_reader_.ReadLine(this->read_buf_, this->read_buf_size_);
+  int ret = this->ReadLine();
   if (ret != Status_OK) return ret;
 
   char* iter = this->read_buf_, *endptr = nullptr;
@@ -43,7 +45,7 @@ int CSVReader::Next(DataPoint& dst_data) {
 
   dst_data.Clear();
   // 1. parse label
-  dst_data.set_label(label_t(NumericParser::ParseInt(iter, endptr)));
+  dst_data.set_label(label_t(NumericParser::ParseIntFast(iter, endptr)));
   if (endptr == iter) {
     fprintf(stderr, "parse label failed.\n");
     this->is_good_ = false;
@@ -62,7 +64,7 @@ int CSVReader::Next(DataPoint& dst_data) {
     }
     ++iter;
 
-    real_t feat = NumericParser::ParseFloat(iter, endptr);
+    real_t feat = NumericParser::ParseFloatFast(iter, endptr);
     if (endptr == iter) {
       fprintf(stderr, "parse feature value (%s) failed!\n", iter);
       this->is_good_ = false;
@@ -80,7 +82,7 @@ int CSVReader::Next(DataPoint& dst_data) {
 }
 
 int CSVReader::LoadFeatDim() {
-  int ret = this->file_reader_.ReadLine(this->read_buf_, this->read_buf_size_);
+  int ret = this->file_reader_.ReadLine(this->read_buf_, this->read_len_);
   if (ret != Status_OK) return ret;
   char* p = this->read_buf_;
   this->feat_dim_ = 0;
@@ -8,6 +8,7 @@
 
 #include "sol/pario/data_iter.h"
 #include "sol/util/util.h"
+#include "sol/util/profiler.h"
 
 using namespace std;
 
@@ -16,17 +17,24 @@ namespace pario {
 DataIter::DataIter(int batch_size, int batch_num)
     : batch_size_(batch_size),
       mini_batch_factory_(batch_num),
-      mini_batch_buf_(batch_num) {
+      // the loaded mini-batches are only read by Next
+      mini_batch_buf_(batch_num, false, true) {
   for (int i = 0; i < batch_num; ++i) {
     this->mini_batch_factory_.Enqueue(new MiniBatch(batch_size));
   }
   // signal to start next reader
   this->mini_batch_buf_.Enqueue(nullptr);
-  this->running_reader_idx_ = -1;
+  this->next_reader_idx_ = 0;
+  this->running_reader_num_ = 0;
+  this->max_running_reader_num_ = 1;
+  this->cur_batch_ = nullptr;
+  this->read_end_ = false;
 }
 
 DataIter::~DataIter() {
-  MiniBatch* mb = nullptr;
+  // the iteration is stopped before the end of data
+  MiniBatch* mb = this->cur_batch_.exchange(nullptr);
+  DeletePointer(mb);
   // clear mini_batch_factory_
   while (this->mini_batch_factory_.size() > 0) {
     mb = this->mini_batch_factory_.Dequeue();
@@ -36,22 +44,24 @@ DataIter::~DataIter() {
   // send exit signal to readers
   this->mini_batch_factory_.Enqueue(mb);
 
-  // clear mini_batch_buf_
-  int reader_count = static_cast<int>(this->readers_.size());
-  while (this->running_reader_idx_ < reader_count) {
+  // clear mini_batch_buf_ until all running readers exit, readers not
+  // started yet are dropped
+  while (this->running_reader_num_ > 0) {
     mb = this->mini_batch_buf_.Dequeue();
     if (mb == nullptr) {
-      ++this->running_reader_idx_;
-      if (this->running_reader_idx_ < reader_count) {
-        this->readers_[this->running_reader_idx_]->Start();
-      }
+      --this->running_reader_num_;
     } else {
       DeletePointer(mb);
     }
   }
+  // signal of the idle iterator
+  while (this->mini_batch_buf_.size() > 0) {
+    mb = this->mini_batch_buf_.Dequeue();
+    DeletePointer(mb);
+  }
 
   // wait all data readers to exit
-  for (shared_ptr<DataReadTask>& reader : this->readers_) {
+  for (shared_ptr<ThreadTask>& reader : this->readers_) {
     reader->Join();
   }
 
@@ -63,11 +73,37 @@ DataIter::~DataIter() {
 }
 
 int DataIter::AddReader(const std::string& path, const std::string& dtype,
-                        int pass_num) {
+                        int pass_num, int thread_num, bool keep_order) {
   int ret = Status_OK;
-  shared_ptr<DataReadTask> reader(new DataReadTask(
-      path, dtype, this->mini_batch_factory_, this->mini_batch_buf_, pass_num));
-  if (reader->Good()) {
+  shared_ptr<ThreadTask> reader;
+  bool good = false;
+  // compressed files can not be split into blocks, they are parsed by one
+  // thread while decompressed by another
+  if (thread_num > 1 && FileReader(path.c_str(), "r").IsCompressed()) {
+    thread_num = 1;
+  }
+  // binary formats can not be split into blocks either
+  if (thread_num > 1) {
+    unique_ptr<DataReader> probe(DataReader::Create(dtype));
+    if (probe != nullptr && probe->Open(path) == Status_OK &&
+        probe->SupportRange() == false) {
+      thread_num = 1;
+    }
+  }
+  if (thread_num > 1) {
+    ParallelReadTask* task = new ParallelReadTask(
+        path, dtype, this->mini_batch_factory_, this->mini_batch_buf_,
+        pass_num, thread_num, keep_order, this->batch_size_);
+    reader.reset(task);
+    good = task->Good();
+  } else {
+    DataReadTask* task =
+        new DataReadTask(path, dtype, this->mini_batch_factory_,
+                         this->mini_batch_buf_, pass_num);
+    reader.reset(task);
+    good = task->Good();
+  }
+  if (good) {
     this->readers_.push_back(reader);
   } else {
     ret = Status_Invalid_Argument;
@@ -77,26 +113,130 @@ int DataIter::AddReader(const std::string& path, const std::string& dtype,
   return ret;
 }
 
+int DataIter::AddReader(DataReader* reader, int pass_num) {
+  if (reader == nullptr) {
+    fprintf(stderr, "add reader failed: reader is empty\n");
+    return Status_Invalid_Argument;
+  }
+  this->readers_.push_back(make_shared<DataReadTask>(
+      reader, this->mini_batch_factory_, this->mini_batch_buf_, pass_num));
+  return Status_OK;
+}
+
+int DataIter::AddCachedReader(const std::string& path, const std::string& dtype,
+                              int pass_num, bool shuffle,
+                              size_t max_cache_size,
+                              const std::string& cache_path) {
+  CacheReadTask* task = new CacheReadTask(
+      path, dtype, this->mini_batch_factory_, this->mini_batch_buf_, pass_num,
+      shuffle, max_cache_size, cache_path);
+  shared_ptr<ThreadTask> reader(task);
+  if (task->Good() == false) {
+    fprintf(stderr, "add reader (type: %s, path: %s) failed\n", dtype.c_str(),
+            path.c_str());
+    return Status_Invalid_Argument;
+  }
+  this->readers_.push_back(reader);
+  return Status_OK;
+}
+
 MiniBatch* DataIter::Next(MiniBatch* prev_batch) {
+  if (this->shuffle_buf_ != nullptr) return this->ShuffleNext(prev_batch);
+  return this->ReadNext(prev_batch);
+}
+
+MiniBatch* DataIter::ReadNext(MiniBatch* prev_batch) {
   if (prev_batch != nullptr) {
     this->mini_batch_factory_.Enqueue(prev_batch);
   }
   MiniBatch* el = nullptr;
   do {
-    el = this->mini_batch_buf_.Dequeue();
+    {
+      ProfileScope scope(kStageWait);
+      el = this->mini_batch_buf_.Dequeue();
+    }
     if (el == nullptr) {
-      if (this->running_reader_idx_ + 1 <
-          static_cast<int>(this->readers_.size())) {
-        ++this->running_reader_idx_;
-        this->readers_[this->running_reader_idx_]->Start();
-      } else {
+      // a reader exits, or the signal to start readers
+      if (this->running_reader_num_ > 0) --this->running_reader_num_;
+      this->StartReaders();
+      if (this->running_reader_num_ == 0) {
         this->mini_batch_buf_.Enqueue(nullptr);
         break;
       }
     }
   } while (el == nullptr);
+  this->cur_batch_ = el;
   return el;
 }
 
+void DataIter::Recycle(MiniBatch* batch) {
+  if (batch == nullptr) return;
+  MiniBatch* expected = batch;
+  this->cur_batch_.compare_exchange_strong(expected, nullptr);
+  this->mini_batch_factory_.Enqueue(batch);
+}
+
+void DataIter::set_max_running_reader_num(int num) {
+  this->max_running_reader_num_ = num > 1 ? num : 1;
+}
+
+MiniBatch* DataIter::ShuffleNext(MiniBatch* prev_batch) {
+  ShuffleBuffer& buf = *this->shuffle_buf_;
+  // refill the window, the last loaded mini-batch is reused for output; the
+  // mini-batches are pushed as a whole, which overshoots the window by up to
+  // batch_size - 1 points, but keeps a free mini-batch for the output without
+  // holding a partly pushed one back from the readers
+  MiniBatch* mb = nullptr;
+  while (this->read_end_ == false && buf.full() == false) {
+    MiniBatch* loaded = this->ReadNext(prev_batch);
+    prev_batch = nullptr;
+    if (loaded == nullptr) {
+      this->read_end_ = true;
+      break;
+    }
+    for (int i = 0; i < loaded->size(); ++i) buf.Push((*loaded)[i]);
+    if (mb != nullptr) this->Recycle(mb);
+    mb = loaded;
+  }
+  if (prev_batch != nullptr) {
+    if (mb == nullptr) {
+      mb = prev_batch;
+    } else {
+      this->Recycle(prev_batch);
+    }
+  }
+
+  if (buf.size() == 0) {
+    this->Recycle(mb);
+    this->cur_batch_ = nullptr;
+    return nullptr;
+  }
+  if (mb == nullptr) mb = this->mini_batch_factory_.Dequeue();
+  mb->Clear();
+  while (mb->size() < mb->capacity() && buf.size() > 0) {
+    buf.Pop(mb->NextPoint());
+    mb->PushPoint();
+  }
+  this->cur_batch_ = mb;
+  return mb;
+}
+
+void DataIter::set_shuffle_window(size_t window_size, unsigned int seed) {
+  if (window_size == 0) {
+    this->shuffle_buf_.reset();
+  } else {
+    this->shuffle_buf_.reset(new ShuffleBuffer(window_size, seed));
+  }
+}
+
+void DataIter::StartReaders() {
+  int reader_count = static_cast<int>(this->readers_.size());
+  while (this->running_reader_num_ < this->max_running_reader_num_ &&
+         this->next_reader_idx_ < reader_count) {
+    this->readers_[this->next_reader_idx_++]->Start();
+    ++this->running_reader_num_;
+  }
+}
+
 }  // namespace pario
 }  // namespace sol
@@ -40,6 +40,11 @@ void DataPoint::Clear() {
   this->label_ = 0;
 }
 
+void DataPoint::Attach(index_t *indexes, real_t *features, size_t capacity) {
+  this->data_.attach(indexes, features, capacity);
+  this->label_ = 0;
+}
+
 bool DataPoint::IsSorted() const {
   for (auto iter = this->indexes().begin() + 1; iter < this->indexes().end();
        ++iter) {
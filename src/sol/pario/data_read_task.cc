@@ -8,12 +8,13 @@
 
 #include "sol/pario/data_read_task.h"
 #include "sol/util/error_code.h"
+#include "sol/util/profiler.h"
 
 namespace sol {
 namespace pario {
 DataReadTask::DataReadTask(const std::string& path, const std::string& dtype,
-                           BlockQueue<MiniBatch*>& mini_batch_factory,
-                           BlockQueue<MiniBatch*>& mini_batch_buf, int pass_num)
+                           MiniBatchQueue& mini_batch_factory,
+                           MiniBatchQueue& mini_batch_buf, int pass_num)
     : mini_batch_factory_(mini_batch_factory),
       mini_batch_buf_(mini_batch_buf),
       pass_num_(pass_num) {
@@ -27,6 +28,14 @@ DataReadTask::DataReadTask(const std::string& path, const std::string& dtype,
   this->reader_.reset(reader);
 }
 
+DataReadTask::DataReadTask(DataReader* reader,
+                           MiniBatchQueue& mini_batch_factory,
+                           MiniBatchQueue& mini_batch_buf, int pass_num)
+    : reader_(reader),
+      mini_batch_factory_(mini_batch_factory),
+      mini_batch_buf_(mini_batch_buf),
+      pass_num_(pass_num) {}
+
 void DataReadTask::run() {
   int status = Status_OK;
   DataReader* reader = this->reader_.get();
@@ -36,12 +45,15 @@ void DataReadTask::run() {
       this->mini_batch_factory_.Enqueue(nullptr);
       break;
     }
-    mini_batch->data_num = 0;
-    while (mini_batch->data_num < mini_batch->capacity() &&
+    mini_batch->Clear();
+    while (mini_batch->size() < mini_batch->capacity() &&
            status == Status_OK) {
-      status = reader->Next((*mini_batch)[mini_batch->data_num]);
+      {
+        ProfileScope scope(kStageRead);
+        status = reader->Next(mini_batch->NextPoint());
+      }
       if (status == Status_OK) {
-        ++mini_batch->data_num;
+        mini_batch->PushPoint();
         continue;
       } else if (status == Status_EndOfFile) {
         --this->pass_num_;
@@ -25,27 +25,64 @@ DataReader* DataReader::Create(const std::string& type) {
 DataReader::DataReader() {}
 DataReader::~DataReader() {}
 
+int DataReader::SetRange(int64_t begin, int64_t end) {
+  fprintf(stderr, "reading by byte range is not supported by the reader\n");
+  return Status_Invalid_Argument;
+}
+
 DataFileReader::DataFileReader() {
-  this->read_buf_size_ = 4096;
-  this->read_buf_ = (char*)malloc(this->read_buf_size_ * sizeof(char));
+  this->read_buf_ = nullptr;
+  this->read_len_ = 0;
   this->is_good_ = true;
+  this->range_begin_ = 0;
+  this->range_end_ = -1;
 }
 
-DataFileReader::~DataFileReader() {
-  this->Close();
-  if (this->read_buf_ != nullptr) {
-    free(this->read_buf_);
-  }
-}
+DataFileReader::~DataFileReader() { this->Close(); }
 
 int DataFileReader::Open(const string& path, const char* mode) {
   this->Close();
   this->file_path_ = path;
+  this->range_begin_ = 0;
+  this->range_end_ = -1;
   int ret = this->file_reader_.Open(path.c_str(), mode);
   this->is_good_ = ret == Status_OK ? true : false;
 
   return ret;
 }
 
+void DataFileReader::Rewind() {
+  if (this->range_begin_ == 0) {
+    this->file_reader_.Rewind();
+  } else if (this->file_reader_.Seek(this->range_begin_ - 1) == Status_OK) {
+    // the line containing range_begin_ - 1 belongs to the previous range
+    this->file_reader_.ReadLine(this->read_buf_, this->read_len_);
+  }
+}
+
+int DataFileReader::SetRange(int64_t begin, int64_t end) {
+  if (this->file_reader_.IsText() == false) {
+    fprintf(stderr, "only text data can be read by byte range\n");
+    return Status_Invalid_Argument;
+  }
+  if (begin < 0 || (end >= 0 && end < begin)) {
+    fprintf(stderr, "invalid byte range [%lld, %lld)\n", (long long)begin,
+            (long long)end);
+    return Status_Invalid_Argument;
+  }
+  this->range_begin_ = begin;
+  this->range_end_ = end;
+  this->Rewind();
+  return this->file_reader_.Good() ? Status_OK : Status_IO_Error;
+}
+
+int DataFileReader::ReadLine() {
+  if (this->range_end_ >= 0 &&
+      this->file_reader_.Tell() >= this->range_end_) {
+    return Status_EndOfFile;
+  }
+  return this->file_reader_.ReadLine(this->read_buf_, this->read_len_);
+}
+
 }  // namespace pario
 }  // namespace sol
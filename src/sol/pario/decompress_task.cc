@@ -0,0 +1,315 @@
+/*********************************************************************************
+*     File Name           :     decompress_task.cc
+*     Created By          :     yuewu
+*     Description         :     Thread task to decompress a gzip or zstd file
+*                                 ahead of the reader
+**********************************************************************************/
+
+#include "sol/pario/decompress_task.h"
+
+#include <cstring>
+#include <algorithm>
+
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#include "sol/util/util.h"
+#include "sol/util/error_code.h"
+
+using namespace std;
+
+namespace sol {
+namespace pario {
+
+// size of the decompressed chunks
+static const size_t kChunkSize = 1 << 20;
+// number of decompressed chunks, the thread is at most kChunkNum chunks ahead
+static const int kChunkNum = 4;
+// size of the compressed data read from the file at a time
+static const size_t kInputSize = 256 << 10;
+
+/// \brief  decompression stream of a file
+class DecompressStream {
+ public:
+  DecompressStream(FILE* file, DecompressTask::Format format)
+      : file_(file),
+        format_(format),
+        good_(false),
+        frame_end_(false),
+        in_buf_(kInputSize),
+        in_pos_(0),
+        in_len_(0) {
+#ifdef HAS_ZLIB
+    if (format == DecompressTask::kGzip) {
+      memset(&this->zs_, 0, sizeof(this->zs_));
+      // 16: decode the gzip header
+      this->good_ = inflateInit2(&this->zs_, 15 + 16) == Z_OK;
+    }
+#endif
+#ifdef HAS_ZSTD
+    if (format == DecompressTask::kZstd) {
+      this->zds_ = ZSTD_createDStream();
+      this->good_ = this->zds_ != nullptr &&
+                    ZSTD_isError(ZSTD_initDStream(this->zds_)) == 0;
+    }
+#endif
+  }
+
+  ~DecompressStream() {
+#ifdef HAS_ZLIB
+    if (this->format_ == DecompressTask::kGzip) inflateEnd(&this->zs_);
+#endif
+#ifdef HAS_ZSTD
+    if (this->format_ == DecompressTask::kZstd && this->zds_ != nullptr) {
+      ZSTD_freeDStream(this->zds_);
+    }
+#endif
+  }
+
+  inline bool Good() const { return this->good_; }
+
+  /// \brief  decompress the file to a buffer
+  ///
+  /// \param dst destination buffer
+  /// \param length length of the buffer
+  /// \param out_len number of decompressed bytes
+  ///
+  /// \return Status_OK if the buffer is full, Status_EndOfFile at the end of
+  /// file, error code otherwise
+  int Read(char* dst, size_t length, size_t& out_len) {
+    out_len = 0;
+    while (out_len < length) {
+      if (this->in_pos_ == this->in_len_) {
+        this->in_pos_ = 0;
+        this->in_len_ =
+            fread(this->in_buf_.data(), 1, this->in_buf_.size(), this->file_);
+        if (this->in_len_ == 0) {
+          if (ferror(this->file_) != 0) {
+            fprintf(stderr, "Error %d: read compressed file failed\n",
+                    Status_IO_Error);
+            return Status_IO_Error;
+          }
+          if (this->frame_end_ == false) {
+            fprintf(stderr, "Error %d: unexpected end of compressed file\n",
+                    Status_Invalid_Format);
+            return Status_Invalid_Format;
+          }
+          return Status_EndOfFile;
+        }
+      }
+      int ret = this->Decompress(dst, length, out_len);
+      if (ret != Status_OK) return ret;
+    }
+    return Status_OK;
+  }
+
+ protected:
+  /// \brief  decompress the buffered input to dst + out_len
+  int Decompress(char* dst, size_t length, size_t& out_len) {
+    char* in = this->in_buf_.data() + this->in_pos_;
+    size_t in_len = this->in_len_ - this->in_pos_;
+#ifdef HAS_ZLIB
+    if (this->format_ == DecompressTask::kGzip) {
+      // concatenated gzip members, like the outputs of pigz
+      if (this->frame_end_) inflateReset(&this->zs_);
+      this->zs_.next_in = (Bytef*)in;
+      this->zs_.avail_in = uInt(in_len);
+      this->zs_.next_out = (Bytef*)(dst + out_len);
+      this->zs_.avail_out = uInt(length - out_len);
+      int ret = inflate(&this->zs_, Z_NO_FLUSH);
+      this->in_pos_ = this->in_len_ - this->zs_.avail_in;
+      out_len = length - this->zs_.avail_out;
+      if (ret != Z_OK && ret != Z_STREAM_END) {
+        fprintf(stderr, "Error %d: decompress gzip data failed (%s)\n",
+                Status_Invalid_Format,
+                this->zs_.msg != nullptr ? this->zs_.msg : "unknown error");
+        return Status_Invalid_Format;
+      }
+      this->frame_end_ = ret == Z_STREAM_END;
+      return Status_OK;
+    }
+#endif
+#ifdef HAS_ZSTD
+    if (this->format_ == DecompressTask::kZstd) {
+      ZSTD_inBuffer input = {in, in_len, 0};
+      ZSTD_outBuffer output = {dst, length, out_len};
+      size_t ret = ZSTD_decompressStream(this->zds_, &output, &input);
+      this->in_pos_ += input.pos;
+      out_len = output.pos;
+      if (ZSTD_isError(ret)) {
+        fprintf(stderr, "Error %d: decompress zstd data failed (%s)\n",
+                Status_Invalid_Format, ZSTD_getErrorName(ret));
+        return Status_Invalid_Format;
+      }
+      // a frame is completely decoded and flushed
+      this->frame_end_ = ret == 0;
+      return Status_OK;
+    }
+#endif
+    (void)in;
+    (void)in_len;
+    (void)dst;
+    return Status_Invalid_Argument;
+  }
+
+ protected:
+  FILE* file_;
+  DecompressTask::Format format_;
+  bool good_;
+  // the input decoded so far ends at the end of a gzip member or zstd frame
+  bool frame_end_;
+  std::vector<char> in_buf_;
+  size_t in_pos_;
+  size_t in_len_;
+#ifdef HAS_ZLIB
+  z_stream zs_;
+#endif
+#ifdef HAS_ZSTD
+  ZSTD_DStream* zds_;
+#endif
+};
+
+DecompressTask::Format DecompressTask::Detect(FILE* file) {
+  // the magic bytes can not be put back to pipes
+  if (file == nullptr || seek_file(file, 0, SEEK_SET) != 0) return kNone;
+  unsigned char magic[4] = {0, 0, 0, 0};
+  size_t len = fread(magic, 1, sizeof(magic), file);
+  rewind(file);
+  if (len >= 3 && magic[0] == 0x1F && magic[1] == 0x8B && magic[2] == 0x08) {
+    return kGzip;
+  } else if (len == 4 && magic[0] == 0x28 && magic[1] == 0xB5 &&
+             magic[2] == 0x2F && magic[3] == 0xFD) {
+    return kZstd;
+  }
+  return kNone;
+}
+
+const char* DecompressTask::FormatName(Format format) {
+  switch (format) {
+    case kGzip:
+      return "gzip";
+    case kZstd:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+bool DecompressTask::Supported(Format format) {
+  switch (format) {
+    case kNone:
+      return true;
+#ifdef HAS_ZLIB
+    case kGzip:
+      return true;
+#endif
+#ifdef HAS_ZSTD
+    case kZstd:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+DecompressTask::DecompressTask(FILE* file, Format format)
+    : file_(file),
+      format_(format),
+      free_chunks_(kChunkNum + 1),
+      full_chunks_(kChunkNum + 1),
+      cur_chunk_(nullptr),
+      cur_pos_(0),
+      ended_(false),
+      failed_(false) {
+  for (int i = 0; i < kChunkNum; ++i) {
+    Chunk* chunk = new Chunk;
+    chunk->data.resize(kChunkSize);
+    chunk->len = 0;
+    this->chunks_.emplace_back(chunk);
+    this->free_chunks_.Enqueue(chunk);
+  }
+}
+
+DecompressTask::~DecompressTask() { this->Stop(); }
+
+void DecompressTask::run() {
+  DecompressStream stream(this->file_, this->format_);
+  if (stream.Good() == false) {
+    fprintf(stderr, "Error %d: initialize %s decompression failed\n",
+            Status_Error, FormatName(this->format_));
+    this->failed_ = true;
+    this->full_chunks_.Enqueue(nullptr);
+    return;
+  }
+
+  int ret = Status_OK;
+  while (ret == Status_OK) {
+    Chunk* chunk = this->free_chunks_.Dequeue();
+    if (chunk == nullptr) return;  // exit signal
+    ret = stream.Read(chunk->data.data(), chunk->data.size(), chunk->len);
+    if (chunk->len > 0) {
+      this->full_chunks_.Enqueue(chunk);
+    } else {
+      this->free_chunks_.Enqueue(chunk);
+    }
+  }
+  if (ret != Status_EndOfFile) this->failed_ = true;
+  this->full_chunks_.Enqueue(nullptr);
+}
+
+size_t DecompressTask::Read(char* dst, size_t length) {
+  size_t read_len = 0;
+  while (read_len < length) {
+    if (this->cur_chunk_ == nullptr) {
+      if (this->ended_) break;
+      this->cur_chunk_ = this->full_chunks_.Dequeue();
+      this->cur_pos_ = 0;
+      if (this->cur_chunk_ == nullptr) {
+        this->ended_ = true;
+        break;
+      }
+    }
+    size_t copy_len = (std::min)(this->cur_chunk_->len - this->cur_pos_,
+                                 length - read_len);
+    memcpy(dst + read_len, this->cur_chunk_->data.data() + this->cur_pos_,
+           copy_len);
+    this->cur_pos_ += copy_len;
+    read_len += copy_len;
+    if (this->cur_pos_ == this->cur_chunk_->len) {
+      this->free_chunks_.Enqueue(this->cur_chunk_);
+      this->cur_chunk_ = nullptr;
+    }
+  }
+  return read_len;
+}
+
+void DecompressTask::Restart() {
+  this->Stop();
+  rewind(this->file_);
+  this->failed_ = false;
+  this->Start();
+}
+
+void DecompressTask::Stop() {
+  if (this->thread_ == nullptr) return;
+  this->free_chunks_.Enqueue(nullptr);
+  this->Join();
+  this->thread_.reset();
+
+  // return all chunks to the free list
+  while (this->free_chunks_.size() > 0) this->free_chunks_.Dequeue();
+  while (this->full_chunks_.size() > 0) this->full_chunks_.Dequeue();
+  for (unique_ptr<Chunk>& chunk : this->chunks_) {
+    this->free_chunks_.Enqueue(chunk.get());
+  }
+  this->cur_chunk_ = nullptr;
+  this->cur_pos_ = 0;
+  this->ended_ = false;
+}
+
+}  // namespace pario
+}  // namespace sol
@@ -13,22 +13,44 @@
 #include <stdexcept>
 #include <memory>
 #include <iostream>
+#include <algorithm>
 
 #include "sol/util/util.h"
 #include "sol/util/error_code.h"
+#include "sol/pario/numeric_parser.h"
+#include "sol/pario/decompress_task.h"
 
 using namespace std;
 
 namespace sol {
 namespace pario {
 
-FileReader::FileReader() : file_(nullptr), mode_(kUnknown) {}
+// size of the chunks read from the file
+static const size_t kReadChunkSize = 1 << 20;
+
+FileReader::FileReader()
+    : file_(nullptr),
+      mode_(kUnknown),
+      pos_(0),
+      buf_(nullptr),
+      buf_size_(0),
+      buf_begin_(0),
+      buf_end_(0) {}
 FileReader::FileReader(const char* path, const char* mode)
-    : file_(nullptr), mode_(kUnknown) {
+    : file_(nullptr),
+      mode_(kUnknown),
+      pos_(0),
+      buf_(nullptr),
+      buf_size_(0),
+      buf_begin_(0),
+      buf_end_(0) {
   this->Open(path, mode);
 }
 
-FileReader::~FileReader() { this->Close(); }
+FileReader::~FileReader() {
+  this->Close();
+  if (this->buf_ != nullptr) free(this->buf_);
+}
 
 int FileReader::Open(const char* path, const char* mode) {
   this->Close();
@@ -56,32 +78,108 @@ int FileReader::Open(const char* path, const char* mode) {
     return Status_IO_Error;
   }
 
+  DecompressTask::Format format = DecompressTask::Detect(this->file_);
+  if (format != DecompressTask::kNone) {
+    if (DecompressTask::Supported(format) == false) {
+      this->Close();
+      fprintf(stderr,
+              "Error: %s file (%s) is not supported, rebuild with the %s "
+              "library.\n",
+              DecompressTask::FormatName(format), path,
+              format == DecompressTask::kGzip ? "zlib" : "zstd");
+      return Status_Invalid_Argument;
+    }
+    this->decompressor_.reset(new DecompressTask(this->file_, format));
+    this->decompressor_->Start();
+  }
+
   return Status_OK;
 }
 
 void FileReader::Close() {
+  // stop the decompression thread before closing the file
+  this->decompressor_.reset();
   if (this->file_ != nullptr && this->file_ != stdin) {
     fclose(this->file_);
   }
   this->file_ = nullptr;
   this->mode_ = kUnknown;
+  this->pos_ = 0;
+  this->ClearBuffer();
 }
 
 void FileReader::Rewind() {
-  if (this->file_ != nullptr) rewind(this->file_);
+  if (this->decompressor_ != nullptr) {
+    this->decompressor_->Restart();
+  } else if (this->file_ != nullptr) {
+    rewind(this->file_);
+  }
+  this->pos_ = 0;
+  this->ClearBuffer();
+}
+
+int FileReader::Seek(int64_t offset) {
+  if (this->decompressor_ != nullptr && offset == 0) {
+    this->Rewind();
+    return Status_OK;
+  }
+  if (this->file_ == nullptr || this->decompressor_ != nullptr ||
+      this->file_ == stdin || seek_file(this->file_, offset, SEEK_SET) != 0) {
+    fprintf(stderr, "Error %d: seek to %lld failed\n", Status_IO_Error,
+            (long long)offset);
+    return Status_IO_Error;
+  }
+  this->pos_ = offset;
+  this->ClearBuffer();
+  return Status_OK;
+}
+
+int64_t FileReader::Size() {
+  if (this->file_ == nullptr || this->file_ == stdin ||
+      this->decompressor_ != nullptr) {
+    return -1;
+  }
+  // the file position is after the buffered data
+  int64_t file_pos = tell_file(this->file_);
+  int64_t size = -1;
+  if (seek_file(this->file_, 0, SEEK_END) == 0) {
+    size = tell_file(this->file_);
+  }
+  seek_file(this->file_, file_pos, SEEK_SET);
+  return size;
 }
 
 bool FileReader::Good() {
   // we do not need to handle eof here, when eof is set, ferror still returns
   // 0
-  return this->file_ != nullptr && ferror(this->file_) == 0;
+  return this->file_ != nullptr && ferror(this->file_) == 0 &&
+         (this->decompressor_ == nullptr || this->decompressor_->Good());
 }
 
 int FileReader::Read(char* dst, size_t length) {
-  size_t read_len = fread(dst, 1, length, this->file_);
+  size_t read_len = 0;
+  int ret = Status_OK;
+  while (read_len < length) {
+    size_t buf_len = this->buf_end_ - this->buf_begin_;
+    if (buf_len == 0) {
+      // large blocks are read without the buffer
+      if (length - read_len >= kReadChunkSize) {
+        read_len += this->ReadFile(dst + read_len, length - read_len);
+        break;
+      }
+      ret = this->FillBuffer();
+      if (ret != Status_OK) break;
+      continue;
+    }
+    size_t copy_len = (std::min)(buf_len, length - read_len);
+    memcpy(dst + read_len, this->buf_ + this->buf_begin_, copy_len);
+    this->buf_begin_ += copy_len;
+    read_len += copy_len;
+  }
+  this->pos_ += read_len;
   if (read_len == length) {
     return Status_OK;
-  } else if (feof(this->file_)) {
+  } else if (ret != Status_IO_Error && this->Good()) {
     return Status_EndOfFile;
   } else {
     cerr << "Error " << Status_IO_Error << ": only " << read_len
@@ -91,27 +189,104 @@ int FileReader::Read(char* dst, size_t length) {
 }
 
 int FileReader::ReadLine(char*& dst, int& dst_len) {
+  char* line = nullptr;
+  size_t len = 0;
+  int64_t pos = this->pos_;
+  int ret = this->ReadLine(line, len);
+  if (ret != Status_OK) return ret;
+  // keep the newline as fgets
+  bool has_newline = size_t(this->pos_ - pos) > len;
+  if (int(len) + 2 > dst_len) {
+    while (int(len) + 2 > dst_len) dst_len *= 2;
+    dst = (char*)realloc(dst, dst_len);
+  }
+  memcpy(dst, line, len);
+  if (has_newline) dst[len++] = '\n';
+  dst[len] = '\0';
+  return Status_OK;
+}
+
+int FileReader::ReadLine(char*& line, size_t& len) {
   if (this->mode_ != kText) {
     throw logic_error(
         "ReadLine can only be called when only file is opened with `text` "
         "mode.\n");
   }
-  int len(0);
-  if (fgets(dst, dst_len, this->file_) == nullptr) {
-    if (feof(this->file_)) {
-      return Status_EndOfFile;
-    } else {
-      fprintf(stderr, "Error %d: read line failed\n", Status_IO_Error);
+  // offset of the data not searched yet
+  size_t scan_pos = this->buf_begin_;
+  while (true) {
+    // nothing to search before the buffer is filled, buf_ may still be null
+    char* newline = nullptr;
+    if (scan_pos < this->buf_end_) {
+      newline = (char*)memchr(this->buf_ + scan_pos, '\n',
+                              this->buf_end_ - scan_pos);
+    }
+    if (newline != nullptr) {
+      line = this->buf_ + this->buf_begin_;
+      len = size_t(newline - line);
+      *newline = '\0';
+      this->buf_begin_ += len + 1;
+      this->pos_ += len + 1;
+      return Status_OK;
+    }
+
+    size_t searched_len = this->buf_end_ - this->buf_begin_;
+    int ret = this->FillBuffer();
+    if (ret == Status_EndOfFile) {
+      if (this->buf_begin_ == this->buf_end_) return Status_EndOfFile;
+      // the last line without newline
+      line = this->buf_ + this->buf_begin_;
+      len = this->buf_end_ - this->buf_begin_;
+      line[len] = '\0';
+      this->buf_begin_ = this->buf_end_;
+      this->pos_ += len;
+      return Status_OK;
+    } else if (ret != Status_OK) {
+      return ret;
+    }
+    scan_pos = this->buf_begin_ + searched_len;
+  }
+}
+
+int FileReader::FillBuffer() {
+  if (this->file_ == nullptr) return Status_IO_Error;
+  size_t buf_len = this->buf_end_ - this->buf_begin_;
+  if (this->buf_begin_ > 0) {
+    memmove(this->buf_, this->buf_ + this->buf_begin_, buf_len);
+    this->buf_begin_ = 0;
+    this->buf_end_ = buf_len;
+  }
+  if (this->buf_ == nullptr || buf_len == this->buf_size_) {
+    size_t buf_size = (std::max)(kReadChunkSize, this->buf_size_ * 2);
+    // lines are padded for the fast numeric parsers
+    char* buf = (char*)realloc(this->buf_,
+                               buf_size + 1 + NumericParser::kPadding);
+    if (buf == nullptr) {
+      fprintf(stderr, "Error %d: allocate read buffer failed\n",
+              Status_IO_Error);
       return Status_IO_Error;
     }
+    memset(buf + buf_size, 0, 1 + NumericParser::kPadding);
+    this->buf_ = buf;
+    this->buf_size_ = buf_size;
   }
-  while (strrchr(dst, '\n') == nullptr) {
-    dst_len *= 2;
-    dst = (char*)realloc(dst, dst_len);
-    len = int(strlen(dst));
-    if (fgets(dst + len, dst_len - len, this->file_) == nullptr) break;
+
+  size_t read_len = this->ReadFile(this->buf_ + this->buf_end_,
+                                   this->buf_size_ - this->buf_end_);
+  this->buf_end_ += read_len;
+  if (read_len > 0) return Status_OK;
+  if (this->Good() == false) {
+    fprintf(stderr, "Error %d: read file failed\n", Status_IO_Error);
+    return Status_IO_Error;
   }
-  return Status_OK;
+  return Status_EndOfFile;
+}
+
+size_t FileReader::ReadFile(char* dst, size_t length) {
+  if (this->decompressor_ != nullptr) {
+    return this->decompressor_->Read(dst, length);
+  }
+  return fread(dst, 1, length, this->file_);
 }
 
 }  // namespace pario
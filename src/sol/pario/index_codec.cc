@@ -0,0 +1,242 @@
+/*********************************************************************************
+*     File Name           :     index_codec.cc
+*     Created By          :     yuewu
+*     Description         :     codecs of the sorted feature indexes in the
+*                                 binary formats
+**********************************************************************************/
+
+#include "sol/pario/index_codec.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include "sol/pario/compress.h"
+#include "sol/util/error_code.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define SOL_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define SOL_X86_SIMD 0
+#endif
+
+namespace sol {
+namespace pario {
+
+//---------------
+// varint
+// --------------
+
+class VarintIndexCodec : public IndexCodec {
+ public:
+  virtual int type() const { return kIndexCodecVarint; }
+  virtual const char* name() const { return "varint"; }
+
+  virtual int Encode(const index_t* indexes, size_t num,
+                     math::Vector<char>& codes) const {
+    index_t last = 0;
+    for (size_t i = 0; i < num; ++i) {
+      run_len_encode(codes, indexes[i] - last);
+      last = indexes[i];
+    }
+    return Status_OK;
+  }
+
+  virtual int Decode(const char* codes, size_t code_len, index_t* indexes,
+                     size_t num) const {
+    return decomp_index(codes, codes + code_len, indexes, num) == num
+               ? Status_OK
+               : Status_Invalid_Format;
+  }
+};
+
+//---------------
+// stream-vbyte
+// --------------
+
+/// \brief  lookup tables of the control bytes
+struct StreamVByteTables {
+  // number of data bytes of the 4 deltas
+  uint8_t lengths[256];
+  // pshufb masks to expand the data bytes to 4 uint32
+  uint8_t shuffles[256][16];
+
+  StreamVByteTables() {
+    for (int ctrl = 0; ctrl < 256; ++ctrl) {
+      int pos = 0;
+      for (int j = 0; j < 4; ++j) {
+        int len = ((ctrl >> (2 * j)) & 3) + 1;
+        for (int k = 0; k < 4; ++k) {
+          this->shuffles[ctrl][4 * j + k] = uint8_t(k < len ? pos + k : 0x80);
+        }
+        pos += len;
+      }
+      this->lengths[ctrl] = uint8_t(pos);
+    }
+  }
+};
+
+static const StreamVByteTables& svb_tables() {
+  static StreamVByteTables tables;
+  return tables;
+}
+
+/// \brief  decode the first num deltas of a group
+static inline const uint8_t* svb_decode_scalar(const uint8_t* data,
+                                               uint8_t ctrl, size_t num,
+                                               index_t* indexes,
+                                               uint32_t& last) {
+  // small deltas of dense features
+  if (ctrl == 0 && num == 4) {
+    for (size_t j = 0; j < 4; ++j) {
+      last += data[j];
+      indexes[j] = index_t(last);
+    }
+    return data + 4;
+  }
+  for (size_t j = 0; j < num; ++j) {
+    int len = ((ctrl >> (2 * j)) & 3) + 1;
+    uint32_t delta = data[0];
+    if (len > 1) delta |= uint32_t(data[1]) << 8;
+    if (len > 2) delta |= uint32_t(data[2]) << 16;
+    if (len > 3) delta |= uint32_t(data[3]) << 24;
+    data += len;
+    last += delta;
+    indexes[j] = index_t(last);
+  }
+  return data;
+}
+
+#if SOL_X86_SIMD
+/// \brief  decode the full groups while 16 data bytes can be loaded
+///
+/// \return number of decoded groups
+__attribute__((target("ssse3"))) static size_t svb_decode_ssse3(
+    const uint8_t* ctrls, size_t group_num, const uint8_t*& data,
+    const uint8_t* data_end, index_t* indexes, uint32_t& last) {
+  const StreamVByteTables& tables = svb_tables();
+  __m128i prev = _mm_set1_epi32(int(last));
+  size_t g = 0;
+  for (; g < group_num && data + 16 <= data_end; ++g) {
+    uint8_t ctrl = ctrls[g];
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i mask = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(tables.shuffles[ctrl]));
+    __m128i deltas = _mm_shuffle_epi8(bytes, mask);
+    // prefix sum of the 4 deltas
+    deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 4));
+    deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 8));
+    prev = _mm_add_epi32(deltas, prev);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indexes + 4 * g), prev);
+    prev = _mm_shuffle_epi32(prev, 0xFF);
+    data += tables.lengths[ctrl];
+  }
+  last = uint32_t(_mm_cvtsi128_si32(prev));
+  return g;
+}
+
+static bool cpu_has_ssse3() {
+  static bool has_ssse3 = []() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3") != 0;
+  }();
+  return has_ssse3;
+}
+#endif
+
+class StreamVByteIndexCodec : public IndexCodec {
+ public:
+  virtual int type() const { return kIndexCodecStreamVByte; }
+  virtual const char* name() const { return "streamvbyte"; }
+
+  virtual int Encode(const index_t* indexes, size_t num,
+                     math::Vector<char>& codes) const {
+    size_t ctrl_len = (num + 3) / 4;
+    size_t offset = codes.size();
+    codes.resize(offset + ctrl_len + 4 * num);
+    uint8_t* ctrls = (uint8_t*)codes.begin() + offset;
+    uint8_t* data = ctrls + ctrl_len;
+    memset(ctrls, 0, ctrl_len);
+    index_t last = 0;
+    for (size_t i = 0; i < num; ++i) {
+      // unsorted indexes are fine if the wrapped deltas fit in 32 bits
+      if (uint64_t(index_t(indexes[i] - last)) > 0xFFFFFFFFULL) {
+        codes.resize(offset);
+        return Status_Invalid_Argument;
+      }
+      uint32_t delta = uint32_t(indexes[i] - last);
+      last = indexes[i];
+      int len = delta < (1U << 8) ? 1
+                                  : (delta < (1U << 16)
+                                         ? 2
+                                         : (delta < (1U << 24) ? 3 : 4));
+      ctrls[i / 4] |= uint8_t((len - 1) << (2 * (i % 4)));
+      for (int k = 0; k < len; ++k) *data++ = uint8_t(delta >> (8 * k));
+    }
+    codes.resize(size_t((char*)data - codes.begin()));
+    return Status_OK;
+  }
+
+  virtual int Decode(const char* codes, size_t code_len, index_t* indexes,
+                     size_t num) const {
+    const StreamVByteTables& tables = svb_tables();
+    size_t group_num = num / 4;
+    size_t tail_num = num % 4;
+    size_t ctrl_len = group_num + (tail_num > 0 ? 1 : 0);
+    if (code_len < ctrl_len) return Status_Invalid_Format;
+
+    // the data length is checked first, the groups are decoded without
+    // bound checks then
+    const uint8_t* ctrls = (const uint8_t*)codes;
+    size_t data_len = 0;
+    for (size_t g = 0; g < group_num; ++g) {
+      data_len += tables.lengths[ctrls[g]];
+    }
+    for (size_t j = 0; j < tail_num; ++j) {
+      data_len += ((ctrls[group_num] >> (2 * j)) & 3) + 1;
+    }
+    if (ctrl_len + data_len != code_len) return Status_Invalid_Format;
+
+    const uint8_t* data = ctrls + ctrl_len;
+    const uint8_t* data_end = (const uint8_t*)codes + code_len;
+    uint32_t last = 0;
+    size_t g = 0;
+#if SOL_X86_SIMD
+    if (std::is_same<index_t, uint32_t>::value && cpu_has_ssse3()) {
+      g = svb_decode_ssse3(ctrls, group_num, data, data_end, indexes, last);
+    }
+#endif
+    for (; g < group_num; ++g) {
+      data = svb_decode_scalar(data, ctrls[g], 4, indexes + 4 * g, last);
+    }
+    if (tail_num > 0) {
+      data = svb_decode_scalar(data, ctrls[group_num], tail_num,
+                               indexes + 4 * group_num, last);
+    }
+    (void)data_end;
+    return Status_OK;
+  }
+};
+
+const IndexCodec* IndexCodec::Get(int type) {
+  static VarintIndexCodec varint_codec;
+  static StreamVByteIndexCodec svb_codec;
+  switch (type) {
+    case kIndexCodecVarint:
+      return &varint_codec;
+    case kIndexCodecStreamVByte:
+      return &svb_codec;
+    default:
+      return nullptr;
+  }
+}
+
+const IndexCodec* IndexCodec::Get(const std::string& name) {
+  if (name == "varint") return Get(kIndexCodecVarint);
+  if (name == "streamvbyte") return Get(kIndexCodecStreamVByte);
+  return nullptr;
+}
+
+}  // namespace pario
+}  // namespace sol
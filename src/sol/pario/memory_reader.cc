@@ -0,0 +1,179 @@
+/*********************************************************************************
+*     File Name           :     memory_reader.cc
+*     Created By          :     yuewu
+*     Description         :     reader for dense and csr matrices in memory
+**********************************************************************************/
+
+#include "sol/pario/memory_reader.h"
+
+#include <cstdint>
+#include <cstdio>
+
+namespace sol {
+namespace pario {
+
+MemoryReader::MemoryReader()
+    : row_reader_(nullptr),
+      X_(nullptr),
+      cols_(0),
+      row_stride_(0),
+      indptr_(nullptr),
+      indices_(nullptr),
+      values_(nullptr),
+      canonical_(false),
+      Y_(nullptr),
+      y_type_(kMemFloat64),
+      rows_(0),
+      row_(0) {}
+
+int MemoryReader::Open(const std::string& path, const char* mode) {
+  this->row_ = 0;
+  return this->row_reader_ == nullptr ? Status_Invalid_Argument : Status_OK;
+}
+
+/// \brief  read the i-th element of an array of the given type
+inline double ElementAt(const void* data, int type, size_t i) {
+  switch (type) {
+    case kMemFloat32:
+      return double(((const float*)data)[i]);
+    case kMemFloat64:
+      return ((const double*)data)[i];
+    case kMemInt32:
+      return double(((const int32_t*)data)[i]);
+    default:
+      return double(((const int64_t*)data)[i]);
+  }
+}
+
+int MemoryReader::Next(DataPoint& dst_data) {
+  // an empty matrix ends at once, as an empty file
+  if (this->row_ == this->rows_) return Status_EndOfFile;
+  this->row_reader_(*this, this->row_, dst_data);
+  dst_data.set_label(
+      this->Y_ == nullptr
+          ? label_t(0)
+          : label_t(ElementAt(this->Y_, this->y_type_, this->row_)));
+  ++this->row_;
+  return Status_OK;
+}
+
+template <typename XType>
+void MemoryReader::ReadDenseRow(const MemoryReader& reader, size_t row,
+                                DataPoint& dst_data) {
+  const XType* x = (const XType*)(reader.X_ + row * reader.row_stride_);
+  size_t cols = reader.cols_;
+  // write the non-zero features in place and then shrink to their number
+  dst_data.Resize(cols);
+  index_t* indexes = dst_data.indexes().begin();
+  real_t* features = dst_data.features().begin();
+  size_t num = 0;
+  for (size_t j = 0; j < cols; ++j) {
+    if (x[j] != 0) {
+      indexes[num] = index_t(j + 1);
+      features[num] = real_t(x[j]);
+      ++num;
+    }
+  }
+  dst_data.Resize(num);
+}
+
+template <typename PtrType, typename IndexType, typename ValueType>
+void MemoryReader::ReadCsrRow(const MemoryReader& reader, size_t row,
+                              DataPoint& dst_data) {
+  const PtrType* indptr = (const PtrType*)reader.indptr_;
+  size_t begin = size_t(indptr[row] - indptr[0]);
+  size_t num = size_t(indptr[row + 1] - indptr[row]);
+  const IndexType* src_indexes = (const IndexType*)reader.indices_ + begin;
+  const ValueType* src_values = (const ValueType*)reader.values_ + begin;
+
+  dst_data.Resize(num);
+  index_t* indexes = dst_data.indexes().begin();
+  real_t* features = dst_data.features().begin();
+  for (size_t j = 0; j < num; ++j) {
+    indexes[j] = index_t(src_indexes[j] + 1);
+    features[j] = real_t(src_values[j]);
+  }
+  if (reader.canonical_ == false) dst_data.Sort();
+}
+
+inline bool IsFloatType(int type) {
+  return type == kMemFloat32 || type == kMemFloat64;
+}
+inline bool IsIntType(int type) {
+  return type == kMemInt32 || type == kMemInt64;
+}
+inline bool IsValidType(int type) {
+  return IsFloatType(type) || IsIntType(type);
+}
+
+MemoryReader* MemoryReader::CreateDense(const void* X, int x_type,
+                                        const void* Y, int y_type, size_t rows,
+                                        size_t cols, size_t row_stride) {
+  if ((X == nullptr && rows > 0) || IsFloatType(x_type) == false ||
+      (Y != nullptr && IsValidType(y_type) == false)) {
+    fprintf(stderr, "invalid dense matrix for memory reader\n");
+    return nullptr;
+  }
+  MemoryReader* reader = new MemoryReader;
+  reader->row_reader_ = x_type == kMemFloat32 ? ReadDenseRow<float>
+                                              : ReadDenseRow<double>;
+  reader->X_ = (const char*)X;
+  reader->cols_ = cols;
+  reader->row_stride_ = row_stride;
+  reader->Y_ = Y;
+  reader->y_type_ = y_type;
+  reader->rows_ = rows;
+  return reader;
+}
+
+MemoryReader* MemoryReader::CreateCsr(const void* indptr, int indptr_type,
+                                      const void* indices, int index_type,
+                                      const void* values, int value_type,
+                                      const void* Y, int y_type, size_t rows,
+                                      bool canonical) {
+  if (indptr == nullptr || IsIntType(indptr_type) == false ||
+      IsIntType(index_type) == false || IsFloatType(value_type) == false ||
+      (Y != nullptr && IsValidType(y_type) == false)) {
+    fprintf(stderr, "invalid csr matrix for memory reader\n");
+    return nullptr;
+  }
+  if (ElementAt(indptr, indptr_type, rows) > 0 &&
+      (indices == nullptr || values == nullptr)) {
+    fprintf(stderr, "invalid csr matrix for memory reader\n");
+    return nullptr;
+  }
+
+  bool is_float = value_type == kMemFloat32;
+  RowReader row_reader = nullptr;
+  if (indptr_type == kMemInt32) {
+    if (index_type == kMemInt32) {
+      row_reader = is_float ? ReadCsrRow<int32_t, int32_t, float>
+                            : ReadCsrRow<int32_t, int32_t, double>;
+    } else {
+      row_reader = is_float ? ReadCsrRow<int32_t, int64_t, float>
+                            : ReadCsrRow<int32_t, int64_t, double>;
+    }
+  } else {
+    if (index_type == kMemInt32) {
+      row_reader = is_float ? ReadCsrRow<int64_t, int32_t, float>
+                            : ReadCsrRow<int64_t, int32_t, double>;
+    } else {
+      row_reader = is_float ? ReadCsrRow<int64_t, int64_t, float>
+                            : ReadCsrRow<int64_t, int64_t, double>;
+    }
+  }
+
+  MemoryReader* reader = new MemoryReader;
+  reader->row_reader_ = row_reader;
+  reader->indptr_ = indptr;
+  reader->indices_ = indices;
+  reader->values_ = values;
+  reader->canonical_ = canonical;
+  reader->Y_ = Y;
+  reader->y_type_ = y_type;
+  reader->rows_ = rows;
+  return reader;
+}
+
+}  // namespace pario
+}  // namespace sol
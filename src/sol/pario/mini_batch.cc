@@ -0,0 +1,65 @@
+/*********************************************************************************
+*     File Name           :     mini_batch.cc
+*     Created By          :     yuewu
+*     Description         :     min batch
+**********************************************************************************/
+
+#include "sol/pario/mini_batch.h"
+
+#include <algorithm>
+
+namespace sol {
+namespace pario {
+
+// initial number of features per point of the shared buffers
+static const size_t kInitFeatNumPerPoint = 64;
+
+MiniBatch::MiniBatch(int batch_size, size_t feat_capacity)
+    : data_num(0),
+      points_(nullptr),
+      capacity_(batch_size),
+      indexes_(nullptr),
+      features_(nullptr),
+      feat_capacity_(0),
+      feat_num_(0),
+      required_feat_num_(0) {
+  this->points_ = new DataPoint[this->capacity_];
+  if (feat_capacity == 0) {
+    feat_capacity = size_t(this->capacity_) * kInitFeatNumPerPoint;
+  }
+  this->ReserveFeatures(feat_capacity);
+}
+
+MiniBatch::~MiniBatch() {
+  // points do not release the shared buffers
+  DeleteArray(this->points_);
+  DeleteArray(this->indexes_);
+  DeleteArray(this->features_);
+}
+
+void MiniBatch::Clear() {
+  if (this->required_feat_num_ > this->feat_capacity_) {
+    this->ReserveFeatures(
+        (std::max)(this->required_feat_num_, this->feat_capacity_ * 2));
+  }
+  this->data_num = 0;
+  this->feat_num_ = 0;
+  this->required_feat_num_ = 0;
+}
+
+void MiniBatch::ReserveFeatures(size_t feat_capacity) {
+  // detach points from the old buffers
+  for (int i = 0; i < this->capacity_; ++i) {
+    this->points_[i].Attach(nullptr, nullptr, 0);
+  }
+  DeleteArray(this->indexes_);
+  DeleteArray(this->features_);
+  this->indexes_ = new index_t[feat_capacity];
+  this->features_ = new real_t[feat_capacity];
+  this->feat_capacity_ = feat_capacity;
+  this->feat_num_ = 0;
+  this->data_num = 0;
+}
+
+}  // namespace pario
+}  // namespace sol
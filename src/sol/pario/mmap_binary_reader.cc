@@ -0,0 +1,92 @@
+/*********************************************************************************
+*     File Name           :     mmap_binary_reader.cc
+*     Created By          :     yuewu
+*     Description         :     binary format data reader on memory mapped file
+**********************************************************************************/
+
+#include "sol/pario/mmap_binary_reader.h"
+
+#include <cstring>
+
+#include "sol/pario/compress.h"
+#include "sol/util/error_code.h"
+
+namespace sol {
+namespace pario {
+
+MMapBinaryReader::MMapBinaryReader() : pos_(nullptr), is_good_(true) {}
+
+MMapBinaryReader::~MMapBinaryReader() { this->Close(); }
+
+int MMapBinaryReader::Open(const std::string& path, const char* mode) {
+  this->Close();
+  if (path == "-") {
+    fprintf(stderr, "stdin can not be memory mapped\n");
+    return Status_Invalid_Argument;
+  }
+  int ret = this->file_.Open(path.c_str());
+  this->is_good_ = ret == Status_OK ? true : false;
+  this->pos_ = this->file_.begin();
+  return ret;
+}
+
+void MMapBinaryReader::Close() {
+  this->file_.Close();
+  this->pos_ = nullptr;
+}
+
+int MMapBinaryReader::Next(DataPoint& dst_data) {
+  const char* end = this->file_.end();
+  if (this->pos_ == end) return Status_EndOfFile;
+
+  size_t left = size_t(end - this->pos_);
+  if (left < sizeof(label_t) + sizeof(size_t)) {
+    fprintf(stderr, "incomplete instance at the end of file!\n");
+    this->is_good_ = false;
+    return Status_Invalid_Format;
+  }
+  label_t label;
+  memcpy(&label, this->pos_, sizeof(label_t));
+  size_t feat_num;
+  memcpy(&feat_num, this->pos_ + sizeof(label_t), sizeof(size_t));
+  this->pos_ += sizeof(label_t) + sizeof(size_t);
+  left -= sizeof(label_t) + sizeof(size_t);
+
+  dst_data.Clear();
+  dst_data.set_label(label);
+  if (feat_num == 0) return Status_OK;
+
+  size_t code_len = 0;
+  if (left < sizeof(size_t)) {
+    fprintf(stderr, "read coded index length failed!\n");
+    this->is_good_ = false;
+    return Status_Invalid_Format;
+  }
+  memcpy(&code_len, this->pos_, sizeof(size_t));
+  this->pos_ += sizeof(size_t);
+  left -= sizeof(size_t);
+  if (code_len > left || feat_num > (left - code_len) / sizeof(real_t)) {
+    fprintf(stderr, "load features failed!\n");
+    this->is_good_ = false;
+    return Status_Invalid_Format;
+  }
+
+  dst_data.Resize(feat_num);
+  if (decomp_index(this->pos_, this->pos_ + code_len,
+                   dst_data.indexes().begin(), feat_num) != feat_num) {
+    fprintf(stderr, "decoded index number is not correct!\n");
+    this->is_good_ = false;
+    return Status_Invalid_Format;
+  }
+  this->pos_ += code_len;
+  // feature values are copied as models may normalize them in place
+  memcpy(dst_data.features().begin(), this->pos_, sizeof(real_t) * feat_num);
+  this->pos_ += sizeof(real_t) * feat_num;
+  return Status_OK;
+}
+
+RegisterDataReader(MMapBinaryReader, "mmapbin",
+                   "binary format data reader on memory mapped file");
+
+}  // namespace pario
+}  // namespace sol
@@ -0,0 +1,93 @@
+/*********************************************************************************
+*     File Name           :     numeric_parser.cc
+*     Created By          :     yuewu
+*     Description         :     Numeric Parser
+**********************************************************************************/
+#include "sol/pario/numeric_parser.h"
+
+namespace sol {
+namespace pario {
+
+float NumericParser::ParseFloatLong(char* p, char*& end) {
+#if SOL_SWAR_PARSE
+  end = p;
+  p = strip_line(p);
+  char* begin = p;
+  bool neg = false;
+  if (*p == '+') {
+    p++;
+  } else if (*p == '-') {
+    neg = true;
+    p++;
+  }
+  // integral parts are short, long runs of digits are in the decimals
+  uint64_t mantissa = 0;
+  char* digits = p;
+  while (*p >= '0' && *p <= '9') {
+    mantissa = mantissa * 10 + uint64_t(*p++ - '0');
+  }
+  int digit_num = int(p - digits);
+  int frac_num = 0;
+  if (*p == '.') {
+    p++;
+    frac_num = ParseDigits(p, mantissa);
+    digit_num += frac_num;
+  }
+  if (digit_num == 0) return 0;  // not a number, end is not moved
+
+  // long mantissas overflow, they are converted by strtof
+  bool fast = digit_num <= kMaxFastDigits;
+  int exponent = -frac_num;
+  if (*p == 'e' || *p == 'E') {
+    char* q = p + 1;
+    int exp_s = 1;
+    if (*q == '+') {
+      q++;
+    } else if (*q == '-') {
+      exp_s = -1;
+      q++;
+    }
+    char* exp_begin = q;
+    int exp_acc = 0;
+    while (*q >= '0' && *q <= '9' && q - exp_begin < 4) {
+      exp_acc = exp_acc * 10 + (*q++ - '0');
+    }
+    if (q == exp_begin || (*q >= '0' && *q <= '9')) {
+      fast = false;
+    } else {
+      exponent += exp_s * exp_acc;
+      p = q;
+    }
+  }
+
+  float val = 0;
+  if (fast && mantissa <= (uint64_t(1) << 53) && exponent >= -22 &&
+      exponent <= 22) {
+    // the mantissa and the powers of ten are exact in double, so dval is
+    // correctly rounded, rounding it again to float is exact unless dval
+    // falls on the midpoint of two floats
+    double dval = double(int64_t(mantissa));
+    if (exponent < 0) {
+      dval /= Pow10(-exponent);
+    } else if (exponent > 0) {
+      dval *= Pow10(exponent);
+    }
+    uint64_t bits;
+    memcpy(&bits, &dval, sizeof(bits));
+    if ((bits & 0x1FFFFFFFULL) == 0x10000000ULL) {
+      val = strtof(begin, &p);
+    } else {
+      val = neg ? -float(dval) : float(dval);
+    }
+  } else {
+    val = strtof(begin, &p);
+  }
+  end = strip_line(p);
+  return val;
+#else
+  return ParseFloat(p, end);
+#endif
+}
+
+}  // namespace pario
+}  // namespace sol
@@ -0,0 +1,244 @@
+/*********************************************************************************
+*     File Name           :     parallel_read_task.cc
+*     Created By          :     yuewu
+*     Description         :     Thread task to parse a text data in parallel
+**********************************************************************************/
+
+#include "sol/pario/parallel_read_task.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "sol/pario/file_reader.h"
+#include "sol/util/util.h"
+#include "sol/util/error_code.h"
+#include "sol/util/profiler.h"
+
+using namespace std;
+
+namespace sol {
+namespace pario {
+
+// default size of the blocks
+static const int64_t kDefaultBlockSize = 4 << 20;
+// number of mini-batches owned by each parser
+static const int kParserBatchNum = 2;
+
+/// \brief  Thread task to parse the blocks of a file assigned to one parser
+class BlockParseTask : public ThreadTask {
+ public:
+  BlockParseTask(DataReader* reader, MiniBatchQueue& mini_batch_factory,
+                 MiniBatchQueue& mini_batch_buf, int pass_num,
+                 int64_t file_size, int64_t block_size, int64_t first_block,
+                 int64_t block_stride)
+      : reader_(reader),
+        mini_batch_factory_(mini_batch_factory),
+        mini_batch_buf_(mini_batch_buf),
+        pass_num_(pass_num),
+        file_size_(file_size),
+        block_size_(block_size),
+        first_block_(first_block),
+        block_stride_(block_stride),
+        failed_(false) {}
+
+ public:
+  inline bool failed() const { return this->failed_; }
+
+ protected:
+  virtual void run() {
+    int64_t block_num = (this->file_size_ + this->block_size_ - 1) /
+                        this->block_size_;
+    for (int pass = 0; pass < this->pass_num_; ++pass) {
+      for (int64_t b = this->first_block_; b < block_num;
+           b += this->block_stride_) {
+        if (this->ParseBlock(b) == false) {
+          this->reader_->Close();
+          return;
+        }
+      }
+    }
+    this->reader_->Close();
+  }
+
+  /// \brief  parse a block, the last mini-batch of the block is followed by
+  /// a nullptr in mini_batch_buf_
+  ///
+  /// \return false if exit signal received or parse failed
+  bool ParseBlock(int64_t block_idx) {
+    int64_t begin = block_idx * this->block_size_;
+    int64_t end = (std::min)(begin + this->block_size_, this->file_size_);
+    int status = this->reader_->SetRange(begin, end);
+
+    MiniBatch* mini_batch = this->NewMiniBatch();
+    while (mini_batch != nullptr && status == Status_OK) {
+      if (mini_batch->size() == mini_batch->capacity()) {
+        this->mini_batch_buf_.Enqueue(mini_batch);
+        mini_batch = this->NewMiniBatch();
+        continue;
+      }
+      {
+        ProfileScope scope(kStageRead);
+        status = this->reader_->Next(mini_batch->NextPoint());
+      }
+      if (status == Status_OK) mini_batch->PushPoint();
+    }
+    if (mini_batch == nullptr) return false;  // exit signal
+
+    if (status != Status_EndOfFile) {
+      fprintf(stderr, "parse block %lld failed\n", (long long)block_idx);
+      this->failed_ = true;
+    }
+    this->mini_batch_buf_.Enqueue(mini_batch);
+    this->mini_batch_buf_.Enqueue(nullptr);
+    return this->failed_ == false;
+  }
+
+  MiniBatch* NewMiniBatch() {
+    MiniBatch* mini_batch = this->mini_batch_factory_.Dequeue();
+    if (mini_batch == nullptr) {  // exit signal
+      this->mini_batch_factory_.Enqueue(nullptr);
+    } else {
+      mini_batch->Clear();
+    }
+    return mini_batch;
+  }
+
+ private:
+  std::unique_ptr<DataReader> reader_;
+  MiniBatchQueue& mini_batch_factory_;
+  MiniBatchQueue& mini_batch_buf_;
+  int pass_num_;
+  int64_t file_size_;
+  int64_t block_size_;
+  int64_t first_block_;
+  int64_t block_stride_;
+  std::atomic<bool> failed_;
+};
+
+ParallelReadTask::ParallelReadTask(const std::string& path,
+                                   const std::string& dtype,
+                                   MiniBatchQueue& mini_batch_factory,
+                                   MiniBatchQueue& mini_batch_buf,
+                                   int pass_num, int thread_num,
+                                   bool keep_order, int batch_size,
+                                   int64_t block_size)
+    : mini_batch_factory_(mini_batch_factory),
+      mini_batch_buf_(mini_batch_buf),
+      pass_num_(pass_num),
+      keep_order_(keep_order),
+      block_num_(0) {
+  int64_t file_size = FileReader(path.c_str(), "r").Size();
+  if (file_size < 0) {
+    fprintf(stderr, "get size of file (%s) failed\n", path.c_str());
+    return;
+  }
+  if (thread_num < 1) thread_num = 1;
+  if (block_size <= 0) {
+    block_size = (std::min)(kDefaultBlockSize,
+                            (file_size + thread_num - 1) / thread_num);
+    block_size = (std::max)(block_size, int64_t(1));
+  }
+  this->block_num_ = (file_size + block_size - 1) / block_size;
+  thread_num = int((std::max)(
+      int64_t(1), (std::min)(int64_t(thread_num), this->block_num_)));
+
+  // parsers share the same queues if the order is not kept
+  int queue_num = keep_order ? thread_num : 1;
+  int pool_size = kParserBatchNum * thread_num / queue_num;
+  // each queue is read by one thread if the order is kept, the mini-batches
+  // parsed are read by this task only
+  for (int i = 0; i < queue_num; ++i) {
+    this->factories_.push_back(
+        std::make_shared<MiniBatchQueue>(pool_size + 1, false, keep_order));
+    this->bufs_.push_back(std::make_shared<MiniBatchQueue>(
+        2 * (pool_size + thread_num / queue_num), keep_order, true));
+    for (int j = 0; j < pool_size; ++j) {
+      this->factories_[i]->Enqueue(new MiniBatch(batch_size));
+    }
+  }
+
+  for (int i = 0; i < thread_num; ++i) {
+    DataReader* reader = DataReader::Create(dtype);
+    if (reader == nullptr || reader->Open(path) != Status_OK ||
+        reader->SetRange(0, file_size) != Status_OK) {
+      DeletePointer(reader);
+      this->parsers_.clear();
+      return;
+    }
+    int q = i % queue_num;
+    this->parsers_.push_back(std::make_shared<BlockParseTask>(
+        reader, *this->factories_[q], *this->bufs_[q], pass_num, file_size,
+        block_size, i, thread_num));
+  }
+}
+
+ParallelReadTask::~ParallelReadTask() { this->StopParsers(); }
+
+void ParallelReadTask::run() {
+  for (shared_ptr<BlockParseTask>& parser : this->parsers_) {
+    parser->Start();
+  }
+
+  int64_t block_count = this->block_num_ * this->pass_num_;
+  int64_t block_idx = 0;
+  size_t parser_num = this->parsers_.size();
+  size_t q = 0;
+  while (block_idx < block_count) {
+    if (this->keep_order_) {
+      q = size_t(block_idx % this->block_num_) % parser_num;
+    }
+    MiniBatch* mini_batch = this->bufs_[q]->Dequeue();
+    if (mini_batch == nullptr) {  // end of a block
+      ++block_idx;
+      bool failed = false;
+      for (shared_ptr<BlockParseTask>& parser : this->parsers_) {
+        failed = failed || parser->failed();
+      }
+      if (failed) break;
+      continue;
+    }
+    if (mini_batch->size() == 0) {
+      this->factories_[q]->Enqueue(mini_batch);
+      continue;
+    }
+    // exchange the loaded mini-batch with an empty one
+    MiniBatch* empty_batch = this->mini_batch_factory_.Dequeue();
+    if (empty_batch == nullptr) {  // exit signal
+      this->mini_batch_factory_.Enqueue(nullptr);
+      this->factories_[q]->Enqueue(mini_batch);
+      break;
+    }
+    this->factories_[q]->Enqueue(empty_batch);
+    this->mini_batch_buf_.Enqueue(mini_batch);
+  }
+  this->StopParsers();
+  this->mini_batch_buf_.Enqueue(nullptr);
+}
+
+void ParallelReadTask::StopParsers() {
+  // send exit signal to parsers
+  for (shared_ptr<MiniBatchQueue>& factory : this->factories_) {
+    factory->Enqueue(nullptr);
+  }
+  for (shared_ptr<BlockParseTask>& parser : this->parsers_) {
+    parser->Join();
+  }
+  this->parsers_.clear();
+
+  MiniBatch* mb = nullptr;
+  for (size_t i = 0; i < this->factories_.size(); ++i) {
+    while (this->factories_[i]->size() > 0) {
+      mb = this->factories_[i]->Dequeue();
+      DeletePointer(mb);
+    }
+    while (this->bufs_[i]->size() > 0) {
+      mb = this->bufs_[i]->Dequeue();
+      DeletePointer(mb);
+    }
+  }
+  this->factories_.clear();
+  this->bufs_.clear();
+}
+
+}  // namespace pario
+}  // namespace sol
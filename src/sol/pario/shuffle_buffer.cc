@@ -0,0 +1,109 @@
+/*********************************************************************************
+*     File Name           :     shuffle_buffer.cc
+*     Created By          :     yuewu
+*     Description         :     window of data points to shuffle a data stream
+**********************************************************************************/
+
+#include "sol/pario/shuffle_buffer.h"
+
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+namespace sol {
+namespace pario {
+
+ShuffleBuffer::ShuffleBuffer(size_t window_size, unsigned int seed)
+    : window_size_(window_size > 0 ? window_size : 1),
+      gen_(seed),
+      dead_feat_num_(0) {
+  this->labels_.reserve(this->window_size_);
+  this->offsets_.reserve(this->window_size_);
+  this->feat_nums_.reserve(this->window_size_);
+  this->live_slots_.reserve(this->window_size_);
+}
+
+void ShuffleBuffer::Push(const DataPoint& pt) {
+  this->live_slots_.push_back(this->labels_.size());
+  this->labels_.push_back(pt.label());
+  this->offsets_.push_back(this->indexes_.size());
+  this->feat_nums_.push_back(pt.size());
+  this->indexes_.insert(this->indexes_.end(), pt.indexes().begin(),
+                        pt.indexes().end());
+  this->features_.insert(this->features_.end(), pt.features().begin(),
+                         pt.features().end());
+}
+
+void ShuffleBuffer::Pop(DataPoint& dst_pt) {
+  uniform_int_distribution<size_t> dis(0, this->live_slots_.size() - 1);
+  size_t pos = dis(this->gen_);
+  size_t slot = this->live_slots_[pos];
+  this->live_slots_[pos] = this->live_slots_.back();
+  this->live_slots_.pop_back();
+
+  size_t offset = this->offsets_[slot];
+  size_t feat_num = this->feat_nums_[slot];
+  dst_pt.set_label(this->labels_[slot]);
+  dst_pt.Resize(feat_num);
+  memcpy(dst_pt.indexes().begin(), this->indexes_.data() + offset,
+         feat_num * sizeof(index_t));
+  memcpy(dst_pt.features().begin(), this->features_.data() + offset,
+         feat_num * sizeof(real_t));
+
+  this->dead_feat_num_ += feat_num;
+  if (this->live_slots_.empty()) {
+    this->Clear();
+  } else if (this->dead_feat_num_ * 2 > this->indexes_.size() ||
+             this->live_slots_.size() * 2 < this->labels_.size()) {
+    this->Compact();
+  }
+}
+
+void ShuffleBuffer::Clear() {
+  this->labels_.clear();
+  this->offsets_.clear();
+  this->feat_nums_.clear();
+  this->live_slots_.clear();
+  this->indexes_.clear();
+  this->features_.clear();
+  this->dead_feat_num_ = 0;
+}
+
+void ShuffleBuffer::Compact() {
+  // points are moved in the order of the arena, so that they are only moved
+  // to lower positions
+  vector<size_t> sorted_slots(this->live_slots_);
+  sort(sorted_slots.begin(), sorted_slots.end());
+  size_t slot_num = sorted_slots.size();
+  size_t pos = 0;
+  for (size_t i = 0; i < slot_num; ++i) {
+    size_t slot = sorted_slots[i];
+    size_t offset = this->offsets_[slot];
+    size_t feat_num = this->feat_nums_[slot];
+    memmove(this->indexes_.data() + pos, this->indexes_.data() + offset,
+            feat_num * sizeof(index_t));
+    memmove(this->features_.data() + pos, this->features_.data() + offset,
+            feat_num * sizeof(real_t));
+    this->labels_[i] = this->labels_[slot];
+    this->offsets_[i] = pos;
+    this->feat_nums_[i] = feat_num;
+    pos += feat_num;
+  }
+  this->labels_.resize(slot_num);
+  this->offsets_.resize(slot_num);
+  this->feat_nums_.resize(slot_num);
+  this->indexes_.resize(pos);
+  this->features_.resize(pos);
+  this->dead_feat_num_ = 0;
+
+  // the order of the live slots is kept, so that the results only depend on
+  // the seed
+  for (size_t& slot : this->live_slots_) {
+    slot = size_t(lower_bound(sorted_slots.begin(), sorted_slots.end(), slot) -
+                  sorted_slots.begin());
+  }
+}
+
+}  // namespace pario
+}  // namespace sol
@@ -16,46 +16,47 @@ namespace sol {
 namespace pario {
 
 int SVMReader::Next(DataPoint &dst_data) {
-  int ret = this->file_reader_.ReadLine(this->read_buf_, this->read_buf_size_);
+  int ret = this->ReadLine();
   if (ret != Status_OK) return ret;
 
-  char *iter = this->read_buf_, *endptr = nullptr;
-  if (*iter == '\0') {
+  if (*this->read_buf_ == '\0') {
     fprintf(stderr, "incorrect line\n");
     return Status_Invalid_Format;
   }
+  ret = ParseLine(this->read_buf_, dst_data);
+  if (ret != Status_OK) this->is_good_ = false;
+  return ret;
+}
 
+int SVMReader::ParseLine(char *line, DataPoint &dst_data) {
+  char *iter = line, *endptr = nullptr;
   dst_data.Clear();
   // 1. parse label
-  dst_data.set_label(label_t(NumericParser::ParseInt(iter, endptr)));
+  dst_data.set_label(label_t(NumericParser::ParseIntFast(iter, endptr)));
   if (endptr == iter) {
     fprintf(stderr, "parse label failed.\n");
-    this->is_good_ = false;
     return Status_Invalid_Format;
   }
   iter = endptr;
 
   // 2. parse features
   while (*iter != '\0') {
-    index_t index = (index_t)(NumericParser::ParseUint(iter, endptr));
+    index_t index = (index_t)(NumericParser::ParseUintFast(iter, endptr));
     if (endptr == iter) {
       // parse index failed
       fprintf(stderr, "parse index value (%s) failed!\n", iter);
-      this->is_good_ = false;
       return Status_Invalid_Format;
     }
     iter = endptr;
     if (*iter != ':') {
       fprintf(stderr, "incorrect input file (%s)!\n", iter);
-      this->is_good_ = false;
       return Status_Invalid_Format;
     }
     ++iter;
 
-    real_t feat = NumericParser::ParseFloat(iter, endptr);
+    real_t feat = NumericParser::ParseFloatFast(iter, endptr);
     if (endptr == iter) {
       fprintf(stderr, "parse feature value (%s) failed!\n", iter);
-      this->is_good_ = false;
       return Status_Invalid_Format;
     }
     iter = endptr;
@@ -64,7 +65,7 @@ int SVMReader::Next(DataPoint &dst_data) {
   }
   dst_data.Sort();
 
-  return ret;
+  return Status_OK;
 }
 
 RegisterDataReader(SVMReader, "svm", "libsvm format data reader");
@@ -0,0 +1,286 @@
+/*********************************************************************************
+*     File Name           :     value_codec.cc
+*     Created By          :     yuewu
+*     Description         :     encodings of the feature values in the block
+*                                 binary format
+**********************************************************************************/
+
+#include "sol/pario/value_codec.h"
+
+#include <cmath>
+#include <type_traits>
+
+#include "sol/util/error_code.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define SOL_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define SOL_X86_SIMD 0
+#endif
+
+namespace sol {
+namespace pario {
+
+uint16_t FloatToHalf(float val) {
+  uint32_t x;
+  memcpy(&x, &val, sizeof(x));
+  uint32_t sign = (x >> 16) & 0x8000;
+  uint32_t exp = (x >> 23) & 0xFF;
+  uint32_t mant = x & 0x7FFFFF;
+  if (exp == 0xFF) return uint16_t(sign | 0x7C00 | (mant != 0 ? 0x200 : 0));
+
+  int e = int(exp) - 127 + 15;
+  if (e >= 31) return uint16_t(sign | 0x7C00);
+  if (e <= 0) {
+    // subnormal half floats
+    if (e < -10) return uint16_t(sign);
+    mant |= 0x800000;
+    int shift = 14 - e;
+    uint32_t half = mant >> shift;
+    uint32_t rem = mant & ((1U << shift) - 1);
+    uint32_t halfway = 1U << (shift - 1);
+    if (rem > halfway || (rem == halfway && (half & 1) != 0)) ++half;
+    return uint16_t(sign | half);
+  }
+  uint32_t half = (uint32_t(e) << 10) | (mant >> 13);
+  uint32_t rem = mant & 0x1FFF;
+  // the carry may round up to the next exponent or infinity
+  if (rem > 0x1000 || (rem == 0x1000 && (half & 1) != 0)) ++half;
+  return uint16_t(sign | half);
+}
+
+float HalfToFloat(uint16_t val) {
+  uint32_t sign = uint32_t(val & 0x8000) << 16;
+  uint32_t exp = (val >> 10) & 0x1F;
+  uint32_t mant = val & 0x3FF;
+  uint32_t bits;
+  if (exp == 0) {
+    // zero or subnormal, mant * 2^-24 is exact in float
+    float f = float(mant) * 5.9604644775390625e-8f;
+    return sign != 0 ? -f : f;
+  } else if (exp == 31) {
+    bits = sign | 0x7F800000 | (mant << 13);
+  } else {
+    bits = sign | ((exp + 112) << 23) | (mant << 13);
+  }
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+uint16_t FloatToBf16(float val) {
+  uint32_t x;
+  memcpy(&x, &val, sizeof(x));
+  if ((x & 0x7FFFFFFF) > 0x7F800000) return uint16_t((x >> 16) | 0x40);
+  x += 0x7FFF + ((x >> 16) & 1);
+  return uint16_t(x >> 16);
+}
+
+//---------------
+// encoders
+// --------------
+
+/// \brief  scale of the int8 encoding, 0 if the values can not be encoded
+///
+/// \param values values to encode
+/// \param num number of values
+/// \param lossless whether the values must be decoded exactly
+static float int8_scale(const real_t* values, size_t num, bool lossless) {
+  float max_val = 0;
+  bool integer = true;
+  for (size_t i = 0; i < num; ++i) {
+    float val = float(values[i]);
+    if (std::isfinite(val) == false) return 0;
+    float abs_val = std::fabs(val);
+    if (abs_val > max_val) max_val = abs_val;
+    if (integer && val != std::nearbyint(val)) integer = false;
+  }
+  if (max_val == 0) return 1.f;
+  if (lossless == false) return max_val / 127.f;
+
+  // counts are encoded with scale 1, other values by the max value
+  float scales[2] = {integer && max_val <= 127.f ? 1.f : 0.f,
+                     max_val / 127.f};
+  for (float scale : scales) {
+    if (scale == 0) continue;
+    size_t i = 0;
+    for (; i < num; ++i) {
+      float q = std::nearbyint(float(values[i]) / scale);
+      if (q * scale != float(values[i])) break;
+    }
+    if (i == num) return scale;
+  }
+  return 0;
+}
+
+/// \brief  test if all values can be encoded by a 16-bit encoding
+template <typename Encode, typename Decode>
+static bool fit_16bit(const real_t* values, size_t num, bool lossless,
+                      Encode encode, Decode decode) {
+  for (size_t i = 0; i < num; ++i) {
+    float val = float(values[i]);
+    float decoded = decode(encode(val));
+    if (lossless && decoded != val) return false;
+    // out of the range
+    if (std::isfinite(val) && std::isfinite(decoded) == false) return false;
+  }
+  return true;
+}
+
+int EncodeValues(const real_t* values, size_t num, int precision,
+                 std::vector<char>& dst) {
+  bool all_one = true;
+  for (size_t i = 0; i < num && all_one; ++i) all_one = values[i] == 1;
+  if (all_one) {
+    dst.push_back(char(kValueOne));
+    return kValueOne;
+  }
+
+  // sizes of the candidates, the smallest one is chosen
+  size_t best_size = sizeof(float) * num;
+  int encoding = kValueFloat;
+  float scale = int8_scale(values, num, precision != kPrecisionInt8);
+  if (scale != 0 && sizeof(float) + num < best_size) {
+    best_size = sizeof(float) + num;
+    encoding = kValueInt8;
+  }
+  if (2 * num < best_size) {
+    bool lossless_fp16 = precision != kPrecisionFp16;
+    bool lossless_bf16 = precision != kPrecisionBf16;
+    if (fit_16bit(values, num, lossless_fp16, FloatToHalf, HalfToFloat)) {
+      best_size = 2 * num;
+      encoding = kValueFp16;
+    } else if (fit_16bit(values, num, lossless_bf16, FloatToBf16,
+                         Bf16ToFloat)) {
+      best_size = 2 * num;
+      encoding = kValueBf16;
+    }
+  }
+
+  dst.push_back(char(encoding));
+  size_t offset = dst.size();
+  dst.resize(offset + best_size);
+  char* p = dst.data() + offset;
+  switch (encoding) {
+    case kValueInt8:
+      memcpy(p, &scale, sizeof(float));
+      p += sizeof(float);
+      for (size_t i = 0; i < num; ++i) {
+        float q = std::nearbyint(float(values[i]) / scale);
+        q = q > 127.f ? 127.f : (q < -127.f ? -127.f : q);
+        p[i] = char(int8_t(q));
+      }
+      break;
+    case kValueFp16:
+    case kValueBf16:
+      for (size_t i = 0; i < num; ++i) {
+        uint16_t half = encoding == kValueFp16 ? FloatToHalf(float(values[i]))
+                                               : FloatToBf16(float(values[i]));
+        memcpy(p + 2 * i, &half, 2);
+      }
+      break;
+    default:
+      for (size_t i = 0; i < num; ++i) {
+        float val = float(values[i]);
+        memcpy(p + sizeof(float) * i, &val, sizeof(float));
+      }
+      break;
+  }
+  return encoding;
+}
+
+//---------------
+// decoders
+// --------------
+
+#if SOL_X86_SIMD
+__attribute__((target("avx,f16c"))) static void decode_fp16_f16c(
+    const char* src, float* values, size_t num) {
+  size_t i = 0;
+  for (; i + 8 <= num; i += 8) {
+    __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    _mm256_storeu_ps(values + i, _mm256_cvtph_ps(half));
+    src += 16;
+  }
+  for (; i < num; ++i, src += 2) {
+    uint16_t half;
+    memcpy(&half, src, 2);
+    values[i] = HalfToFloat(half);
+  }
+}
+
+static bool cpu_has_f16c() {
+  static bool has_f16c = []() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx") != 0 &&
+           __builtin_cpu_supports("f16c") != 0;
+  }();
+  return has_f16c;
+}
+#endif
+
+int DecodeValues(const char* src, size_t len, real_t* values, size_t num,
+                 size_t& used) {
+  if (len < 1) return Status_Invalid_Format;
+  int encoding = int((unsigned char)src[0]);
+  ++src;
+  switch (encoding) {
+    case kValueOne:
+      used = 1;
+      for (size_t i = 0; i < num; ++i) values[i] = real_t(1);
+      return Status_OK;
+    case kValueFloat:
+      used = 1 + sizeof(float) * num;
+      if (used > len) return Status_Invalid_Format;
+      if (std::is_same<real_t, float>::value) {
+        memcpy(values, src, sizeof(float) * num);
+      } else {
+        for (size_t i = 0; i < num; ++i) {
+          float val;
+          memcpy(&val, src + sizeof(float) * i, sizeof(float));
+          values[i] = real_t(val);
+        }
+      }
+      return Status_OK;
+    case kValueInt8: {
+      used = 1 + sizeof(float) + num;
+      if (used > len) return Status_Invalid_Format;
+      float scale;
+      memcpy(&scale, src, sizeof(float));
+      const int8_t* q = (const int8_t*)(src + sizeof(float));
+      for (size_t i = 0; i < num; ++i) values[i] = real_t(q[i] * scale);
+      return Status_OK;
+    }
+    case kValueFp16:
+      used = 1 + 2 * num;
+      if (used > len) return Status_Invalid_Format;
+#if SOL_X86_SIMD
+      if (std::is_same<real_t, float>::value && cpu_has_f16c()) {
+        decode_fp16_f16c(src, (float*)values, num);
+        return Status_OK;
+      }
+#endif
+      for (size_t i = 0; i < num; ++i) {
+        uint16_t half;
+        memcpy(&half, src + 2 * i, 2);
+        values[i] = real_t(HalfToFloat(half));
+      }
+      return Status_OK;
+    case kValueBf16:
+      used = 1 + 2 * num;
+      if (used > len) return Status_Invalid_Format;
+      for (size_t i = 0; i < num; ++i) {
+        uint16_t half;
+        memcpy(&half, src + 2 * i, 2);
+        values[i] = real_t(Bf16ToFloat(half));
+      }
+      return Status_OK;
+    default:
+      return Status_Invalid_Format;
+  }
+}
+
+}  // namespace pario
+}  // namespace sol
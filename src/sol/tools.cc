@@ -11,9 +11,14 @@
 #include <algorithm>
 #include <random>
 #include <cmath>
+#include <cstring>
+#include <memory>
+#include <functional>
 
 #include <sol/sol.h>
 #include <sol/math/vector.h>
+#include <sol/util/monitor.h>
+#include <sol/util/thread_task.h>
 
 using namespace sol::pario;
 using namespace std;
@@ -168,8 +173,211 @@ int convert(const string& src_path, const string& src_type,
   return ret;
 }
 
+// number of threads writing the shards
+static const int kShardWriterNum = 2;
+
+/// \brief  Shuffle data larger than memory in two stages
+///
+/// The data is first split into shards randomly, each writer thread writes
+/// its own file of each shard in the binary format. Then the shards are
+/// loaded one by one, shuffled in memory and passed to the handler. Without
+/// shuffling, the data is written to one shard in the original order and
+/// streamed back.
+class ExternalShuffler {
+ public:
+  /// \brief  points of a shard in CSR layout
+  struct Shard {
+    std::vector<label_t> labels;
+    std::vector<size_t> offsets;
+    std::vector<index_t> indexes;
+    std::vector<real_t> features;
+  };
+
+ public:
+  /// \param tmp_prefix prefix of the temporary shard files
+  /// \param shard_num number of shards
+  /// \param thread_num number of threads writing the shards
+  ExternalShuffler(const string& tmp_prefix, int shard_num, int thread_num)
+      : tmp_prefix_(tmp_prefix),
+        shard_num_(shard_num),
+        thread_num_(thread_num),
+        data_num_(0),
+        feat_dim_(0) {}
+
+  ~ExternalShuffler() {
+    for (const string& path : this->shard_paths_) remove(path.c_str());
+  }
+
+ public:
+  /// \brief  write the data into the shards
+  ///
+  /// \param iter data iterator
+  /// \param shuffle whether to assign the data to shards randomly
+  ///
+  /// \return Status_OK if succeed
+  int Distribute(DataIter& iter, bool shuffle) {
+    if (shuffle == false) {
+      this->shard_num_ = 1;
+      this->thread_num_ = 1;
+    }
+    vector<unique_ptr<DataWriter>> writers;
+    for (int w = 0; w < this->thread_num_; ++w) {
+      for (int s = 0; s < this->shard_num_; ++s) {
+        ostringstream path;
+        path << this->tmp_prefix_ << ".shard" << w << "_" << s;
+        this->shard_paths_.push_back(path.str());
+        DataWriter* writer = DataWriter::Create("bin");
+        writers.emplace_back(writer);
+        if (writer == nullptr || writer->Open(path.str()) != Status_OK) {
+          return Status_IO_Error;
+        }
+      }
+    }
+
+    Mutex mutex;
+    auto write_func = [&](int w) {
+      random_device rd;
+      mt19937 g(rd());
+      uniform_int_distribution<int> dis(0, this->shard_num_ - 1);
+      vector<DataWriter*> shard_writers;
+      for (int s = 0; s < this->shard_num_; ++s) {
+        shard_writers.push_back(writers[w * this->shard_num_ + s].get());
+      }
+      size_t data_num = 0;
+      index_t feat_dim = 0;
+      while (1) {
+        mutex.lock();
+        MiniBatch* mb = iter.Next();
+        mutex.unlock();
+        if (mb == nullptr) break;
+        for (int i = 0; i < mb->size(); ++i) {
+          const DataPoint& dp = (*mb)[i];
+          shard_writers[shuffle ? dis(g) : 0]->Write(dp);
+          if (feat_dim < dp.dim()) feat_dim = dp.dim();
+        }
+        data_num += mb->size();
+        iter.Recycle(mb);
+      }
+      mutex.lock();
+      this->data_num_ += data_num;
+      if (this->feat_dim_ < feat_dim) this->feat_dim_ = feat_dim;
+      mutex.unlock();
+    };
+
+    vector<shared_ptr<FunctionTask>> tasks;
+    for (int w = 0; w < this->thread_num_; ++w) {
+      tasks.push_back(make_shared<FunctionTask>(bind(write_func, w)));
+      tasks.back()->Start();
+    }
+    for (shared_ptr<FunctionTask>& task : tasks) task->Join();
+
+    int ret = Status_OK;
+    for (unique_ptr<DataWriter>& writer : writers) {
+      if (writer->Good() == false) ret = Status_IO_Error;
+      writer->Close();
+    }
+    return ret;
+  }
+
+  /// \brief  pass the data of the shards to the handler
+  ///
+  /// \param handler function to handle a data point
+  /// \param shuffle whether to shuffle the data of each shard
+  ///
+  /// \return Status_OK if succeed
+  int ForEach(const std::function<int(const DataPoint&)>& handler,
+              bool shuffle) {
+    random_device rd;
+    mt19937 g(rd());
+    DataPoint dp;
+    Shard shard;
+    vector<size_t> order;
+    for (int s = 0; s < this->shard_num_; ++s) {
+      shard.labels.clear();
+      shard.offsets.assign(1, 0);
+      shard.indexes.clear();
+      shard.features.clear();
+      for (int w = 0; w < this->thread_num_; ++w) {
+        unique_ptr<DataReader> reader(DataReader::Create("bin"));
+        const string& path = this->shard_paths_[w * this->shard_num_ + s];
+        if (reader == nullptr || reader->Open(path) != Status_OK) {
+          return Status_IO_Error;
+        }
+        int ret = Status_OK;
+        while ((ret = reader->Next(dp)) == Status_OK) {
+          if (shuffle == false) {
+            ret = handler(dp);
+            if (ret != Status_OK) return ret;
+            continue;
+          }
+          shard.labels.push_back(dp.label());
+          shard.indexes.insert(shard.indexes.end(), dp.indexes().begin(),
+                               dp.indexes().end());
+          shard.features.insert(shard.features.end(), dp.features().begin(),
+                                dp.features().end());
+          shard.offsets.push_back(shard.indexes.size());
+        }
+        if (ret != Status_EndOfFile) return ret;
+      }
+
+      size_t data_num = shard.labels.size();
+      order.resize(data_num);
+      for (size_t i = 0; i < data_num; ++i) order[i] = i;
+      std::shuffle(order.begin(), order.end(), g);
+      for (size_t idx : order) {
+        size_t offset = shard.offsets[idx];
+        size_t feat_num = shard.offsets[idx + 1] - offset;
+        dp.set_label(shard.labels[idx]);
+        dp.Resize(feat_num);
+        memcpy(dp.indexes().begin(), shard.indexes.data() + offset,
+               feat_num * sizeof(index_t));
+        memcpy(dp.features().begin(), shard.features.data() + offset,
+               feat_num * sizeof(real_t));
+        int ret = handler(dp);
+        if (ret != Status_OK) return ret;
+      }
+    }
+    return Status_OK;
+  }
+
+ public:
+  inline size_t data_num() const { return this->data_num_; }
+  inline index_t feat_dim() const { return this->feat_dim_; }
+
+ private:
+  string tmp_prefix_;
+  int shard_num_;
+  int thread_num_;
+  vector<string> shard_paths_;
+  size_t data_num_;
+  index_t feat_dim_;
+};
+
+/// \brief  size of the data in bytes, compressed files are decompressed
+/// once to get the size of the data loaded into memory; -1 if unknown
+static int64_t data_size(const std::string& src_path) {
+  // stdin can not be read twice
+  if (src_path == "-") return -1;
+  FileReader reader(src_path.c_str(), "rb");
+  if (reader.IsCompressed() == false) return reader.Size();
+  vector<char> buf(size_t(1) << 20);
+  int ret = Status_OK;
+  while ((ret = reader.Read(buf.data(), buf.size())) == Status_OK) {
+  }
+  return ret == Status_EndOfFile ? reader.Tell() : -1;
+}
+
+/// \brief  number of shards so that each shard fits into memory
+static int shard_number(const std::string& src_path, int64_t shard_size) {
+  int64_t file_size = data_size(src_path);
+  if (file_size < 0) return 16;
+  if (shard_size <= 0) shard_size = kDefaultShardSize;
+  return int((std::max)(int64_t(1), (file_size + shard_size - 1) / shard_size));
+}
+
 int shuffle(const std::string& src_path, const std::string& src_type,
-            const std::string& output_path, const std::string& output_type_) {
+            const std::string& output_path, const std::string& output_type_,
+            int64_t shard_size) {
   string output_type = output_type_;
   if (output_type.length() == 0) output_type = src_type;
 
@@ -177,110 +385,89 @@ int shuffle(const std::string& src_path, const std::string& src_type,
   int ret = iter.AddReader(src_path, src_type);
   if (ret != Status_OK) return ret;
 
-  DataWriter* writer = DataWriter::Create(output_type);
+  unique_ptr<DataWriter> writer(DataWriter::Create(output_type));
   if (writer == nullptr) {
     ret = Status_Invalid_Argument;
     return ret;
   }
   ret = writer->Open(output_path);
+  if (ret != Status_OK) return ret;
+
+  ExternalShuffler shuffler(output_path == "-" ? "sol_shuffle" : output_path,
+                            shard_number(src_path, shard_size),
+                            kShardWriterNum);
+  ret = shuffler.Distribute(iter, true);
   if (ret != Status_OK) {
-    delete writer;
+    fprintf(stderr, "write shards failed\n");
     return ret;
   }
 
-  MiniBatch* mb = nullptr;
-  vector<DataPoint*> data_list;
-
-  size_t data_num = 0;
-  index_t feat_dim = 0;
-  while (true) {
-    mb = iter.Next(mb);
-    if (mb == nullptr) break;
-    for (int i = 0; i < mb->size(); ++i) {
-      DataPoint* dp = new DataPoint();
-      (*mb)[i].Clone(*dp);
-      data_list.push_back(dp);
-
-      if (feat_dim < dp->dim()) feat_dim = dp->dim();
-    }
-    data_num += mb->size();
-  }
-
-  cout << data_num << " examples loaded\n";
-  random_device rd;
-  mt19937 g(rd());
-  std::shuffle(data_list.begin(), data_list.end(), g);
+  cout << shuffler.data_num() << " examples loaded\n";
+  index_t feat_dim = shuffler.feat_dim();
   writer->SetExtraInfo((char*)(&feat_dim));
-  for (auto& data : data_list) {
-    writer->Write(*data);
-    delete data;
-  }
+  DataWriter* dst_writer = writer.get();
+  ret = shuffler.ForEach(
+      [dst_writer](const DataPoint& dp) { return dst_writer->Write(dp); },
+      true);
   writer->Close();
-  delete writer;
   return ret;
 }
 
 int split(const string& src_path, const string& src_type, int fold_num,
-          const string& output_prefix, const string& dst_type, bool shuffle) {
+          const string& output_prefix, const string& dst_type, bool shuffle,
+          int64_t shard_size) {
   DataIter iter;
   int ret = iter.AddReader(src_path, src_type);
   if (ret != Status_OK) return ret;
 
-  MiniBatch* mb = nullptr;
-  vector<DataPoint*> data_list;
-
-  size_t data_num = 0;
-  index_t feat_dim = 0;
-  while (true) {
-    mb = iter.Next(mb);
-    if (mb == nullptr) break;
-    for (int i = 0; i < mb->size(); ++i) {
-      DataPoint* dp = new DataPoint();
-      (*mb)[i].Clone(*dp);
-      data_list.push_back(dp);
-
-      if (feat_dim < dp->dim()) feat_dim = dp->dim();
-    }
-    data_num += mb->size();
+  ExternalShuffler shuffler(output_prefix, shard_number(src_path, shard_size),
+                            kShardWriterNum);
+  ret = shuffler.Distribute(iter, shuffle);
+  if (ret != Status_OK) {
+    fprintf(stderr, "write shards failed\n");
+    return ret;
   }
 
+  size_t data_num = shuffler.data_num();
   cout << data_num << " examples loaded\n";
   if (data_num == 0) return ret;
 
-  if (shuffle) {
-    random_device rd;
-    mt19937 g(rd());
-    std::shuffle(data_list.begin(), data_list.end(), g);
-  }
-
-  size_t data_split_num = size_t(ceil(data_list.size() / float(fold_num)));
-  size_t data_idx = 0;
-  size_t end_idx = data_split_num;
-
-  for (int i = 0; i < fold_num; ++i) {
-    DataWriter* writer = DataWriter::Create(dst_type);
-    if (writer == nullptr) {
-      ret = Status_Invalid_Argument;
-      break;
-    }
+  index_t feat_dim = shuffler.feat_dim();
+  size_t data_split_num = size_t(ceil(data_num / float(fold_num)));
+  unique_ptr<DataWriter> writer;
+  int fold = -1;
+  auto next_fold = [&]() {
+    if (writer != nullptr) writer->Close();
+    writer.reset(DataWriter::Create(dst_type));
+    if (writer == nullptr) return Status_Invalid_Argument;
     ostringstream output_path;
-    output_path << output_prefix << i << "." << dst_type;
-    ret = writer->Open(output_path.str());
+    output_path << output_prefix << ++fold << "." << dst_type;
+    int ret = writer->Open(output_path.str());
     if (ret != Status_OK) {
-      delete writer;
-      break;
+      writer.reset();
+      return ret;
     }
-    fprintf(stderr, "write fold %d to %s\n", i, output_path.str().c_str());
+    fprintf(stderr, "write fold %d to %s\n", fold, output_path.str().c_str());
     writer->SetExtraInfo((char*)(&feat_dim));
+    return Status_OK;
+  };
 
-    for (; data_idx < end_idx && data_idx < data_num; ++data_idx) {
-      writer->Write(*(data_list[data_idx]));
-      delete data_list[data_idx];
-    }
-    end_idx += data_split_num;
-    writer->Close();
-    delete writer;
-  }
+  size_t data_idx = 0;
+  ret = next_fold();
+  if (ret != Status_OK) return ret;
+  ret = shuffler.ForEach(
+      [&](const DataPoint& dp) {
+        if (data_idx == size_t(fold + 1) * data_split_num) {
+          int ret = next_fold();
+          if (ret != Status_OK) return ret;
+        }
+        ++data_idx;
+        return writer->Write(dp);
+      },
+      shuffle);
+  // the remaining folds are empty
+  while (ret == Status_OK && fold + 1 < fold_num) ret = next_fold();
+  if (writer != nullptr) writer->Close();
   return ret;
 }
 }
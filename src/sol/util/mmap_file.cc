@@ -0,0 +1,130 @@
+/*********************************************************************************
+*     File Name           :     mmap_file.cc
+*     Created By          :     yuewu
+*     Description         :     memory mapped file
+**********************************************************************************/
+
+#include "sol/util/mmap_file.h"
+
+#if _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "sol/util/error_code.h"
+
+namespace sol {
+
+#if _WIN32
+MMapFile::MMapFile()
+    : data_(nullptr),
+      size_(0),
+      opened_(false),
+      copy_on_write_(false),
+      file_handle_(INVALID_HANDLE_VALUE),
+      map_handle_(nullptr) {}
+#else
+MMapFile::MMapFile()
+    : data_(nullptr), size_(0), opened_(false), copy_on_write_(false) {}
+#endif
+
+MMapFile::~MMapFile() { this->Close(); }
+
+#if _WIN32
+int MMapFile::Open(const char* path, bool copy_on_write) {
+  this->Close();
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  LARGE_INTEGER file_size;
+  if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size)) {
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    fprintf(stderr, "Error: open file (%s) failed.\n", path);
+    return Status_IO_Error;
+  }
+  this->file_handle_ = file;
+  this->size_ = size_t(file_size.QuadPart);
+  if (this->size_ > 0) {
+    this->map_handle_ = CreateFileMappingA(
+        file, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0,
+        nullptr);
+    if (this->map_handle_ != nullptr) {
+      this->data_ = (char*)MapViewOfFile(
+          this->map_handle_, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0,
+          0, 0);
+    }
+    if (this->data_ == nullptr) {
+      fprintf(stderr, "Error: map file (%s) failed.\n", path);
+      this->Close();
+      return Status_IO_Error;
+    }
+  }
+  this->copy_on_write_ = copy_on_write;
+  this->opened_ = true;
+  return Status_OK;
+}
+
+void MMapFile::Close() {
+  if (this->data_ != nullptr) UnmapViewOfFile(this->data_);
+  if (this->map_handle_ != nullptr) CloseHandle(this->map_handle_);
+  if (this->file_handle_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(this->file_handle_);
+  }
+  this->data_ = nullptr;
+  this->map_handle_ = nullptr;
+  this->file_handle_ = INVALID_HANDLE_VALUE;
+  this->size_ = 0;
+  this->opened_ = false;
+  this->copy_on_write_ = false;
+}
+
+#else
+
+int MMapFile::Open(const char* path, bool copy_on_write) {
+  this->Close();
+  int fd = open(path, O_RDONLY);
+  struct stat file_stat;
+  if (fd < 0 || fstat(fd, &file_stat) != 0) {
+    if (fd >= 0) close(fd);
+    fprintf(stderr, "Error: open file (%s) failed.\n", path);
+    return Status_IO_Error;
+  }
+  this->size_ = size_t(file_stat.st_size);
+  if (this->size_ > 0) {
+    void* data =
+        copy_on_write
+            ? mmap(nullptr, this->size_, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                   fd, 0)
+            : mmap(nullptr, this->size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      this->size_ = 0;
+      fprintf(stderr, "Error: map file (%s) failed.\n", path);
+      return Status_IO_Error;
+    }
+    if (copy_on_write == false) madvise(data, this->size_, MADV_SEQUENTIAL);
+    this->data_ = (char*)data;
+  }
+  // the mapping is kept after the descriptor is closed
+  close(fd);
+  this->copy_on_write_ = copy_on_write;
+  this->opened_ = true;
+  return Status_OK;
+}
+
+void MMapFile::Close() {
+  if (this->data_ != nullptr) {
+    munmap((void*)this->data_, this->size_);
+  }
+  this->data_ = nullptr;
+  this->size_ = 0;
+  this->opened_ = false;
+  this->copy_on_write_ = false;
+}
+
+#endif
+
+}  // namespace sol
@@ -0,0 +1,223 @@
+/*********************************************************************************
+*     File Name           :     profiler.cc
+*     Created By          :     yuewu
+*     Description         :     timing counters of the pipeline stages
+**********************************************************************************/
+
+#include "sol/util/profiler.h"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <json/json.h>
+#include <sol/util/mutex.h>
+
+using namespace std;
+
+namespace sol {
+
+namespace {
+
+/// \brief  counters of a thread, only written by the thread
+struct ThreadCounters {
+  atomic<uint64_t> ticks[kStageNum];
+  atomic<uint64_t> calls[kStageNum];
+  int id;
+  // whether the thread is running, protected by the lock of the registry
+  bool alive;
+
+  explicit ThreadCounters(int thread_id) : id(thread_id), alive(true) {
+    this->Clear();
+  }
+
+  void Clear() {
+    for (int i = 0; i < kStageNum; ++i) {
+      this->ticks[i].store(0, memory_order_relaxed);
+      this->calls[i].store(0, memory_order_relaxed);
+    }
+  }
+};
+
+struct Registry {
+  Mutex lock;
+  vector<unique_ptr<ThreadCounters>> counters;
+  int thread_num;
+  chrono::steady_clock::time_point start_time;
+
+  Registry() : thread_num(0), start_time(chrono::steady_clock::now()) {}
+};
+
+Registry& registry() {
+  static Registry reg;
+  return reg;
+}
+
+/// \brief  counters of the calling thread, kept in the registry after the
+/// thread exits so that the totals are not lost
+struct LocalCounters {
+  ThreadCounters* counters;
+
+  LocalCounters() : counters(nullptr) {}
+  ~LocalCounters() {
+    if (this->counters == nullptr) return;
+    Registry& reg = registry();
+    lock_guard<Mutex> guard(reg.lock);
+    this->counters->alive = false;
+  }
+
+  ThreadCounters* get() {
+    if (this->counters == nullptr) {
+      Registry& reg = registry();
+      lock_guard<Mutex> guard(reg.lock);
+      reg.counters.emplace_back(new ThreadCounters(reg.thread_num++));
+      this->counters = reg.counters.back().get();
+    }
+    return this->counters;
+  }
+};
+
+thread_local LocalCounters local_counters;
+
+/// \brief  number of ticks per second, measured once against the steady clock
+double TicksPerSecond() {
+  static const double ticks_per_second = []() {
+    chrono::steady_clock::time_point start_time = chrono::steady_clock::now();
+    uint64_t start_ticks = Profiler::ticks();
+    this_thread::sleep_for(chrono::milliseconds(10));
+    uint64_t end_ticks = Profiler::ticks();
+    double seconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start_time)
+            .count();
+    return seconds > 0 && end_ticks > start_ticks
+               ? double(end_ticks - start_ticks) / seconds
+               : 1e9;
+  }();
+  return ticks_per_second;
+}
+
+const char* kStageNames[kStageNum] = {"read",    "wait",     "preprocess",
+                                      "predict", "gradient", "update"};
+
+}  // namespace
+
+atomic<bool> Profiler::enabled_(false);
+
+void Profiler::Enable(bool enable) {
+  // calibrate before the counters are reported
+  if (enable) TicksPerSecond();
+  enabled_.store(enable, memory_order_relaxed);
+}
+
+void Profiler::Reset() {
+  Registry& reg = registry();
+  lock_guard<Mutex> guard(reg.lock);
+  // counters of the exited threads are not needed any more
+  size_t num = 0;
+  for (size_t i = 0; i < reg.counters.size(); ++i) {
+    if (reg.counters[i]->alive == false) continue;
+    reg.counters[i]->Clear();
+    reg.counters[num++].swap(reg.counters[i]);
+  }
+  reg.counters.resize(num);
+  reg.start_time = chrono::steady_clock::now();
+}
+
+void Profiler::Add(int stage, uint64_t ticks) {
+  ThreadCounters* counters = local_counters.get();
+  // only the thread writes its counters, no atomic read-modify-write needed
+  atomic<uint64_t>& total = counters->ticks[stage];
+  atomic<uint64_t>& calls = counters->calls[stage];
+  total.store(total.load(memory_order_relaxed) + ticks, memory_order_relaxed);
+  calls.store(calls.load(memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+const char* Profiler::StageName(int stage) {
+  return stage >= 0 && stage < kStageNum ? kStageNames[stage] : "unknown";
+}
+
+/// \brief  json object of the counters of each stage
+static Json::Value StageReport(const uint64_t* ticks, const uint64_t* calls,
+                               double ticks_per_second) {
+  Json::Value root(Json::objectValue);
+  for (int i = 0; i < kStageNum; ++i) {
+    if (calls[i] == 0) continue;
+    Json::Value stage;
+    double seconds = double(ticks[i]) / ticks_per_second;
+    stage["seconds"] = seconds;
+    stage["calls"] = Json::UInt64(calls[i]);
+    stage["ticks"] = Json::UInt64(ticks[i]);
+    stage["ns_per_call"] = seconds * 1e9 / double(calls[i]);
+    root[kStageNames[i]] = stage;
+  }
+  return root;
+}
+
+/// \brief  sum up the counters of all threads
+static void Collect(Registry& reg, uint64_t* ticks, uint64_t* calls) {
+  for (int i = 0; i < kStageNum; ++i) ticks[i] = calls[i] = 0;
+  for (unique_ptr<ThreadCounters>& counters : reg.counters) {
+    for (int i = 0; i < kStageNum; ++i) {
+      ticks[i] += counters->ticks[i].load(memory_order_relaxed);
+      calls[i] += counters->calls[i].load(memory_order_relaxed);
+    }
+  }
+}
+
+string Profiler::Report() {
+  double ticks_per_second = TicksPerSecond();
+  Registry& reg = registry();
+  lock_guard<Mutex> guard(reg.lock);
+
+  Json::Value root;
+  root["enabled"] = enabled();
+  root["elapsed_seconds"] =
+      chrono::duration<double>(chrono::steady_clock::now() - reg.start_time)
+          .count();
+  root["ticks_per_second"] = ticks_per_second;
+
+  uint64_t ticks[kStageNum], calls[kStageNum];
+  Collect(reg, ticks, calls);
+  root["stages"] = StageReport(ticks, calls, ticks_per_second);
+
+  Json::Value threads(Json::arrayValue);
+  for (unique_ptr<ThreadCounters>& counters : reg.counters) {
+    bool used = false;
+    for (int i = 0; i < kStageNum; ++i) {
+      ticks[i] = counters->ticks[i].load(memory_order_relaxed);
+      calls[i] = counters->calls[i].load(memory_order_relaxed);
+      used = used || calls[i] > 0;
+    }
+    if (used == false) continue;
+    Json::Value thread;
+    thread["id"] = counters->id;
+    thread["stages"] = StageReport(ticks, calls, ticks_per_second);
+    threads.append(thread);
+  }
+  root["threads"] = threads;
+
+  Json::StyledWriter writer;
+  return writer.write(root);
+}
+
+string Profiler::Summary() {
+  double ticks_per_second = TicksPerSecond();
+  uint64_t ticks[kStageNum], calls[kStageNum];
+  {
+    Registry& reg = registry();
+    lock_guard<Mutex> guard(reg.lock);
+    Collect(reg, ticks, calls);
+  }
+  string summary = "stage time:";
+  char buf[64];
+  for (int i = 0; i < kStageNum; ++i) {
+    snprintf(buf, sizeof(buf), " %s %.3fs", kStageNames[i],
+             double(ticks[i]) / ticks_per_second);
+    summary += buf;
+  }
+  return summary;
+}
+
+}  // namespace sol
@@ -0,0 +1,416 @@
+/*********************************************************************************
+*     File Name           :     test_model_io.cc
+*     Created By          :     yuewu
+*     Description         :     test saving and loading models
+**********************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <vector>
+#include <sol/sol.h>
+#include <sol/model/online_linear_model.h>
+#include <sol/c_api.h>
+
+using namespace std;
+using namespace sol;
+using namespace sol::pario;
+using namespace sol::model;
+
+/// \brief  predict the test data and write the results to a string
+int predict(Model* model, const string& path, string& result) {
+  DataIter iter(256, 8);
+  if (iter.AddReader(path, "svm") != Status_OK) return Status_IO_Error;
+  ostringstream os;
+  model->Test(iter, &os);
+  result = os.str();
+  return Status_OK;
+}
+
+/// \brief  append the results of sol_Predict
+void append_result(void* user_context, double label, double predict,
+                   int cls_num, float* scores) {
+  vector<float>* results = (vector<float>*)user_context;
+  results->push_back(float(label));
+  results->push_back(float(predict));
+  results->insert(results->end(), scores, scores + cls_num);
+}
+
+/// \brief  sol_PredictBatch fills the arrays as sol_Predict reports
+int test_predict_batch(Model* model, const string& path) {
+  vector<float> expected;
+  DataIter iter(256, 8);
+  if (iter.AddReader(path, "svm") != Status_OK) return Status_IO_Error;
+  int num = sol_Predict(model, &iter, append_result, &expected);
+
+  int clf_num = sol_model_clf_num(model);
+  vector<double> labels(num), predicts(num);
+  vector<float> scores(num * clf_num);
+  DataIter batch_iter(256, 8);
+  if (batch_iter.AddReader(path, "svm") != Status_OK) return Status_IO_Error;
+  if (sol_PredictBatch(model, &batch_iter, num, labels.data(), predicts.data(),
+                       scores.data()) != num) {
+    return Status_Error;
+  }
+  for (int i = 0; i < num; ++i) {
+    const float* result = expected.data() + i * (2 + clf_num);
+    if (float(labels[i]) != result[0] || float(predicts[i]) != result[1] ||
+        equal(result + 2, result + 2 + clf_num,
+              scores.data() + i * clf_num) == false) {
+      return Status_Error;
+    }
+  }
+
+  // the arrays are too small
+  DataIter small_iter(256, 8);
+  if (small_iter.AddReader(path, "svm") != Status_OK) return Status_IO_Error;
+  if (sol_PredictBatch(model, &small_iter, num - 1, labels.data(), nullptr,
+                       nullptr) != -1) {
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  sol_Predict on a list of files read by several readers at the
+/// same time predicts the points of all the files, as the list of paths
+/// passed to pysol
+int test_predict_files(Model* model, const vector<string>& paths) {
+  int clf_num = sol_model_clf_num(model);
+  size_t record_len = size_t(2 + clf_num);
+  vector<vector<float>> expected, results;
+  for (const string& path : paths) {
+    vector<float> result;
+    DataIter iter(256, 8);
+    if (iter.AddReader(path, "svm") != Status_OK) return Status_IO_Error;
+    int num = sol_Predict(model, &iter, append_result, &result);
+    for (int i = 0; i < num; ++i) {
+      expected.emplace_back(result.begin() + i * record_len,
+                            result.begin() + (i + 1) * record_len);
+    }
+  }
+
+  void* data_iter = sol_CreateDataIter(64, 4);
+  sol_SetMaxRunningReaderNum(data_iter, 2);
+  int ret = Status_OK;
+  for (const string& path : paths) {
+    ret = sol_LoadData(data_iter, path.c_str(), "svm", 1);
+    if (ret != Status_OK) break;
+  }
+  vector<float> result;
+  int num = ret == Status_OK
+                ? sol_Predict(model, data_iter, append_result, &result)
+                : 0;
+  sol_ReleaseDataIter(&data_iter);
+  if (ret != Status_OK) return ret;
+  for (int i = 0; i < num; ++i) {
+    results.emplace_back(result.begin() + i * record_len,
+                         result.begin() + (i + 1) * record_len);
+  }
+  // the points of the readers are interleaved
+  sort(expected.begin(), expected.end());
+  sort(results.begin(), results.end());
+  return results == expected ? Status_OK : Status_Error;
+}
+
+/// \brief  training with sol_PartialFitCsr on chunks of the data is the same
+/// as training on the whole data
+int test_partial_fit(const string& algo, const string& train_path,
+                     const string& test_path, const string& expected) {
+  vector<int64_t> indptr(1, 0);
+  vector<int32_t> indices;
+  vector<float> values, labels;
+  unique_ptr<DataReader> reader(DataReader::Create("svm"));
+  if (reader->Open(train_path) != Status_OK) return Status_IO_Error;
+  DataPoint pt;
+  while (reader->Next(pt) == Status_OK) {
+    for (size_t i = 0; i < pt.size(); ++i) {
+      indices.push_back(int32_t(pt.index(i) - 1));
+      values.push_back(float(pt.feature(i)));
+    }
+    indptr.push_back(int64_t(indices.size()));
+    labels.push_back(float(pt.label()));
+  }
+
+  unique_ptr<Model> model(Model::Create(algo, 2));
+  size_t chunk_size = 100;
+  for (size_t begin = 0; begin < labels.size(); begin += chunk_size) {
+    size_t num = min(chunk_size, labels.size() - begin);
+    size_t offset = size_t(indptr[begin]);
+    if (sol_PartialFitCsr(model.get(), indptr.data() + begin, sol_int64,
+                          indices.data() + offset, sol_int32,
+                          values.data() + offset, sol_float32,
+                          labels.data() + begin, sol_float32, num, 1) < 0) {
+      return Status_Error;
+    }
+  }
+  string result;
+  if (predict(model.get(), test_path, result) != Status_OK) {
+    return Status_IO_Error;
+  }
+  return result == expected ? Status_OK : Status_Error;
+}
+
+int test_algo(const string& algo, const string& train_path,
+              const string& test_path, const string& model_path) {
+  unique_ptr<Model> model(Model::Create(algo, 2));
+  if (model == nullptr) return Status_Invalid_Argument;
+  {
+    DataIter iter;
+    if (iter.AddReader(train_path, "svm") != Status_OK) return Status_IO_Error;
+    model->Train(iter);
+  }
+  string expected;
+  if (predict(model.get(), test_path, expected) != Status_OK)
+    return Status_IO_Error;
+  if (test_partial_fit(algo, train_path, test_path, expected) != Status_OK) {
+    cerr << "partial fit of " << algo << " is different from training\n";
+    return Status_Error;
+  }
+
+  // binary models keep the parameters exactly
+  if (model->Save(model_path, true) != Status_OK) return Status_IO_Error;
+  unique_ptr<Model> loaded(Model::Load(model_path));
+  if (loaded == nullptr) return Status_Invalid_Format;
+  string result;
+  if (predict(loaded.get(), test_path, result) != Status_OK)
+    return Status_IO_Error;
+  if (result != expected) {
+    cerr << "binary model of " << algo << " predicts differently\n";
+    return Status_Invalid_Format;
+  }
+
+  // parallel prediction keeps the order of the data
+  loaded->SetParameter("threads", "3");
+  if (predict(loaded.get(), test_path, result) != Status_OK)
+    return Status_IO_Error;
+  if (result != expected) {
+    cerr << "parallel prediction of " << algo << " is different\n";
+    return Status_Invalid_Format;
+  }
+  if (test_predict_batch(loaded.get(), test_path) != Status_OK) {
+    cerr << "batch prediction of " << algo << " is different\n";
+    return Status_Invalid_Format;
+  }
+  if (test_predict_files(loaded.get(), {train_path, test_path}) !=
+      Status_OK) {
+    cerr << "prediction of " << algo << " on a list of files is different\n";
+    return Status_Invalid_Format;
+  }
+
+  // text models saved from a binary model
+  if (loaded->Save(model_path) != Status_OK) return Status_IO_Error;
+  loaded.reset(Model::Load(model_path));
+  if (loaded == nullptr) return Status_Invalid_Format;
+
+  // continue training on a model mapped from file
+  if (model->Save(model_path, true) != Status_OK) return Status_IO_Error;
+  loaded.reset(Model::Load(model_path));
+  if (loaded == nullptr) return Status_Invalid_Format;
+  DataIter iter;
+  if (iter.AddReader(test_path, "svm") != Status_OK) return Status_IO_Error;
+  loaded->Train(iter);
+  unique_ptr<Model> reloaded(Model::Load(model_path));
+  if (reloaded == nullptr ||
+      predict(reloaded.get(), test_path, result) != Status_OK ||
+      result != expected) {
+    cerr << "binary model file of " << algo << " is changed by training\n";
+    return Status_Invalid_Format;
+  }
+  return Status_OK;
+}
+
+/// \brief  scores of the data with the current setting of the model
+void predict_scores(Model* model, const vector<DataPoint>& data,
+                    vector<float>& scores, bool begin_predict = true) {
+  int clf_num = model->clf_num();
+  scores.resize(data.size() * clf_num);
+  if (begin_predict) model->BeginPredict();
+  for (size_t i = 0; i < data.size(); ++i) {
+    model->Predict(data[i], scores.data() + i * clf_num);
+  }
+}
+
+/// \brief  whether the scores are the same up to the order of summation
+bool same_scores(const vector<float>& scores1, const vector<float>& scores2) {
+  if (scores1.size() != scores2.size()) return false;
+  for (size_t i = 0; i < scores1.size(); ++i) {
+    if (fabs(scores1[i] - scores2[i]) > 1e-4f * (1.f + fabs(scores1[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// \brief  multi-class scores of the interleaved weights are the same as the
+/// per-class ones, and the setting is kept by the model files
+int test_interleave(const string& algo, const string& model_path) {
+  // a synthetic multi-class data set with a center per class
+  int cls_num = 5;
+  int feat_num = 64;
+  string data_path = model_path + ".data";
+  {
+    mt19937 gen(7);
+    normal_distribution<float> noise(0, 1);
+    uniform_int_distribution<int> label_dist(0, cls_num - 1);
+    ofstream out(data_path.c_str());
+    for (int i = 0; i < 2000; ++i) {
+      int label = label_dist(gen);
+      out << label;
+      for (int j = 1; j <= feat_num; ++j) {
+        float val = noise(gen) + (j % cls_num == label ? 2.f : 0.f);
+        if (fabs(val) > 0.5f) out << " " << j << ":" << val;
+      }
+      out << "\n";
+    }
+  }
+  vector<DataPoint> data;
+  {
+    unique_ptr<DataReader> reader(DataReader::Create("svm"));
+    if (reader->Open(data_path) != Status_OK) return Status_IO_Error;
+    DataPoint pt;
+    while (reader->Next(pt) == Status_OK) data.push_back(pt.Clone());
+  }
+
+  unique_ptr<Model> model(Model::Create(algo, cls_num));
+  if (model == nullptr) return Status_Invalid_Argument;
+  {
+    DataIter iter;
+    if (iter.AddReader(data_path, "svm") != Status_OK) return Status_IO_Error;
+    model->Train(iter);
+  }
+
+  vector<float> expected, scores;
+  predict_scores(model.get(), data, expected);
+  model->SetParameter("interleave", "true");
+  predict_scores(model.get(), data, scores);
+  if (same_scores(expected, scores) == false) {
+    cerr << "interleaved scores of " << algo << " are different\n";
+    return Status_Error;
+  }
+
+  // the interleaved copy is rebuilt after the weights are changed by training
+  {
+    DataIter iter;
+    if (iter.AddReader(data_path, "svm") != Status_OK) return Status_IO_Error;
+    model->Train(iter);
+  }
+  remove(data_path.c_str());
+  vector<float> stale_scores;
+  // without BeginPredict, the stale copy is not used
+  predict_scores(model.get(), data, stale_scores, false);
+  predict_scores(model.get(), data, scores);
+  model->SetParameter("interleave", "false");
+  predict_scores(model.get(), data, expected);
+  if (same_scores(expected, stale_scores) == false) {
+    cerr << "stale interleaved weights of " << algo << " are used\n";
+    return Status_Error;
+  }
+  if (same_scores(expected, scores) == false) {
+    cerr << "interleaved weights of " << algo << " are not updated\n";
+    return Status_Error;
+  }
+
+  for (int binary = 0; binary < 2; ++binary) {
+    for (int interleave = 0; interleave < 2; ++interleave) {
+      model->SetParameter("interleave", interleave ? "true" : "false");
+      if (model->Save(model_path, binary == 1) != Status_OK) {
+        return Status_IO_Error;
+      }
+      unique_ptr<Model> loaded(Model::Load(model_path));
+      OnlineLinearModel* linear_model =
+          dynamic_cast<OnlineLinearModel*>(loaded.get());
+      if (linear_model == nullptr ||
+          linear_model->interleave() != (interleave == 1)) {
+        cerr << "interleave setting of " << algo << " is not kept in the "
+             << (binary ? "binary" : "text") << " model\n";
+        return Status_Invalid_Format;
+      }
+      predict_scores(loaded.get(), data, scores);
+      if (same_scores(expected, scores) == false) {
+        cerr << "loaded model of " << algo << " predicts differently\n";
+        return Status_Invalid_Format;
+      }
+    }
+  }
+  return Status_OK;
+}
+
+/// \brief  check the timing counters of the training stages
+int test_profiling(const string& train_path) {
+  unique_ptr<Model> model(Model::Create("ogd", 2));
+  DataIter iter;
+  if (iter.AddReader(train_path, "svm") != Status_OK) return Status_IO_Error;
+  sol_ResetProfiling();
+  sol_EnableProfiling(1);
+  model->Train(iter);
+  sol_EnableProfiling(0);
+
+  vector<char> report(size_t(1) << 16);
+  int len = sol_GetProfilingReport(report.data(), int(report.size()));
+  if (len <= 0 || size_t(len) >= report.size() ||
+      sol_GetProfilingReport(nullptr, 0) <= 0) {
+    return Status_Error;
+  }
+  Json::Value root;
+  Json::Reader reader;
+  if (reader.parse(report.data(), root) == false) return Status_Invalid_Format;
+  const Json::Value& stages = root["stages"];
+  Json::UInt64 data_num = stages["preprocess"]["calls"].asUInt64();
+  if (data_num == 0 || stages["predict"]["calls"].asUInt64() != data_num ||
+      stages["gradient"]["calls"].asUInt64() != data_num ||
+      stages["update"]["calls"].asUInt64() > data_num ||
+      stages["read"]["calls"].asUInt64() < data_num ||
+      stages["wait"]["calls"].asUInt64() == 0) {
+    cerr << "timing counters of the training stages are not correct\n"
+         << root;
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(231);
+#endif
+  string train_path = "data/a1a";
+  string test_path = "data/a1a.t";
+  if (argc == 3) {
+    train_path = argv[1];
+    test_path = argv[2];
+  }
+  string model_path = "test_model_io.tmp";
+
+  if (test_profiling(train_path) != Status_OK) {
+    cerr << "test profiling failed\n";
+    return Status_Error;
+  }
+
+  const char* algos[] = {"ogd", "pa", "ada-rda", "cw", "sop"};
+  int ret = Status_OK;
+  for (const char* algo : algos) {
+    ret = test_algo(algo, train_path, test_path, model_path);
+    if (ret != Status_OK) {
+      cerr << "test " << algo << " failed\n";
+      break;
+    }
+    cout << algo << " succeed\n";
+  }
+  const char* multi_class_algos[] = {"ogd", "arow"};
+  for (const char* algo : multi_class_algos) {
+    if (ret != Status_OK) break;
+    ret = test_interleave(algo, model_path);
+    if (ret != Status_OK) cerr << "test interleave of " << algo << " failed\n";
+  }
+  remove(model_path.c_str());
+  if (ret == Status_OK) cout << "test model io succeed\n";
+  return ret;
+}
@@ -0,0 +1,163 @@
+/*********************************************************************************
+*     File Name           :     test_parallel_train.cc
+*     Created By          :     yuewu
+*     Description         :     test training with multiple threads
+**********************************************************************************/
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <json/json.h>
+#include <sol/sol.h>
+#include <sol/model/online_model.h>
+#include <sol/util/profiler.h>
+
+using namespace std;
+using namespace sol;
+using namespace sol::pario;
+using namespace sol::model;
+
+struct TrainResult {
+  long long data_num;
+  int iter_num;
+  float accuracy;
+  // number of threads running the iterations
+  int thread_num;
+  TrainResult() : data_num(0), iter_num(0), accuracy(0), thread_num(0) {}
+};
+
+/// \brief  keep the number of data of the last callback
+void count_data(void* user_context, long long data_num, long long iter_num,
+                long long update_num, double err_rate) {
+  *(long long*)(user_context) = data_num;
+}
+
+// online learners are sensitive to the order of the data, which is changed by
+// the workers, several passes make the results comparable
+static const int kPassNum = 5;
+
+int train(const string& algo, int thread_num, const string& train_path,
+          const string& test_path, TrainResult& result) {
+  unique_ptr<Model> model(Model::Create(algo, 2));
+  if (model == nullptr) return Status_Invalid_Argument;
+  model->SetParameter("threads", to_string(thread_num));
+  OnlineModel* online_model = static_cast<OnlineModel*>(model.get());
+  online_model->set_iterate_callback(count_data, &result.data_num);
+
+  // small mini-batches, so that every worker gets some of them
+  DataIter iter(16, 8);
+  if (iter.AddReader(train_path, "svm", kPassNum) != Status_OK) {
+    return Status_IO_Error;
+  }
+  Profiler::Reset();
+  Profiler::Enable(true);
+  model->Train(iter);
+  Profiler::Enable(false);
+  result.iter_num = online_model->cur_iter_num();
+
+  Json::Value root;
+  Json::Reader reader;
+  if (reader.parse(Profiler::Report(), root) == false) {
+    return Status_Invalid_Format;
+  }
+  result.thread_num = 0;
+  Json::UInt64 predict_num = 0;
+  for (const Json::Value& thread : root["threads"]) {
+    Json::UInt64 calls = thread["stages"]["predict"]["calls"].asUInt64();
+    if (calls > 0) ++result.thread_num;
+    predict_num += calls;
+  }
+  if (predict_num != Json::UInt64(result.iter_num)) {
+    cerr << "predict " << predict_num << " times in " << result.iter_num
+         << " iterations\n";
+    return Status_Error;
+  }
+
+  DataIter test_iter;
+  if (test_iter.AddReader(test_path, "svm") != Status_OK) {
+    return Status_IO_Error;
+  }
+  result.accuracy = 1.f - model->Test(test_iter, nullptr);
+  return Status_OK;
+}
+
+/// \brief  compare training with one thread and multiple threads
+///
+/// \param shared whether the algorithm allows the states to be updated by
+/// multiple threads, or it falls back to a single thread
+int test_algo(const string& algo, bool shared, const string& train_path,
+              const string& test_path, size_t data_num) {
+  TrainResult single, parallel;
+  if (train(algo, 1, train_path, test_path, single) != Status_OK ||
+      train(algo, 4, train_path, test_path, parallel) != Status_OK) {
+    return Status_Error;
+  }
+  cout << algo << ": accuracy " << single.accuracy << " with 1 thread, "
+       << parallel.accuracy << " with 4 threads in " << parallel.thread_num
+       << " workers\n";
+
+  // every instance is trained once in a pass
+  data_num *= kPassNum;
+  if (single.data_num != (long long)(data_num) ||
+      parallel.data_num != (long long)(data_num) ||
+      single.iter_num != int(data_num) || parallel.iter_num != int(data_num)) {
+    cerr << "expect " << data_num << " instances, got " << single.data_num
+         << " (" << single.iter_num << " iterations) with 1 thread, "
+         << parallel.data_num << " (" << parallel.iter_num
+         << " iterations) with 4 threads\n";
+    return Status_Error;
+  }
+  if (single.thread_num != 1 || parallel.thread_num > 4) {
+    cerr << "iterations are run in " << single.thread_num << " and "
+         << parallel.thread_num << " threads\n";
+    return Status_Error;
+  }
+  if (shared == false) {
+    // falls back to training in the calling thread, the same as one thread
+    if (parallel.thread_num != 1 || parallel.accuracy != single.accuracy) {
+      cerr << algo << " is not trained with one thread\n";
+      return Status_Error;
+    }
+    return Status_OK;
+  }
+  // the workers train on the mini-batches in a different order, which moves
+  // the accuracy of pa by up to about 0.025
+  if (fabs(parallel.accuracy - single.accuracy) > 0.04f) {
+    cerr << "accuracy of " << algo << " with multiple threads is out of "
+            "the tolerance\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+  string train_path = "data/a1a";
+  string test_path = "data/a1a.t";
+  size_t data_num = 1605;
+  if (argc == 4) {
+    train_path = argv[1];
+    test_path = argv[2];
+    data_num = size_t(stoul(argv[3]));
+  }
+
+  // algorithms sharing the states between threads
+  const char* shared_algos[] = {"ogd", "pa", "perceptron", "ada-fobos",
+                                "ada-rda"};
+  for (const char* algo : shared_algos) {
+    if (test_algo(algo, true, train_path, test_path, data_num) != Status_OK) {
+      cerr << "test " << algo << " failed\n";
+      return -1;
+    }
+  }
+  // the states of second order algorithms are not shared
+  const char* single_algos[] = {"arow", "cw"};
+  for (const char* algo : single_algos) {
+    if (test_algo(algo, false, train_path, test_path, data_num) != Status_OK) {
+      cerr << "test " << algo << " failed\n";
+      return -1;
+    }
+  }
+  cout << "test parallel train succeed\n";
+  return 0;
+}
@@ -0,0 +1,291 @@
+/*********************************************************************************
+*     File Name           :     test_truncation.cc
+*     Created By          :     yuewu
+*     Description         :     test the incremental truncation of FOFS and PET
+**********************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sol/sol.h>
+#include <sol/model/olm/fofs.h>
+#include <sol/model/olm/ogd.h>
+
+using namespace std;
+using namespace sol;
+using namespace sol::pario;
+using namespace sol::model;
+
+/// \brief  check the features kept after the truncation against a full
+/// recompute of the top B absolute weights
+///
+/// \param abs_w absolute weights before the truncation, features outside the
+/// instance keep the values when they were updated last time, as the heap
+/// \param w_num number of weights of each feature, 0 if the feature is
+/// truncated
+int check_top_B(const vector<real_t>& abs_w, const vector<int>& w_num,
+                index_t B) {
+  // ignore bias
+  vector<real_t> sorted_w(abs_w.begin() + 1, abs_w.end());
+  if (sorted_w.size() <= B) return Status_OK;
+  nth_element(sorted_w.begin(), sorted_w.begin() + B - 1, sorted_w.end(),
+              greater<real_t>());
+  real_t thresh = sorted_w[B - 1];
+  index_t kept_num = 0;
+  for (size_t i = 1; i < abs_w.size(); ++i) {
+    if (w_num[i] == 0) {
+      // only the ties of the B-th weight may be truncated
+      if (abs_w[i] > thresh) {
+        fprintf(stderr, "feature %zu (%g) is truncated, threshold %g\n", i,
+                abs_w[i], thresh);
+        return Status_Error;
+      }
+    } else {
+      ++kept_num;
+      if (abs_w[i] < thresh) {
+        fprintf(stderr, "feature %zu (%g) is kept, threshold %g\n", i,
+                abs_w[i], thresh);
+        return Status_Error;
+      }
+    }
+  }
+  if (kept_num > B) {
+    fprintf(stderr, "%u features are kept, expect at most %u\n",
+            unsigned(kept_num), unsigned(B));
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  FOFS checked after each update against an unscaled reference of
+/// the original algorithm, which recomputes the top B features on all
+/// features
+class CheckedFOFS : public FOFS {
+ public:
+  CheckedFOFS(int class_num) : FOFS(class_num), status_(Status_OK) {}
+
+  int status() const { return this->status_; }
+
+ protected:
+  virtual void Update(const pario::DataPoint& dp, const float* predict,
+                      float loss) {
+    if (this->status_ != Status_OK) return;
+    const auto& x = dp.data();
+    size_t dim = size_t(this->dim_);
+    ref_w_.resize(this->clf_num_);
+    for (vector<double>& ref_w : ref_w_) ref_w.resize(dim, 0);
+    ref_abs_w_.resize(dim, 0);
+
+    // update without truncation
+    index_t B = this->B_;
+    this->B_ = 0;
+    FOFS::Update(dp, predict, loss);
+    this->B_ = B;
+
+    // the original algorithm on unscaled weights
+    for (int c = 0; c < this->clf_num_; ++c) {
+      if (g(c) == 0) continue;
+      vector<double>& ref_w = ref_w_[c];
+      for (double& val : ref_w) val *= this->momentum_;
+      for (size_t i = 0; i < x.size(); ++i) {
+        ref_w[x.index(i)] -= this->eta_ * g(c) * x.value(i);
+      }
+      ref_w[0] -= bias_eta() * g(c);
+      double sq_norm = 0;
+      for (double val : ref_w) sq_norm += val * val;
+      double coeff = this->norm_coeff_ / sqrt(sq_norm);
+      if (coeff < 1) {
+        for (double& val : ref_w) val *= coeff;
+      }
+    }
+    for (size_t i = 0; i < x.size(); ++i) {
+      double val = 0;
+      for (int c = 0; c < this->clf_num_; ++c) val += fabs(ref_w_[c][x.index(i)]);
+      ref_abs_w_[x.index(i)] = val;
+    }
+    vector<real_t> abs_w(ref_abs_w_.begin(), ref_abs_w_.end());
+    if (B > 0) {
+      // truncate the reference with the B-th largest absolute weight
+      vector<double> sorted_w(ref_abs_w_.begin() + 1, ref_abs_w_.end());
+      if (sorted_w.size() > B) {
+        nth_element(sorted_w.begin(), sorted_w.begin() + B - 1,
+                    sorted_w.end(), greater<double>());
+        double thresh = sorted_w[B - 1];
+        for (size_t i = 1; i < dim; ++i) {
+          if (ref_abs_w_[i] >= thresh) continue;
+          for (int c = 0; c < this->clf_num_; ++c) ref_w_[c][i] = 0;
+          ref_abs_w_[i] = 0;
+        }
+      }
+      this->TruncateWeights(dp);
+    }
+
+    vector<int> w_num(dim, 0);
+    double tolerance = 1e-4;
+    for (int c = 0; c < this->clf_num_ && this->status_ == Status_OK; ++c) {
+      double sq_norm = 0, ref_sq_norm = 0;
+      for (size_t i = 0; i < dim; ++i) {
+        double val = double(this->scales_[c]) * w(c)[i];
+        double ref_val = ref_w_[c][i];
+        sq_norm += double(w(c)[i]) * w(c)[i];
+        ref_sq_norm += ref_val * ref_val;
+        if (w(c)[i] != 0) ++w_num[i];
+        if (fabs(val - ref_val) > tolerance * (1 + fabs(ref_val)) ||
+            (val == 0) != (ref_val == 0)) {
+          fprintf(stderr, "weight[%d][%zu] is %g, expect %g\n", c, i, val,
+                  ref_val);
+          this->status_ = Status_Error;
+          break;
+        }
+      }
+      // the squared norm is of the unscaled weights
+      double scaled_sq_norm =
+          this->sq_norms_[c] * this->scales_[c] * this->scales_[c];
+      if (fabs(this->sq_norms_[c] - sq_norm) > tolerance * (1 + sq_norm) ||
+          fabs(scaled_sq_norm - ref_sq_norm) > tolerance * (1 + ref_sq_norm)) {
+        fprintf(stderr, "squared norm of class %d is %g (%g scaled), expect "
+                "%g (%g scaled)\n", c, this->sq_norms_[c], scaled_sq_norm,
+                sq_norm, ref_sq_norm);
+        this->status_ = Status_Error;
+      }
+    }
+    if (this->status_ == Status_OK && B > 0) {
+      this->status_ = check_top_B(abs_w, w_num, B);
+    }
+  }
+
+ protected:
+  int status_;
+  vector<vector<double>> ref_w_;
+  vector<double> ref_abs_w_;
+};
+
+/// \brief  PET checked after each update against a full recompute of the top
+/// B features
+class CheckedPET : public PET {
+ public:
+  CheckedPET(int class_num) : PET(class_num), status_(Status_OK) {}
+
+  int status() const { return this->status_; }
+
+ protected:
+  virtual void Update(const pario::DataPoint& dp, const float* predict,
+                      float loss) {
+    if (this->status_ != Status_OK) return;
+    OGD::Update(dp, predict, loss);
+    index_t B = static_cast<index_t>(this->l0_.lambda());
+    if (B == 0) return;
+
+    // absolute weights seen by the truncation
+    const auto& x = dp.data();
+    size_t dim = size_t(this->dim_);
+    vector<real_t> abs_w(this->abs_weights_.begin(),
+                         this->abs_weights_.begin() + dim);
+    for (size_t i = 0; i < x.size(); ++i) {
+      real_t val = 0;
+      for (int c = 0; c < this->clf_num_; ++c) val += fabs(w(c)[x.index(i)]);
+      abs_w[x.index(i)] = val;
+    }
+    vector<vector<real_t>> old_w(this->clf_num_);
+    for (int c = 0; c < this->clf_num_; ++c) {
+      old_w[c].assign(w(c).begin(), w(c).begin() + dim);
+    }
+
+    this->TruncateWeights(dp);
+
+    vector<int> w_num(dim, 0);
+    for (int c = 0; c < this->clf_num_; ++c) {
+      for (size_t i = 0; i < dim; ++i) {
+        if (w(c)[i] == 0) continue;
+        ++w_num[i];
+        if (w(c)[i] != old_w[c][i]) {
+          fprintf(stderr, "kept weight[%d][%zu] is changed\n", c, i);
+          this->status_ = Status_Error;
+          return;
+        }
+      }
+    }
+    // features outside the instance are zero if they are not in the heap
+    for (size_t i = 1; i < dim; ++i) {
+      if (w_num[i] == 0 && this->abs_weights_[i] != 0) {
+        fprintf(stderr, "absolute weight of truncated feature %zu is %g\n", i,
+                this->abs_weights_[i]);
+        this->status_ = Status_Error;
+        return;
+      }
+    }
+    this->status_ = check_top_B(abs_w, w_num, B);
+  }
+
+ protected:
+  int status_;
+};
+
+/// \brief  write a data set with continuous features, so that the absolute
+/// weights are hardly tied
+void write_data(const string& path, int cls_num, int data_num, int feat_num) {
+  mt19937 gen(13);
+  normal_distribution<float> noise(0, 1);
+  uniform_int_distribution<int> label_dist(0, cls_num - 1);
+  uniform_real_distribution<float> sparsity(0, 1);
+  ofstream out(path.c_str());
+  for (int i = 0; i < data_num; ++i) {
+    int label = label_dist(gen);
+    out << (cls_num == 2 ? label * 2 - 1 : label);
+    for (int j = 1; j <= feat_num; ++j) {
+      if (sparsity(gen) > 0.2f) continue;
+      float val = noise(gen) + (j % cls_num == label ? 1.f : 0.f);
+      out << " " << j << ":" << val;
+    }
+    out << "\n";
+  }
+}
+
+int train(OnlineModel& model, const string& path) {
+  DataIter iter;
+  if (iter.AddReader(path, "svm") != Status_OK) return Status_IO_Error;
+  model.Train(iter);
+  // go on training after the scale factors are applied by Train
+  DataIter iter2;
+  if (iter2.AddReader(path, "svm") != Status_OK) return Status_IO_Error;
+  model.Train(iter2);
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+  string data_path = "test_truncation.tmp";
+  int ret = Status_OK;
+  int cls_nums[] = {2, 3};
+  for (int cls_num : cls_nums) {
+    write_data(data_path, cls_num, 1000, 200);
+    // B=0 keeps all the features
+    for (const char* B : {"0", "10", "50"}) {
+      CheckedFOFS fofs(cls_num);
+      if (string(B) != "0") fofs.SetParameter("B", B);
+      fofs.SetParameter("lambda", "0.01");
+      fofs.SetParameter("eta", "0.1");
+      if (train(fofs, data_path) != Status_OK || fofs.status() != Status_OK) {
+        cerr << "test fofs with " << cls_num << " classes and B=" << B
+             << " failed\n";
+        ret = Status_Error;
+      }
+      CheckedPET pet(cls_num);
+      pet.SetParameter("B", B);
+      if (train(pet, data_path) != Status_OK || pet.status() != Status_OK) {
+        cerr << "test pet with " << cls_num << " classes and B=" << B
+             << " failed\n";
+        ret = Status_Error;
+      }
+    }
+  }
+  remove(data_path.c_str());
+  if (ret != Status_OK) return -1;
+  cout << "test truncation succeed\n";
+  return 0;
+}
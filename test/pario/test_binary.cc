@@ -24,7 +24,7 @@ using namespace std;
 
 #define CHECK_EQ(x, y) assert(std::abs((x) - (y)) < 1e-6)
 
-int test_binary(vector<DataPoint>& dps) {
+int test_binary(vector<DataPoint>& dps, const string& reader_type) {
   const char* out_path = "tmp_test_binary_writer.bin";
   DataWriter* writer = DataWriter::Create("bin");
   if (writer == nullptr) {
@@ -39,18 +39,24 @@ int test_binary(vector<DataPoint>& dps) {
   }
   delete writer;
 
-  DataReader* reader = DataReader::Create("bin");
+  DataReader* reader = DataReader::Create(reader_type);
   if (reader == nullptr) {
-    cerr << "create binary reader failed!\n";
+    cerr << "create " << reader_type << " reader failed!\n";
     return -1;
   }
   if (reader->Open(out_path) != Status_OK) {
+    delete reader;
     return -1;
   }
   vector<DataPoint> dps2;
   DataPoint dp2;
-  while (reader->Next(dp2) == Status_OK) {
-    dps2.push_back(dp2);
+  // read twice to check rewind
+  for (int pass = 0; pass < 2; ++pass) {
+    dps2.clear();
+    while (reader->Next(dp2) == Status_OK) {
+      dps2.push_back(dp2.Clone());
+    }
+    reader->Rewind();
   }
 
   delete reader;
@@ -68,6 +74,11 @@ int test_binary(vector<DataPoint>& dps) {
            << ")\n";
       return Status_Error;
     }
+    if (dps[i].size() != dps2[i].size()) {
+      cerr << "check binary reader failed: feature number of instance " << i
+           << " not the same\n";
+      return Status_Error;
+    }
     for (size_t j = 0; j < dps[i].indexes().size(); ++j) {
       if (dps[i].index(j) != dps2[i].index(j)) {
         cerr << "check svm writer failed: index " << j << " of instance " << i
@@ -106,15 +117,18 @@ int main() {
   }
   DataPoint dp;
   while (reader->Next(dp) == Status_OK) {
-    dps.push_back(dp);
+    dps.push_back(dp.Clone());
   }
 
   delete reader;
 
   int ret = 0;
-  if ((ret = test_binary(dps)) == 0) {
+  if ((ret = test_binary(dps, "bin")) == 0) {
     cout << "check binary reader succeed!\n";
   }
+  if (ret == 0 && (ret = test_binary(dps, "mmapbin")) == 0) {
+    cout << "check memory mapped binary reader succeed!\n";
+  }
 
   return ret;
 }
@@ -0,0 +1,189 @@
+/*********************************************************************************
+*     File Name           :     test_block_binary.cc
+*     Created By          :     yuewu
+*     Description         :     test block binary format (v2) reader and writer
+**********************************************************************************/
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sol/pario/data_iter.h"
+#include "sol/pario/data_reader.h"
+#include "sol/pario/data_writer.h"
+#include "sol/pario/block_binary_reader.h"
+#include "sol/util/util.h"
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+/// \brief  format a data point as a "label idx:val ..." string
+string to_str(const DataPoint& pt) {
+  string str = to_string(pt.label());
+  char buf[64];
+  for (size_t d = 0; d < pt.size(); ++d) {
+    snprintf(buf, 64, " %d:%g", pt.index(d), pt.feature(d));
+    str += buf;
+  }
+  return str;
+}
+
+/// \brief  load all data points of a file
+int load_points(const string& path, const string& dtype,
+                vector<string>& points) {
+  DataReader* reader = DataReader::Create(dtype);
+  if (reader == nullptr) return Status_Invalid_Argument;
+  int ret = reader->Open(path);
+  DataPoint pt;
+  while (ret == Status_OK && (ret = reader->Next(pt)) == Status_OK) {
+    points.push_back(to_str(pt));
+  }
+  delete reader;
+  return ret == Status_EndOfFile ? Status_OK : ret;
+}
+
+/// \brief  load the data points with DataIter
+int load_points_iter(const string& path, int thread_num,
+                     vector<string>& points) {
+  DataIter iter(64, 2);
+  int ret = iter.AddReader(path, "bin2", 1, thread_num, true);
+  if (ret != Status_OK) return ret;
+  MiniBatch* mb = nullptr;
+  while ((mb = iter.Next(mb)) != nullptr) {
+    for (int i = 0; i < mb->size(); ++i) points.push_back(to_str((*mb)[i]));
+  }
+  return Status_OK;
+}
+
+/// \brief  convert the svm data to the block binary format
+int write_bin2(const string& path, const string& out_path,
+               const char* extra_info) {
+  DataReader* reader = DataReader::Create("svm");
+  DataWriter* writer = DataWriter::Create("bin2");
+  int ret = reader->Open(path);
+  if (ret == Status_OK) ret = writer->SetExtraInfo(extra_info);
+  if (ret == Status_OK) ret = writer->Open(out_path);
+  DataPoint pt;
+  while (ret == Status_OK && (ret = reader->Next(pt)) == Status_OK) {
+    ret = writer->Write(pt);
+  }
+  delete reader;
+  delete writer;
+  return ret == Status_EndOfFile ? Status_OK : ret;
+}
+
+int test_block_binary(const string& path, const char* extra_info) {
+  const char* out_path = "tmp_test_block_binary.bin2.tmp";
+  vector<string> expected, points;
+  if (load_points(path, "svm", expected) != Status_OK ||
+      write_bin2(path, out_path, extra_info) != Status_OK) {
+    cerr << "convert " << path << " to bin2 failed\n";
+    return Status_Error;
+  }
+
+  if (load_points(out_path, "bin2", points) != Status_OK ||
+      points != expected) {
+    cerr << "data points of bin2 (" << extra_info << ") are different\n";
+    return Status_Error;
+  }
+
+  // the v1 reader refuses the file
+  points.clear();
+  if (load_points(out_path, "bin", points) == Status_OK) {
+    cerr << "bin2 file is read by the v1 reader\n";
+    return Status_Error;
+  }
+
+  // resume from each block
+  BlockBinaryReader reader;
+  if (reader.Open(out_path) != Status_OK || reader.block_num() == 0) {
+    cerr << "open bin2 file failed\n";
+    return Status_Error;
+  }
+  cout << extra_info << ": " << reader.block_num() << " blocks\n";
+  DataPoint pt;
+  for (size_t b = reader.block_num(); b-- > 0;) {
+    if (reader.SeekBlock(b) != Status_OK || reader.Next(pt) != Status_OK ||
+        to_str(pt) != expected[reader.block_first_instance(b)] ||
+        reader.next_block() != b + 1 ||
+        reader.block_header().inst_num == 0) {
+      cerr << "seek to block " << b << " failed\n";
+      return Status_Error;
+    }
+  }
+  // rewind after reading to the end
+  while (reader.Next(pt) == Status_OK) {
+  }
+  reader.Rewind();
+  if (reader.Next(pt) != Status_OK || to_str(pt) != expected[0]) {
+    cerr << "rewind bin2 reader failed\n";
+    return Status_Error;
+  }
+  reader.Close();
+
+  // parallel read with the block index
+  points.clear();
+  if (load_points_iter(out_path, 3, points) != Status_OK ||
+      points != expected) {
+    cerr << "data points of parallel read are different\n";
+    return Status_Error;
+  }
+  delete_file(out_path);
+  return Status_OK;
+}
+
+/// \brief  corrupt a payload byte, the checksum should fail
+int test_corruption(const string& path) {
+  const char* out_path = "tmp_test_block_binary_corrupt.bin2.tmp";
+  if (write_bin2(path, out_path, "block_size=4096") != Status_OK) {
+    return Status_Error;
+  }
+  size_t offset = 0;
+  {
+    BlockBinaryReader reader;
+    if (reader.Open(out_path) != Status_OK || reader.block_num() < 2) {
+      return Status_Error;
+    }
+    offset = size_t(reader.block_offset(1)) +
+             block_binary::BlockHeader::kSize + 10;
+  }
+  FILE* fp = fopen(out_path, "r+b");
+  if (fp == nullptr) return Status_IO_Error;
+  fseek(fp, long(offset), SEEK_SET);
+  int c = fgetc(fp);
+  fseek(fp, long(offset), SEEK_SET);
+  fputc(c ^ 0x5A, fp);
+  fclose(fp);
+
+  vector<string> points;
+  if (load_points(out_path, "bin2", points) == Status_OK) {
+    cerr << "corrupted block is not detected\n";
+    return Status_Error;
+  }
+  delete_file(out_path);
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  string path = "data/a1a";
+  if (argc == 2) path = argv[1];
+
+  const char* extra_infos[] = {"", "block_size=4096",
+                               "codec=none,block_size=4096",
+                               "index_codec=varint,block_size=4096"};
+  for (const char* extra_info : extra_infos) {
+    if (test_block_binary(path, extra_info) != Status_OK) return -1;
+  }
+  if (test_corruption(path) != Status_OK) return -1;
+  cout << "test block binary succeed\n";
+  return 0;
+}
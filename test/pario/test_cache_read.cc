@@ -0,0 +1,123 @@
+/*********************************************************************************
+*     File Name           :     test_cache_read.cc
+*     Created By          :     yuewu
+*     Description         :     test reading multiple passes from the cache
+**********************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <iostream>
+#include <algorithm>
+
+#include "sol/pario/data_iter.h"
+#include "sol/util/util.h"
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+/// \brief  format a data point as "label idx:val ..."
+string to_line(const DataPoint& dp) {
+  char buf[64];
+  string line = to_string(dp.label());
+  for (size_t d = 0; d < dp.size(); ++d) {
+    snprintf(buf, 64, " %d:%g", dp.index(d), dp.feature(d));
+    line += buf;
+  }
+  return line;
+}
+
+/// \brief  load the data as a list of lines
+int load(DataIter& iter, vector<string>& lines) {
+  MiniBatch* mb = nullptr;
+  while ((mb = iter.Next(mb)) != nullptr) {
+    for (int i = 0; i < mb->size(); ++i) {
+      lines.push_back(to_line((*mb)[i]));
+    }
+  }
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  string path = "data/a1a";
+  string dtype = "svm";
+  if (argc == 3) {
+    path = argv[1];
+    dtype = argv[2];
+  }
+  int pass_num = 3;
+  string cache_path = "test_cache_read.tmp";
+
+  vector<string> expected;
+  {
+    DataIter iter(64, 2);
+    if (iter.AddReader(path, dtype, pass_num) != Status_OK) return -1;
+    load(iter, expected);
+  }
+  cout << "parsed: " << expected.size() << " instances\n";
+  vector<string> sorted_expected(expected);
+  sort(sorted_expected.begin(), sorted_expected.end());
+
+  // in memory, spilled to disk, and not cached as it exceeds the limit
+  size_t cache_sizes[] = {0, 1024, 1024};
+  const char* cache_paths[] = {"", cache_path.c_str(), ""};
+  for (int i = 0; i < 3; ++i) {
+    for (int shuffle = 0; shuffle < 2; ++shuffle) {
+      DataIter iter(64, 2);
+      if (iter.AddCachedReader(path, dtype, pass_num, shuffle == 1,
+                               cache_sizes[i], cache_paths[i]) != Status_OK)
+        return -1;
+      vector<string> lines;
+      double start_time = get_current_time();
+      load(iter, lines);
+      cout << "cache size " << cache_sizes[i] << ", cache path '"
+           << cache_paths[i] << "', shuffle " << shuffle << ": "
+           << lines.size() << " instances, " << get_current_time() - start_time
+           << " seconds\n";
+      // the first pass is always in the original order
+      if (lines.size() != expected.size() ||
+          equal(expected.begin(), expected.begin() + expected.size() / pass_num,
+                lines.begin()) == false) {
+        cerr << "the first pass is different!\n";
+        return -1;
+      }
+      if (shuffle == 0 || cache_paths[i][0] != '\0' || cache_sizes[i] != 0) {
+        if (lines != expected) {
+          cerr << "cached result is different!\n";
+          return -1;
+        }
+      } else {
+        sort(lines.begin(), lines.end());
+        if (lines != sorted_expected) {
+          cerr << "shuffled cached result is different!\n";
+          return -1;
+        }
+      }
+    }
+  }
+  if (FILE* fp = fopen(cache_path.c_str(), "r")) {
+    fclose(fp);
+    cerr << "cache file is not removed!\n";
+    return -1;
+  }
+
+  // stop iteration before the data is exhausted
+  {
+    DataIter iter(16, 2);
+    iter.AddCachedReader(path, dtype, pass_num, true);
+    MiniBatch* mb = iter.Next(nullptr);
+    if (mb == nullptr) return -1;
+  }
+
+  cout << "test cache read succeed\n";
+  return 0;
+}
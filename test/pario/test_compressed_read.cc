@@ -0,0 +1,182 @@
+/*********************************************************************************
+*     File Name           :     test_compressed_read.cc
+*     Created By          :     yuewu
+*     Description         :     test reading gzip and zstd compressed files
+**********************************************************************************/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#include "sol/pario/data_iter.h"
+#include "sol/pario/file_reader.h"
+#include "sol/util/util.h"
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+/// \brief  load the file as a list of lines
+int load_lines(FileReader& reader, vector<string>& lines) {
+  char* line = nullptr;
+  size_t len = 0;
+  int ret = Status_OK;
+  while ((ret = reader.ReadLine(line, len)) == Status_OK) {
+    lines.push_back(string(line, len));
+  }
+  return ret == Status_EndOfFile ? Status_OK : ret;
+}
+
+/// \brief  load the data as a list of "label idx:val ..." strings
+int load_points(const string& path, int pass_num, int thread_num,
+                vector<string>& points) {
+  DataIter iter(64, 2);
+  int ret = iter.AddReader(path, "svm", pass_num, thread_num);
+  if (ret != Status_OK) return ret;
+  MiniBatch* mb = nullptr;
+  char buf[64];
+  while ((mb = iter.Next(mb)) != nullptr) {
+    for (int i = 0; i < mb->size(); ++i) {
+      const DataPoint& pt = (*mb)[i];
+      string str = to_string(pt.label());
+      for (size_t d = 0; d < pt.size(); ++d) {
+        snprintf(buf, 64, " %d:%g", pt.index(d), pt.feature(d));
+        str += buf;
+      }
+      points.push_back(str);
+    }
+  }
+  return Status_OK;
+}
+
+/// \brief  read a file as a string
+string read_file(const string& path) {
+  string data;
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (fp == nullptr) return data;
+  char buf[4096];
+  size_t len = 0;
+  while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) data.append(buf, len);
+  fclose(fp);
+  return data;
+}
+
+/// \brief  compress the data in two members or frames
+int compress(const string& data, const string& format, const string& path) {
+  size_t half = data.size() / 2;
+#ifdef HAS_ZLIB
+  if (format == "gzip") {
+    const char* modes[] = {"wb", "ab"};
+    for (int i = 0; i < 2; ++i) {
+      gzFile gz = gzopen(path.c_str(), modes[i]);
+      if (gz == nullptr) return Status_IO_Error;
+      size_t begin = i == 0 ? 0 : half;
+      size_t len = i == 0 ? half : data.size() - half;
+      gzwrite(gz, data.data() + begin, unsigned(len));
+      gzclose(gz);
+    }
+    return Status_OK;
+  }
+#endif
+#ifdef HAS_ZSTD
+  if (format == "zstd") {
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (fp == nullptr) return Status_IO_Error;
+    for (int i = 0; i < 2; ++i) {
+      size_t begin = i == 0 ? 0 : half;
+      size_t len = i == 0 ? half : data.size() - half;
+      vector<char> dst(ZSTD_compressBound(len));
+      size_t dst_len =
+          ZSTD_compress(dst.data(), dst.size(), data.data() + begin, len, 3);
+      fwrite(dst.data(), 1, dst_len, fp);
+    }
+    fclose(fp);
+    return Status_OK;
+  }
+#endif
+  (void)half;
+  (void)path;
+  cout << format << " is not supported, skipped\n";
+  return Status_Invalid_Argument;
+}
+
+int test_format(const string& path, const string& format) {
+  string zpath = "test_compressed_read." + format + ".tmp";
+  string data = read_file(path);
+  if (compress(data, format, zpath) != Status_OK) return Status_OK;
+
+  vector<string> expected, lines;
+  FileReader plain_reader(path.c_str(), "r");
+  if (load_lines(plain_reader, expected) != Status_OK) return Status_IO_Error;
+
+  {
+    FileReader reader(zpath.c_str(), "r");
+    if (reader.Good() == false || reader.IsCompressed() == false ||
+        reader.Size() != -1) {
+      cerr << format << " file is not detected\n";
+      return Status_Error;
+    }
+    double start_time = get_current_time();
+    // twice to test rewind
+    for (int pass = 0; pass < 2; ++pass) {
+      lines.clear();
+      if (load_lines(reader, lines) != Status_OK || lines != expected) {
+        cerr << "lines of the " << format << " file are different\n";
+        return Status_Error;
+      }
+      reader.Rewind();
+    }
+    cout << format << ": " << lines.size() << " lines, "
+         << get_current_time() - start_time << " seconds\n";
+  }
+
+  // the parallel reader falls back to one parser
+  vector<string> points, zpoints;
+  load_points(path, 2, 1, points);
+  if (load_points(zpath, 2, 2, zpoints) != Status_OK || points != zpoints) {
+    cerr << "points of the " << format << " file are different\n";
+    return Status_Error;
+  }
+
+  // truncated file
+  string zdata = read_file(zpath);
+  FILE* fp = fopen(zpath.c_str(), "wb");
+  fwrite(zdata.data(), 1, zdata.size() - 7, fp);
+  fclose(fp);
+  {
+    FileReader reader(zpath.c_str(), "r");
+    lines.clear();
+    if (load_lines(reader, lines) == Status_OK || reader.Good() == true) {
+      cerr << "truncated " << format << " file is not detected\n";
+      return Status_Error;
+    }
+  }
+  remove(zpath.c_str());
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  string path = "data/a1a";
+  if (argc == 2) path = argv[1];
+
+  if (test_format(path, "gzip") != Status_OK) return -1;
+  if (test_format(path, "zstd") != Status_OK) return -1;
+  cout << "test compressed read succeed\n";
+  return 0;
+}
@@ -9,7 +9,10 @@
 #include <string>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <vector>
 
+#include "sol/pario/data_reader.h"
 #include "sol/pario/file_reader.h"
 #include "sol/util/error_code.h"
 
@@ -17,6 +20,208 @@ using namespace sol;
 using namespace sol::pario;
 using namespace std;
 
+// size of the chunks read by FileReader, kReadChunkSize in file_reader.cc
+static const size_t kChunkSize = 1 << 20;
+
+int write_file(const string& path, const string& content) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) return Status_IO_Error;
+  size_t len = fwrite(content.data(), 1, content.size(), file);
+  fclose(file);
+  return len == content.size() ? Status_OK : Status_IO_Error;
+}
+
+/// \brief  split the content into lines as fgets, the newlines are kept
+vector<string> split_lines(const string& content) {
+  vector<string> lines;
+  size_t begin = 0;
+  while (begin < content.size()) {
+    size_t end = content.find('\n', begin);
+    end = end == string::npos ? content.size() : end + 1;
+    lines.push_back(content.substr(begin, end - begin));
+    begin = end;
+  }
+  return lines;
+}
+
+/// \brief  read the content with both versions of ReadLine and compare the
+/// lines and offsets with the expected ones
+int check_lines(const string& path, const string& content) {
+  vector<string> lines = split_lines(content);
+  if (write_file(path, content) != Status_OK) return Status_IO_Error;
+
+  FileReader reader(path.c_str(), "r");
+  if (reader.Good() == false) return Status_IO_Error;
+  char* line = nullptr;
+  size_t len = 0;
+  int64_t offset = 0;
+  for (const string& expected : lines) {
+    offset += int64_t(expected.size());
+    size_t expected_len = expected.size();
+    if (expected.back() == '\n') --expected_len;
+    if (reader.ReadLine(line, len) != Status_OK || len != expected_len ||
+        memcmp(line, expected.data(), len) != 0 || line[len] != '\0' ||
+        reader.Tell() != offset) {
+      cerr << "line of " << expected_len << " bytes at " << offset
+           << " is not read correctly\n";
+      return Status_Error;
+    }
+  }
+  if (reader.ReadLine(line, len) != Status_EndOfFile) {
+    cerr << "end of file is not reached\n";
+    return Status_Error;
+  }
+
+  // the fgets compatible version keeps the newlines, start with a small
+  // buffer so that it is reallocated
+  reader.Rewind();
+  int buf_len = 4;
+  char* buf = (char*)malloc(buf_len);
+  int ret = Status_OK;
+  for (const string& expected : lines) {
+    if (reader.ReadLine(buf, buf_len) != Status_OK ||
+        expected != string(buf) || buf_len < int(expected.size()) + 1) {
+      cerr << "line of " << expected.size()
+           << " bytes is not read as fgets does\n";
+      ret = Status_Error;
+      break;
+    }
+  }
+  if (ret == Status_OK && reader.ReadLine(buf, buf_len) != Status_EndOfFile) {
+    ret = Status_Error;
+  }
+  free(buf);
+  return ret;
+}
+
+/// \brief  lines around and longer than the chunk size, and the last line
+/// without newline
+int test_lines(const string& path) {
+  vector<size_t> line_lens = {0,
+                              1,
+                              kChunkSize - 2,
+                              kChunkSize - 1,
+                              kChunkSize,
+                              kChunkSize + 1,
+                              5,
+                              3 * kChunkSize + 7,
+                              2};
+  string content;
+  for (size_t i = 0; i < line_lens.size(); ++i) {
+    content.append(line_lens[i], char('a' + i));
+    content += '\n';
+  }
+  if (check_lines(path, content) != Status_OK) return Status_Error;
+  // the last line without newline
+  content.resize(content.size() - 1);
+  if (check_lines(path, content) != Status_OK) return Status_Error;
+  // a file of a single line without newline filling up the buffer
+  if (check_lines(path, string(kChunkSize, 'x')) != Status_OK) {
+    return Status_Error;
+  }
+  return check_lines(path, "x");
+}
+
+/// \brief  the carriage returns are kept in the lines as fgets, and skipped
+/// by the parsers
+int test_crlf(const string& path) {
+  if (check_lines(path, "a\r\n\r\nb\r\r\n\rc\r") != Status_OK) {
+    return Status_Error;
+  }
+  string content = "1 2:3\r\n-1 4:0.5 7:1\r\n1 9:2\r\n";
+  if (check_lines(path, content) != Status_OK) return Status_Error;
+
+  unique_ptr<DataReader> reader(DataReader::Create("svm"));
+  if (reader == nullptr || reader->Open(path) != Status_OK) {
+    return Status_IO_Error;
+  }
+  DataPoint pt;
+  vector<int> labels;
+  vector<size_t> sizes;
+  int ret = Status_OK;
+  while ((ret = reader->Next(pt)) == Status_OK) {
+    labels.push_back(pt.label());
+    sizes.push_back(pt.size());
+  }
+  if (ret != Status_EndOfFile || labels != vector<int>({1, -1, 1}) ||
+      sizes != vector<size_t>({1, 2, 1}) || pt.index(0) != 9 ||
+      pt.feature(0) != 2) {
+    cerr << "data with CRLF line endings is not parsed correctly\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  Read and ReadLine on the same reader, and Seek and Rewind after
+/// partial reads
+int test_mixed_read(const string& path) {
+  string content = "first line\nsecond line\n";
+  // more than a chunk, so that the buffer is refilled
+  content += string(kChunkSize, 'z') + "\nlast line";
+  if (write_file(path, content) != Status_OK) return Status_IO_Error;
+
+  FileReader reader(path.c_str(), "r");
+  char* line = nullptr;
+  size_t len = 0;
+  char buf[16];
+  // Read continues after the line
+  if (reader.ReadLine(line, len) != Status_OK || string(line) != "first line" ||
+      reader.Read(buf, 7) != Status_OK || string(buf, 7) != "second " ||
+      reader.Tell() != 18) {
+    cerr << "Read after ReadLine failed\n";
+    return Status_Error;
+  }
+  // ReadLine continues after the data read
+  if (reader.ReadLine(line, len) != Status_OK || string(line) != "line" ||
+      reader.Tell() != 23) {
+    cerr << "ReadLine after Read failed\n";
+    return Status_Error;
+  }
+  // Read across the buffer refill, then the last line
+  vector<char> data(kChunkSize + 1);
+  if (reader.Read(data.data(), data.size()) != Status_OK ||
+      data.back() != '\n' || data[kChunkSize - 1] != 'z' ||
+      reader.ReadLine(line, len) != Status_OK ||
+      string(line) != "last line" ||
+      reader.ReadLine(line, len) != Status_EndOfFile ||
+      reader.Read(buf, 1) != Status_EndOfFile) {
+    cerr << "Read across the buffer failed\n";
+    return Status_Error;
+  }
+
+  // seek into the middle of a line after the end of file
+  if (reader.Seek(6) != Status_OK || reader.Tell() != 6 ||
+      reader.ReadLine(line, len) != Status_OK || string(line) != "line" ||
+      reader.Tell() != 11) {
+    cerr << "seek after the end of file failed\n";
+    return Status_Error;
+  }
+  // seek back after a partial read of the buffer
+  if (reader.Read(buf, 3) != Status_OK || reader.Seek(11) != Status_OK ||
+      reader.ReadLine(line, len) != Status_OK ||
+      string(line) != "second line") {
+    cerr << "seek after partial read failed\n";
+    return Status_Error;
+  }
+  // rewind in the middle of the file
+  if (reader.Read(buf, 5) != Status_OK) return Status_Error;
+  reader.Rewind();
+  if (reader.Tell() != 0 || reader.ReadLine(line, len) != Status_OK ||
+      string(line) != "first line") {
+    cerr << "rewind after partial read failed\n";
+    return Status_Error;
+  }
+  // seek to the last line
+  int64_t last_offset = int64_t(content.size()) - 9;
+  if (reader.Seek(last_offset) != Status_OK ||
+      reader.Read(buf, 4) != Status_OK || string(buf, 4) != "last" ||
+      reader.ReadLine(line, len) != Status_OK || string(line) != " line") {
+    cerr << "seek to the last line failed\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
 int main(int argc, char** args) {
 // check memory leak in VC++
 #if defined(_MSC_VER) && defined(_DEBUG)
@@ -26,6 +231,21 @@ int main(int argc, char** args) {
 //_CrtSetBreakAlloc(368);
 #endif
 
+  string tmp_path = "test_file_reader.tmp";
+  int ret = Status_OK;
+  if (test_lines(tmp_path) != Status_OK) {
+    cerr << "test lines failed\n";
+    ret = Status_Error;
+  } else if (test_crlf(tmp_path) != Status_OK) {
+    cerr << "test CRLF failed\n";
+    ret = Status_Error;
+  } else if (test_mixed_read(tmp_path) != Status_OK) {
+    cerr << "test mixed read failed\n";
+    ret = Status_Error;
+  }
+  remove(tmp_path.c_str());
+  if (ret != Status_OK) return -1;
+
   FileReader reader;
   string path = "data/a1a";
   if (argc > 1) {
@@ -39,7 +259,7 @@ int main(int argc, char** args) {
   }
   cout << "test readline\n";
   int buf_len = 1024;
-  char* buf = new char[buf_len];
+  char* buf = (char*)malloc(buf_len);
   size_t file_len = 0;
   for (int i = 0; i < 10; ++i) {
     cerr << "\tread round " << i << "\t";
@@ -77,7 +297,7 @@ int main(int argc, char** args) {
     }
   }
 
-  delete[] buf;
+  free(buf);
   cerr << "program exited with code " << status << "\n";
   return status;
 }
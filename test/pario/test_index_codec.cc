@@ -0,0 +1,203 @@
+/*********************************************************************************
+*     File Name           :     test_index_codec.cc
+*     Created By          :     yuewu
+*     Description         :     test and benchmark the index codecs
+**********************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sol/util/types.h>
+#include <sol/util/util.h>
+#include <sol/util/error_code.h>
+#include <sol/pario/compress.h>
+#include <sol/pario/data_reader.h>
+#include <sol/pario/index_codec.h>
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+const int kCodecTypes[] = {kIndexCodecVarint, kIndexCodecStreamVByte};
+
+/// \brief  random sorted indexes, the deltas take 1 to 4 bytes
+void random_indexes(mt19937& gen, size_t num, math::Vector<index_t>& indexes) {
+  uniform_int_distribution<int> len_dis(0, 3);
+  uniform_int_distribution<uint32_t> dis;
+  indexes.clear();
+  index_t last = 0;
+  for (size_t i = 0; i < num; ++i) {
+    uint32_t delta = dis(gen) >> (8 * len_dis(gen) + 2);
+    last += index_t(delta);
+    indexes.push_back(last);
+  }
+}
+
+/// \brief  check the round trip of the codecs
+int check_codecs() {
+  mt19937 gen(0);
+  math::Vector<index_t> indexes;
+  math::Vector<char> codes, v1_codes;
+  vector<index_t> decoded;
+  for (int type : kCodecTypes) {
+    const IndexCodec* codec = IndexCodec::Get(type);
+    if (codec == nullptr || IndexCodec::Get(codec->name()) != codec) {
+      cerr << "get index codec " << type << " failed\n";
+      return Status_Error;
+    }
+    for (size_t num = 0; num < 300; ++num) {
+      random_indexes(gen, num, indexes);
+      codes.clear();
+      if (codec->Encode(indexes.begin(), num, codes) != Status_OK) {
+        cerr << codec->name() << ": encode " << num << " indexes failed\n";
+        return Status_Error;
+      }
+      // the varint codec is the same as the binary format (v1)
+      v1_codes.clear();
+      comp_index(indexes, v1_codes);
+      if (type == kIndexCodecVarint &&
+          (v1_codes.size() != codes.size() ||
+           memcmp(v1_codes.begin(), codes.begin(), codes.size()) != 0)) {
+        cerr << "varint codes are different from the v1 format\n";
+        return Status_Error;
+      }
+
+      decoded.assign(num + 1, 0);
+      if (codec->Decode(codes.begin(), codes.size(), decoded.data(), num) !=
+              Status_OK ||
+          equal(indexes.begin(), indexes.end(), decoded.begin()) == false) {
+        cerr << codec->name() << ": decode " << num << " indexes failed\n";
+        return Status_Error;
+      }
+      // wrong number of indexes or truncated codes
+      if (num > 0 &&
+          (codec->Decode(codes.begin(), codes.size(), decoded.data(),
+                         num - 1) == Status_OK ||
+           codec->Decode(codes.begin(), codes.size() - 1, decoded.data(),
+                         num) == Status_OK)) {
+        cerr << codec->name() << ": invalid codes are not detected\n";
+        return Status_Error;
+      }
+    }
+  }
+  return Status_OK;
+}
+
+/// \brief  load the indexes of a data file, or random indexes if the path is
+/// "random"
+int load_indexes(const string& path,
+                 vector<math::Vector<index_t>>& instances) {
+  if (path == "random") {
+    mt19937 gen(0);
+    instances.resize(10000);
+    for (math::Vector<index_t>& indexes : instances) {
+      random_indexes(gen, 100, indexes);
+    }
+    return Status_OK;
+  }
+  DataReader* reader = DataReader::Create("svm");
+  if (reader == nullptr || reader->Open(path) != Status_OK) {
+    delete reader;
+    return Status_IO_Error;
+  }
+  DataPoint pt;
+  while (reader->Next(pt) == Status_OK) {
+    instances.push_back(pt.Clone().indexes());
+  }
+  delete reader;
+  return Status_OK;
+}
+
+/// \brief  benchmark the decoding of the indexes of a data file
+int benchmark(const string& path) {
+  vector<math::Vector<index_t>> instances;
+  if (load_indexes(path, instances) != Status_OK) return Status_IO_Error;
+  size_t index_num = 0;
+  for (const math::Vector<index_t>& indexes : instances) {
+    index_num += indexes.size();
+  }
+
+  vector<index_t> decoded(index_num);
+  double gb = double(index_num * sizeof(index_t)) / (1 << 30);
+  int repeat = int(0.25 / gb) + 1;
+  cout << path << ": " << instances.size() << " instances, " << index_num
+       << " indexes\n";
+
+  for (int type : kCodecTypes) {
+    const IndexCodec* codec = IndexCodec::Get(type);
+    math::Vector<char> codes;
+    vector<size_t> lens;
+    for (const math::Vector<index_t>& indexes : instances) {
+      size_t offset = codes.size();
+      codec->Encode(indexes.begin(), indexes.size(), codes);
+      lens.push_back(codes.size() - offset);
+    }
+
+    double best_time = 0;
+    for (int round = 0; round < 3; ++round) {
+      double start_time = get_current_time();
+      for (int r = 0; r < repeat; ++r) {
+        const char* p = codes.begin();
+        index_t* dst = decoded.data();
+        for (size_t i = 0; i < instances.size(); ++i) {
+          size_t num = instances[i].size();
+          if (codec->Decode(p, lens[i], dst, num) != Status_OK) {
+            cerr << codec->name() << ": decode instance " << i << " failed\n";
+            return Status_Error;
+          }
+          p += lens[i];
+          dst += num;
+        }
+      }
+      double cur_time = get_current_time() - start_time;
+      if (round == 0 || cur_time < best_time) best_time = cur_time;
+    }
+    printf("  %-12s %.2f bytes/index, decode %.2f GB/s\n", codec->name(),
+           double(codes.size()) / index_num, gb * repeat / best_time);
+  }
+
+  // decoding by push_back into a vector, as the binary format (v1) did
+  vector<math::Vector<char>> inst_codes(instances.size());
+  for (size_t i = 0; i < instances.size(); ++i) {
+    comp_index(instances[i], inst_codes[i]);
+  }
+  math::Vector<index_t> indexes;
+  double best_time = 0;
+  for (int round = 0; round < 3; ++round) {
+    double start_time = get_current_time();
+    for (int r = 0; r < repeat; ++r) {
+      for (size_t i = 0; i < instances.size(); ++i) {
+        decomp_index(inst_codes[i], indexes);
+      }
+    }
+    double cur_time = get_current_time() - start_time;
+    if (round == 0 || cur_time < best_time) best_time = cur_time;
+  }
+  printf("  %-12s decode %.2f GB/s\n", "push_back", gb * repeat / best_time);
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  if (check_codecs() != Status_OK) return -1;
+
+  vector<string> paths = {"data/a1a", "random"};
+  if (argc > 1) paths.assign(argv + 1, argv + argc);
+  for (const string& path : paths) {
+    if (benchmark(path) != Status_OK) return -1;
+  }
+  cout << "test index codec succeed\n";
+  return 0;
+}
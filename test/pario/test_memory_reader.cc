@@ -0,0 +1,244 @@
+/*********************************************************************************
+*     File Name           :     test_memory_reader.cc
+*     Created By          :     yuewu
+*     Description         :     test reading dense and csr matrices in memory
+**********************************************************************************/
+
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <sol/util/error_code.h>
+#include <sol/pario/data_iter.h>
+#include <sol/pario/memory_reader.h>
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+const size_t kRows = 100;
+const size_t kCols = 50;
+
+/// \brief  a random matrix with about 1/5 non-zero values, all of which are
+/// exact in float
+struct Matrix {
+  vector<double> dense;
+  vector<double> labels;
+  vector<int64_t> indptr;
+  vector<int64_t> indices;
+  vector<double> values;
+
+  Matrix() : dense(kRows * kCols, 0), labels(kRows), indptr(1, 0) {
+    mt19937 gen(0);
+    uniform_int_distribution<int> dis(-8, 8);
+    for (size_t i = 0; i < kRows; ++i) {
+      labels[i] = i % 2 == 0 ? 1 : -1;
+      for (size_t j = 0; j < kCols; ++j) {
+        if (gen() % 5 != 0) continue;
+        double val = dis(gen) * 0.5;
+        if (val == 0) continue;
+        dense[i * kCols + j] = val;
+        indices.push_back(int64_t(j));
+        values.push_back(val);
+      }
+      indptr.push_back(int64_t(indices.size()));
+    }
+  }
+};
+
+template <typename T, typename S>
+vector<T> convert(const vector<S>& src) {
+  return vector<T>(src.begin(), src.end());
+}
+
+/// \brief  check that the reader returns the rows of the matrix
+int check(MemoryReader* reader, const Matrix& mat, const char* name) {
+  unique_ptr<MemoryReader> guard(reader);
+  if (reader == nullptr || reader->Open("") != Status_OK) {
+    cerr << name << ": create reader failed\n";
+    return Status_Error;
+  }
+  DataPoint pt;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < kRows; ++i) {
+      if (reader->Next(pt) != Status_OK || pt.label() != mat.labels[i] ||
+          pt.size() != size_t(mat.indptr[i + 1] - mat.indptr[i])) {
+        cerr << name << ": row " << i << " is not correct\n";
+        return Status_Error;
+      }
+      for (size_t k = 0; k < pt.size(); ++k) {
+        size_t pos = size_t(mat.indptr[i]) + k;
+        if (pt.index(k) != index_t(mat.indices[pos] + 1) ||
+            pt.feature(k) != real_t(mat.values[pos])) {
+          cerr << name << ": feature " << k << " of row " << i
+               << " is not correct\n";
+          return Status_Error;
+        }
+      }
+    }
+    if (reader->Next(pt) != Status_EndOfFile) {
+      cerr << name << ": end of data is not detected\n";
+      return Status_Error;
+    }
+    reader->Rewind();
+  }
+  return Status_OK;
+}
+
+int test_dense(const Matrix& mat) {
+  vector<float> dense32 = convert<float>(mat.dense);
+  vector<int32_t> labels32 = convert<int32_t>(mat.labels);
+  if (check(MemoryReader::CreateDense(mat.dense.data(), kMemFloat64,
+                                      mat.labels.data(), kMemFloat64, kRows,
+                                      kCols, kCols * sizeof(double)),
+            mat, "dense float64") != Status_OK ||
+      check(MemoryReader::CreateDense(dense32.data(), kMemFloat32,
+                                      labels32.data(), kMemInt32, kRows, kCols,
+                                      kCols * sizeof(float)),
+            mat, "dense float32") != Status_OK) {
+    return Status_Error;
+  }
+
+  // rows with padding, like a slice of the columns of a wider matrix
+  vector<float> wide(kRows * (kCols + 3), 7.f);
+  for (size_t i = 0; i < kRows; ++i) {
+    copy(dense32.begin() + i * kCols, dense32.begin() + (i + 1) * kCols,
+         wide.begin() + i * (kCols + 3));
+  }
+  return check(MemoryReader::CreateDense(wide.data(), kMemFloat32,
+                                         mat.labels.data(), kMemFloat64, kRows,
+                                         kCols, (kCols + 3) * sizeof(float)),
+               mat, "dense strided");
+}
+
+int test_csr(const Matrix& mat) {
+  vector<int32_t> indptr32 = convert<int32_t>(mat.indptr);
+  vector<int32_t> indices32 = convert<int32_t>(mat.indices);
+  vector<float> values32 = convert<float>(mat.values);
+  if (check(MemoryReader::CreateCsr(indptr32.data(), kMemInt32,
+                                    indices32.data(), kMemInt32,
+                                    values32.data(), kMemFloat32,
+                                    mat.labels.data(), kMemFloat64, kRows,
+                                    true),
+            mat, "csr int32/float32") != Status_OK ||
+      check(MemoryReader::CreateCsr(mat.indptr.data(), kMemInt64,
+                                    mat.indices.data(), kMemInt64,
+                                    mat.values.data(), kMemFloat64,
+                                    mat.labels.data(), kMemFloat64, kRows,
+                                    true),
+            mat, "csr int64/float64") != Status_OK) {
+    return Status_Error;
+  }
+
+  // rows not in canonical format are sorted
+  vector<int64_t> indices = mat.indices;
+  vector<double> values = mat.values;
+  for (size_t i = 0; i < kRows; ++i) {
+    size_t begin = size_t(mat.indptr[i]), end = size_t(mat.indptr[i + 1]);
+    reverse(indices.begin() + begin, indices.begin() + end);
+    reverse(values.begin() + begin, values.begin() + end);
+  }
+  if (check(MemoryReader::CreateCsr(indptr32.data(), kMemInt32, indices.data(),
+                                    kMemInt64, values.data(), kMemFloat64,
+                                    mat.labels.data(), kMemFloat64, kRows,
+                                    false),
+            mat, "csr not canonical") != Status_OK) {
+    return Status_Error;
+  }
+
+  // invalid types
+  if (MemoryReader::CreateCsr(indptr32.data(), kMemFloat32, indices32.data(),
+                              kMemInt32, values32.data(), kMemFloat32, nullptr,
+                              kMemFloat64, kRows, true) != nullptr ||
+      MemoryReader::CreateDense(indptr32.data(), kMemInt32, nullptr,
+                                kMemFloat64, kRows, kCols,
+                                kCols * sizeof(int32_t)) != nullptr) {
+    cerr << "invalid types are not detected\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  iterate the matrix by DataIter
+int test_iter(const Matrix& mat) {
+  DataIter iter(16, 4);
+  int pass_num = 3;
+  if (iter.AddReader(MemoryReader::CreateCsr(
+                         mat.indptr.data(), kMemInt64, mat.indices.data(),
+                         kMemInt64, mat.values.data(), kMemFloat64,
+                         mat.labels.data(), kMemFloat64, kRows, true),
+                     pass_num) != Status_OK ||
+      iter.AddReader(nullptr) == Status_OK) {
+    return Status_Error;
+  }
+  size_t data_num = 0, feat_num = 0;
+  MiniBatch* mb = nullptr;
+  while ((mb = iter.Next(mb)) != nullptr) {
+    data_num += mb->size();
+    for (int i = 0; i < mb->size(); ++i) feat_num += (*mb)[i].size();
+  }
+  if (data_num != kRows * pass_num ||
+      feat_num != mat.indices.size() * pass_num) {
+    cerr << "iterate the matrix failed\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  an empty matrix is read as an empty file
+int test_empty() {
+  vector<double> dense, labels;
+  vector<int64_t> indptr(1, 0), indices;
+  unique_ptr<MemoryReader> dense_reader(MemoryReader::CreateDense(
+      dense.data(), kMemFloat64, labels.data(), kMemFloat64, 0, kCols,
+      kCols * sizeof(double)));
+  unique_ptr<MemoryReader> csr_reader(MemoryReader::CreateCsr(
+      indptr.data(), kMemInt64, indices.data(), kMemInt64, dense.data(),
+      kMemFloat64, labels.data(), kMemFloat64, 0, true));
+  DataPoint pt;
+  for (MemoryReader* reader : {dense_reader.get(), csr_reader.get()}) {
+    if (reader == nullptr || reader->Open("") != Status_OK ||
+        reader->Next(pt) != Status_EndOfFile) {
+      cerr << "end of an empty matrix is not detected\n";
+      return Status_Error;
+    }
+  }
+
+  DataIter iter(16, 4);
+  if (iter.AddReader(MemoryReader::CreateDense(dense.data(), kMemFloat64,
+                                               labels.data(), kMemFloat64, 0,
+                                               kCols, kCols * sizeof(double)),
+                     2) != Status_OK) {
+    return Status_Error;
+  }
+  // the passes end with empty mini-batches
+  size_t data_num = 0;
+  MiniBatch* mb = nullptr;
+  while ((mb = iter.Next(mb)) != nullptr) data_num += mb->size();
+  if (data_num != 0) {
+    cerr << "iterate an empty matrix failed\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  Matrix mat;
+  if (test_dense(mat) != Status_OK || test_csr(mat) != Status_OK ||
+      test_iter(mat) != Status_OK || test_empty() != Status_OK) {
+    return -1;
+  }
+  cout << "test memory reader succeed\n";
+  return 0;
+}
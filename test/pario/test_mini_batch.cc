@@ -0,0 +1,84 @@
+/*********************************************************************************
+*     File Name           :     test_mini_batch.cc
+*     Created By          :     yuewu
+*     Description         :     test shared feature buffers of mini-batch
+**********************************************************************************/
+
+#include <string>
+#include <cstdlib>
+#include <iostream>
+
+#include "sol/pario/mini_batch.h"
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+/// \brief  load points of increasing size, point i has i + 1 features
+void load(MiniBatch& mb) {
+  mb.Clear();
+  for (int i = 0; i < mb.capacity(); ++i) {
+    DataPoint& pt = mb.NextPoint();
+    pt.set_label(i);
+    for (int j = 0; j <= i; ++j) {
+      pt.AddNewFeat(index_t(j + 1), real_t(i * 100 + j));
+    }
+    mb.PushPoint();
+  }
+}
+
+int check(const MiniBatch& mb) {
+  for (int i = 0; i < mb.size(); ++i) {
+    const DataPoint& pt = mb[i];
+    if (pt.label() != i || pt.size() != size_t(i + 1)) {
+      cerr << "point " << i << " is not correct\n";
+      return -1;
+    }
+    for (int j = 0; j <= i; ++j) {
+      if (pt.index(j) != index_t(j + 1) ||
+          pt.feature(j) != real_t(i * 100 + j)) {
+        cerr << "feature " << j << " of point " << i << " is not correct\n";
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  // the shared buffers can only hold part of the points at first
+  MiniBatch mb(32, 100);
+  load(mb);
+  cout << "first load: " << mb.feat_num() << " of "
+       << 32 * 33 / 2 << " features in shared buffers\n";
+  if (check(mb) != 0) return -1;
+  if (mb.feat_num() > mb.feat_capacity()) return -1;
+
+  // buffers are enlarged to hold all the points
+  load(mb);
+  cout << "second load: " << mb.feat_num() << " features in shared buffers "
+       << "of capacity " << mb.feat_capacity() << "\n";
+  if (check(mb) != 0) return -1;
+  if (mb.feat_num() != 32 * 33 / 2) {
+    cerr << "shared buffers are not enlarged\n";
+    return -1;
+  }
+  // points are adjacent in the shared buffers
+  for (int i = 1; i < mb.size(); ++i) {
+    if (mb[i].indexes().begin() != mb[i - 1].indexes().end()) {
+      cerr << "points are not contiguous\n";
+      return -1;
+    }
+  }
+
+  cout << "test mini batch succeed\n";
+  return 0;
+}
@@ -0,0 +1,216 @@
+/*********************************************************************************
+*     File Name           :     test_numeric_parser.cc
+*     Created By          :     yuewu
+*     Description         :     test and benchmark the numeric parsers
+**********************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sol/util/types.h>
+#include <sol/util/util.h>
+#include <sol/util/error_code.h>
+#include <sol/pario/file_reader.h>
+#include <sol/pario/numeric_parser.h>
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+/// \brief  copy a string to a buffer with the padding of the fast parsers
+char* padded_copy(const string& str, vector<char>& buf) {
+  buf.assign(str.size() + 1 + NumericParser::kPadding, '\0');
+  memcpy(buf.data(), str.c_str(), str.size());
+  return buf.data();
+}
+
+/// \brief  check the fast parsers against strtof and strtol
+int check_parsers() {
+  mt19937 gen(0);
+  uniform_real_distribution<float> dis(-1, 1);
+  uniform_int_distribution<int> exp_dis(-30, 30);
+  const char* formats[] = {"%g", "%.3f", "%.9g", "%e", "%.12e", "%.0f"};
+  vector<char> buf;
+  char str[64];
+  for (int i = 0; i < 100000; ++i) {
+    float val = dis(gen) * powf(10.f, float(exp_dis(gen) % 8));
+    if (i % 7 == 0) val = dis(gen) * powf(10.f, float(exp_dis(gen)));
+    snprintf(str, sizeof(str), formats[i % 6], double(val));
+    char* p = padded_copy(str, buf);
+    char* end = nullptr;
+    float expected = strtof(p, nullptr);
+    float parsed = NumericParser::ParseFloatFast(p, end);
+    if (memcmp(&parsed, &expected, sizeof(float)) != 0 || *end != '\0') {
+      cerr << "parse float (" << str << ") failed: " << parsed << " vs "
+           << expected << "\n";
+      return -1;
+    }
+  }
+
+  const char* floats[] = {"1",     "-1",      "+0.5",        "0.0000001234",
+                          "1e10",  "1.5E-3",  "123456789012", "3.4e38",
+                          "1e-45", "0.1 ",    "7:",          "-0"};
+  for (const char* str : floats) {
+    char* p = padded_copy(str, buf);
+    char* end = nullptr;
+    float expected = strtof(p, nullptr);
+    float parsed = NumericParser::ParseFloatFast(p, end);
+    if (memcmp(&parsed, &expected, sizeof(float)) != 0) {
+      cerr << "parse float (" << str << ") failed: " << parsed << " vs "
+           << expected << "\n";
+      return -1;
+    }
+  }
+
+  uniform_int_distribution<int> int_dis(-100000000, 100000000);
+  for (int i = 0; i < 100000; ++i) {
+    int val = int_dis(gen) >> (i % 28);
+    snprintf(str, sizeof(str), i % 3 == 0 ? "%+d " : "%d", val);
+    char* p = padded_copy(str, buf);
+    char* end = nullptr;
+    if (NumericParser::ParseIntFast(p, end) != val || *end != '\0') {
+      cerr << "parse int (" << str << ") failed\n";
+      return -1;
+    }
+    unsigned int uval = (unsigned int)(val < 0 ? -val : val);
+    snprintf(str, sizeof(str), "%u:", uval);
+    p = padded_copy(str, buf);
+    if (NumericParser::ParseUintFast(p, end) != uval || *end != ':') {
+      cerr << "parse uint (" << str << ") failed\n";
+      return -1;
+    }
+  }
+
+  // not a number
+  const char* invalids[] = {"", "-", "abc", ":1"};
+  for (const char* str : invalids) {
+    char* p = padded_copy(str, buf);
+    char* end = nullptr;
+    NumericParser::ParseFloatFast(p, end);
+    if (end != p) {
+      cerr << "parse invalid float (" << str << ") succeeded\n";
+      return -1;
+    }
+  }
+  return Status_OK;
+}
+
+/// \brief  parse the svm lines, return the sum of the values
+template <typename ParseInt, typename ParseUint, typename ParseFloat>
+double parse_lines(vector<char>& text, size_t text_len, size_t& token_num,
+                   ParseInt parse_int, ParseUint parse_uint,
+                   ParseFloat parse_float) {
+  double sum = 0;
+  token_num = 0;
+  char* p = text.data();
+  char* text_end = p + text_len;
+  char* endptr = nullptr;
+  while (p < text_end) {
+    // lines are terminated by '\0' as FileReader does
+    char* line_end = p + strlen(p);
+    sum += parse_int(p, endptr);
+    p = endptr;
+    while (*p != '\0') {
+      sum += parse_uint(p, endptr);
+      if (endptr == p || *endptr != ':') break;
+      p = endptr + 1;
+      sum += parse_float(p, endptr);
+      if (endptr == p) break;
+      p = endptr;
+      ++token_num;
+    }
+    p = line_end + 1;
+  }
+  return sum;
+}
+
+/// \brief  benchmark the parsers on a data file
+int benchmark(const string& path) {
+  FileReader reader(path.c_str(), "r");
+  if (reader.Good() == false) return Status_IO_Error;
+  vector<char> text;
+  char* line = nullptr;
+  size_t len = 0;
+  while (reader.ReadLine(line, len) == Status_OK) {
+    text.insert(text.end(), line, line + len + 1);
+  }
+  size_t text_len = text.size();
+  text.resize(text_len + 1 + NumericParser::kPadding, '\0');
+  double mb = text_len / 1048576.0;
+
+  size_t token_num = 0, fast_token_num = 0;
+  int repeat = int(100 / mb) + 1;
+  double sum = 0, fast_sum = 0;
+
+  // the parsers are run alternately and the best times are kept, the lines
+  // are modified by neither parser, so the buffer is reused
+  double time = 0, fast_time = 0;
+  for (int round = 0; round < 3; ++round) {
+    double start_time = get_current_time();
+    for (int i = 0; i < repeat; ++i) {
+      sum = parse_lines(
+          text, text_len, token_num,
+          [](char* p, char*& end) { return NumericParser::ParseInt(p, end); },
+          [](char* p, char*& end) { return NumericParser::ParseUint(p, end); },
+          [](char* p, char*& end) {
+            return NumericParser::ParseFloat(p, end);
+          });
+    }
+    double cur_time = get_current_time() - start_time;
+    if (round == 0 || cur_time < time) time = cur_time;
+
+    start_time = get_current_time();
+    for (int i = 0; i < repeat; ++i) {
+      fast_sum = parse_lines(
+          text, text_len, fast_token_num,
+          [](char* p, char*& end) {
+            return NumericParser::ParseIntFast(p, end);
+          },
+          [](char* p, char*& end) {
+            return NumericParser::ParseUintFast(p, end);
+          },
+          [](char* p, char*& end) {
+            return NumericParser::ParseFloatFast(p, end);
+          });
+    }
+    cur_time = get_current_time() - start_time;
+    if (round == 0 || cur_time < fast_time) fast_time = cur_time;
+  }
+
+  cout << path << ": " << token_num << " features, byte-at-a-time "
+       << mb * repeat / time << " MB/s, fast " << mb * repeat / fast_time
+       << " MB/s\n";
+  // the byte-at-a-time parser truncates the decimals to 7 digits
+  if (token_num != fast_token_num ||
+      fabs(sum - fast_sum) > 1e-5 * (1 + fabs(sum))) {
+    cerr << "parsed results of " << path << " are different\n";
+    return Status_Invalid_Format;
+  }
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  if (check_parsers() != Status_OK) return -1;
+
+  vector<string> paths = {"data/a1a", "data/a1a.t"};
+  if (argc > 1) paths.assign(argv + 1, argv + argc);
+  for (const string& path : paths) {
+    if (benchmark(path) != Status_OK) return -1;
+  }
+  cout << "test numeric parser succeed\n";
+  return 0;
+}
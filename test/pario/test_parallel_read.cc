@@ -0,0 +1,180 @@
+/*********************************************************************************
+*     File Name           :     test_parallel_read.cc
+*     Created By          :     yuewu
+*     Description         :     test parsing text data with multiple threads
+**********************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include "sol/pario/data_iter.h"
+#include "sol/util/util.h"
+#include "sol/tools.h"
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+/// \brief  format a data point as "label idx:val ..."
+string to_line(const DataPoint& dp) {
+  char buf[64];
+  string line = to_string(dp.label());
+  for (size_t d = 0; d < dp.size(); ++d) {
+    snprintf(buf, 64, " %d:%g", dp.index(d), dp.feature(d));
+    line += buf;
+  }
+  return line;
+}
+
+/// \brief  load the data as a list of lines
+int load(const string& path, const string& dtype, int pass_num, int thread_num,
+         bool keep_order, vector<string>& lines) {
+  DataIter iter;
+  int ret = iter.AddReader(path, dtype, pass_num, thread_num, keep_order);
+  if (ret != Status_OK) return ret;
+
+  MiniBatch* mb = nullptr;
+  while (true) {
+    mb = iter.Next(mb);
+    if (mb == nullptr) break;
+    for (int i = 0; i < mb->size(); ++i) {
+      lines.push_back(to_line((*mb)[i]));
+    }
+  }
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  string path = "data/a1a";
+  string dtype = "svm";
+  if (argc == 3) {
+    path = argv[1];
+    dtype = argv[2];
+  }
+
+  int pass_num = 2;
+  vector<string> expected;
+  if (load(path, dtype, pass_num, 1, true, expected) != Status_OK) return -1;
+  cout << "sequential: " << expected.size() << " instances\n";
+
+  int thread_nums[] = {2, 3, 8};
+  for (int thread_num : thread_nums) {
+    vector<string> lines;
+    double start_time = get_current_time();
+    if (load(path, dtype, pass_num, thread_num, true, lines) != Status_OK)
+      return -1;
+    cout << "ordered, " << thread_num << " threads: " << lines.size()
+         << " instances, " << get_current_time() - start_time << " seconds\n";
+    if (lines != expected) {
+      cerr << "ordered parallel parsing result is different!\n";
+      return -1;
+    }
+
+    lines.clear();
+    if (load(path, dtype, pass_num, thread_num, false, lines) != Status_OK)
+      return -1;
+    cout << "unordered, " << thread_num << " threads: " << lines.size()
+         << " instances\n";
+    vector<string> sorted_expected(expected);
+    sort(sorted_expected.begin(), sorted_expected.end());
+    sort(lines.begin(), lines.end());
+    if (lines != sorted_expected) {
+      cerr << "unordered parallel parsing result is different!\n";
+      return -1;
+    }
+  }
+
+  // run several readers at the same time
+  vector<string> sorted_expected;
+  for (int i = 0; i < 3; ++i) {
+    sorted_expected.insert(sorted_expected.end(), expected.begin(),
+                           expected.end());
+  }
+  sort(sorted_expected.begin(), sorted_expected.end());
+  int reader_nums[] = {1, 2, 5};
+  for (int reader_num : reader_nums) {
+    DataIter iter(64, 8);
+    iter.set_max_running_reader_num(reader_num);
+    for (int i = 0; i < 3; ++i) {
+      if (iter.AddReader(path, dtype, pass_num, i, false) != Status_OK)
+        return -1;
+    }
+    vector<string> lines;
+    MiniBatch* mb = nullptr;
+    while ((mb = iter.Next(mb)) != nullptr) {
+      for (int i = 0; i < mb->size(); ++i) {
+        lines.push_back(to_line((*mb)[i]));
+      }
+    }
+    cout << reader_num << " running readers: " << lines.size()
+         << " instances\n";
+    sort(lines.begin(), lines.end());
+    if (lines != sorted_expected) {
+      cerr << "concurrent reading result is different!\n";
+      return -1;
+    }
+  }
+
+  // fetch mini-batches without returning the previous ones
+  {
+    DataIter iter(64, 4);
+    if (iter.AddReader(path, dtype, pass_num) != Status_OK) return -1;
+    vector<string> lines;
+    vector<MiniBatch*> held;
+    MiniBatch* mb = nullptr;
+    while ((mb = iter.Next()) != nullptr) {
+      for (int i = 0; i < mb->size(); ++i) {
+        lines.push_back(to_line((*mb)[i]));
+      }
+      held.push_back(mb);
+      if (held.size() == 3) {
+        for (MiniBatch* batch : held) iter.Recycle(batch);
+        held.clear();
+      }
+    }
+    for (MiniBatch* batch : held) iter.Recycle(batch);
+    if (lines != expected) {
+      cerr << "recycled reading result is different!\n";
+      return -1;
+    }
+  }
+
+  // binary data can not be split, it is read by one thread
+  {
+    string bin_path = "test_parallel_read.tmp";
+    vector<string> lines;
+    int ret = convert(path, dtype, bin_path, "bin");
+    if (ret == Status_OK) {
+      ret = load(bin_path, "bin", pass_num, 4, false, lines);
+    }
+    remove(bin_path.c_str());
+    cout << "binary, 4 threads: " << lines.size() << " instances\n";
+    if (ret != Status_OK || lines != expected) {
+      cerr << "parallel reading of binary data failed!\n";
+      return -1;
+    }
+  }
+
+  // stop iteration before the data is exhausted
+  DataIter iter(16, 2);
+  iter.set_max_running_reader_num(2);
+  iter.AddReader(path, dtype, pass_num, 4, true);
+  iter.AddReader(path, dtype, pass_num);
+  iter.AddReader(path, dtype, pass_num);
+  MiniBatch* mb = iter.Next(nullptr);
+  if (mb == nullptr) return -1;
+
+  cout << "test parallel read succeed\n";
+  return 0;
+}
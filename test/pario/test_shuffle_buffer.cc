@@ -0,0 +1,142 @@
+/*********************************************************************************
+*     File Name           :     test_shuffle_buffer.cc
+*     Created By          :     yuewu
+*     Description         :     test shuffling the data with a window
+**********************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <iostream>
+#include <algorithm>
+#include <map>
+
+#include "sol/pario/data_iter.h"
+#include "sol/util/util.h"
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+/// \brief  format a data point as "label idx:val ..."
+string to_line(const DataPoint& dp) {
+  char buf[64];
+  string line = to_string(dp.label());
+  for (size_t d = 0; d < dp.size(); ++d) {
+    snprintf(buf, 64, " %d:%g", dp.index(d), dp.feature(d));
+    line += buf;
+  }
+  return line;
+}
+
+// mini-batch size of the iterators
+static const int kBatchSize = 32;
+
+/// \brief  load the data as a list of lines
+int load(const string& path, const string& dtype, int pass_num,
+         size_t window_size, unsigned int seed, vector<string>& lines) {
+  DataIter iter(kBatchSize, 2);
+  iter.set_shuffle_window(window_size, seed);
+  int ret = iter.AddReader(path, dtype, pass_num);
+  if (ret != Status_OK) return ret;
+
+  MiniBatch* mb = nullptr;
+  while ((mb = iter.Next(mb)) != nullptr) {
+    for (int i = 0; i < mb->size(); ++i) {
+      lines.push_back(to_line((*mb)[i]));
+    }
+  }
+  return Status_OK;
+}
+
+/// \brief  check that each point is output before the window holds more than
+/// the bound of points, i.e. the first k output points are in the first
+/// k + bound input points
+int check_window(const vector<string>& expected, const vector<string>& lines,
+                 size_t bound) {
+  // input points minus output points
+  map<string, int> counts;
+  size_t read_num = 0;
+  for (size_t k = 0; k < lines.size(); ++k) {
+    for (; read_num < expected.size() && read_num < k + bound; ++read_num) {
+      ++counts[expected[read_num]];
+    }
+    if (--counts[lines[k]] < 0) {
+      cerr << "point " << k << " is output before it is in the window of "
+           << bound << " points\n";
+      return Status_Error;
+    }
+  }
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  string path = "data/a1a";
+  string dtype = "svm";
+  if (argc == 3) {
+    path = argv[1];
+    dtype = argv[2];
+  }
+
+  int pass_num = 2;
+  vector<string> expected;
+  if (load(path, dtype, pass_num, 0, 0, expected) != Status_OK) return -1;
+  cout << "ordered: " << expected.size() << " instances\n";
+  vector<string> sorted_expected(expected);
+  sort(sorted_expected.begin(), sorted_expected.end());
+
+  size_t window_sizes[] = {1, 100, 1000, 100000};
+  for (size_t window_size : window_sizes) {
+    vector<string> lines;
+    double start_time = get_current_time();
+    if (load(path, dtype, pass_num, window_size, 7, lines) != Status_OK)
+      return -1;
+    cout << "window " << window_size << ": " << lines.size() << " instances, "
+         << get_current_time() - start_time << " seconds\n";
+    // the window is refilled with whole mini-batches, so even a window of
+    // one point shuffles the points of each loaded mini-batch
+    if (lines == expected) {
+      cerr << "data is not shuffled!\n";
+      return -1;
+    }
+    if (check_window(expected, lines, window_size + kBatchSize - 1) !=
+        Status_OK) {
+      return -1;
+    }
+
+    // the same seed gives the same order
+    vector<string> lines2;
+    if (load(path, dtype, pass_num, window_size, 7, lines2) != Status_OK)
+      return -1;
+    if (lines2 != lines) {
+      cerr << "shuffled result is not reproducible!\n";
+      return -1;
+    }
+
+    sort(lines.begin(), lines.end());
+    if (lines != sorted_expected) {
+      cerr << "shuffled result is different!\n";
+      return -1;
+    }
+  }
+
+  // stop iteration before the data is exhausted
+  {
+    DataIter iter(16, 2);
+    iter.set_shuffle_window(100);
+    iter.AddReader(path, dtype, pass_num);
+    MiniBatch* mb = iter.Next(nullptr);
+    if (mb == nullptr) return -1;
+  }
+
+  cout << "test shuffle buffer succeed\n";
+  return 0;
+}
@@ -0,0 +1,200 @@
+/*********************************************************************************
+*     File Name           :     test_value_codec.cc
+*     Created By          :     yuewu
+*     Description         :     test the encodings of the feature values
+**********************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sol/util/types.h>
+#include <sol/util/util.h>
+#include <sol/util/error_code.h>
+#include <sol/pario/data_reader.h>
+#include <sol/pario/data_writer.h>
+#include <sol/pario/value_codec.h>
+
+using namespace sol;
+using namespace sol::pario;
+using namespace std;
+
+/// \brief  check the half float conversions
+int check_half() {
+  for (uint32_t h = 0; h < 0x10000; ++h) {
+    float val = HalfToFloat(uint16_t(h));
+    // NaNs are not kept bitwise
+    if (std::isnan(val)) continue;
+    if (FloatToHalf(val) != h) {
+      cerr << "half float 0x" << hex << h << dec << " is not round trip\n";
+      return Status_Error;
+    }
+    // normal halves with 8 significant bits are exact in bf16
+    if ((h & 0x7C00) != 0 && (h & 0x7) == 0 &&
+        Bf16ToFloat(FloatToBf16(val)) != val) {
+      cerr << "bf16 of " << val << " is not exact\n";
+      return Status_Error;
+    }
+  }
+  // rounded to the nearest even
+  struct Case {
+    float val;
+    uint16_t half;
+  } cases[] = {{1.f + 1.f / 2048, 0x3C00},      {1.f + 3.f / 2048, 0x3C02},
+               {65520.f, 0x7C00},              {65519.f, 0x7BFF},
+               {1e-8f, 0x0000},                {-2.98023224e-8f, 0x8000},
+               {3.0e-8f, 0x0001}};
+  for (const Case& c : cases) {
+    if (FloatToHalf(c.val) != c.half) {
+      cerr << "half float of " << c.val << " is not correct\n";
+      return Status_Error;
+    }
+  }
+  if (FloatToBf16(1.f + 1.f / 256) != 0x3F80 ||
+      FloatToBf16(1.f + 3.f / 256) != 0x3F82) {
+    cerr << "bf16 is not rounded to the nearest even\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  encode and decode the values, check the encoding and the error
+int check_values(const vector<real_t>& values, int precision,
+                 int expected_encoding, float max_error) {
+  vector<char> codes;
+  int encoding = EncodeValues(values.data(), values.size(), precision, codes);
+  // a trailing byte to check the used length
+  codes.push_back('x');
+  vector<real_t> decoded(values.size());
+  size_t used = 0;
+  if (encoding != expected_encoding ||
+      DecodeValues(codes.data(), codes.size(), decoded.data(), values.size(),
+                   used) != Status_OK ||
+      used != codes.size() - 1) {
+    cerr << "encoding " << encoding << " of precision " << precision
+         << " is not " << expected_encoding << "\n";
+    return Status_Error;
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (fabs(decoded[i] - values[i]) > max_error * fabs(values[i]) + 1e-30) {
+      cerr << "value " << values[i] << " is decoded as " << decoded[i]
+           << " by encoding " << encoding << "\n";
+      return Status_Error;
+    }
+  }
+  // truncated data
+  if (used > 1 && DecodeValues(codes.data(), used - 1, decoded.data(),
+                               values.size(), used) == Status_OK) {
+    cerr << "truncated values are not detected\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+int check_encodings() {
+  mt19937 gen(0);
+  uniform_real_distribution<float> dis(-10, 10);
+  uniform_int_distribution<int> int_dis(0, 20);
+  vector<real_t> ones(30, 1), counts(30), halves(30), reals(30);
+  for (size_t i = 0; i < reals.size(); ++i) {
+    counts[i] = real_t(int_dis(gen));
+    halves[i] = HalfToFloat(FloatToHalf(dis(gen)));
+    reals[i] = dis(gen);
+  }
+  vector<real_t> large = reals;
+  large[3] = 1e6f;
+
+  struct Case {
+    const vector<real_t>* values;
+    int precision;
+    int encoding;
+    float max_error;
+  } cases[] = {
+      {&ones, kPrecisionLossless, kValueOne, 0},
+      {&ones, kPrecisionInt8, kValueOne, 0},
+      {&counts, kPrecisionLossless, kValueInt8, 0},
+      {&halves, kPrecisionLossless, kValueFp16, 0},
+      {&reals, kPrecisionLossless, kValueFloat, 0},
+      {&reals, kPrecisionFp16, kValueFp16, 1.f / 2048},
+      {&reals, kPrecisionBf16, kValueBf16, 1.f / 256},
+      {&large, kPrecisionFp16, kValueFloat, 0},
+      {&large, kPrecisionBf16, kValueBf16, 1.f / 256},
+  };
+  for (const Case& c : cases) {
+    if (check_values(*c.values, c.precision, c.encoding, c.max_error) !=
+        Status_OK) {
+      return Status_Error;
+    }
+  }
+  // int8 error is bounded by half of the scale
+  vector<char> codes;
+  EncodeValues(reals.data(), reals.size(), kPrecisionInt8, codes);
+  vector<real_t> decoded(reals.size());
+  size_t used = 0;
+  float max_val = 0;
+  for (real_t val : reals) max_val = fmaxf(max_val, fabsf(val));
+  if (codes[0] != char(kValueInt8) ||
+      DecodeValues(codes.data(), codes.size(), decoded.data(), reals.size(),
+                   used) != Status_OK) {
+    cerr << "int8 encoding failed\n";
+    return Status_Error;
+  }
+  for (size_t i = 0; i < reals.size(); ++i) {
+    if (fabs(decoded[i] - reals[i]) > max_val / 254 * 1.001) {
+      cerr << "int8 error of " << reals[i] << " is too large\n";
+      return Status_Error;
+    }
+  }
+  return Status_OK;
+}
+
+/// \brief  size of the data in a format
+long long convert_size(const string& path, const string& dtype,
+                       const char* extra_info) {
+  const char* out_path = "tmp_test_value_codec.tmp";
+  DataReader* reader = DataReader::Create("svm");
+  DataWriter* writer = DataWriter::Create(dtype);
+  int ret = reader->Open(path);
+  if (ret == Status_OK) ret = writer->SetExtraInfo(extra_info);
+  if (ret == Status_OK) ret = writer->Open(out_path);
+  DataPoint pt;
+  while (ret == Status_OK && (ret = reader->Next(pt)) == Status_OK) {
+    ret = writer->Write(pt);
+  }
+  delete reader;
+  delete writer;
+  if (ret != Status_EndOfFile) return -1;
+  FILE* fp = fopen(out_path, "rb");
+  if (fp == nullptr) return -1;
+  fseek(fp, 0, SEEK_END);
+  long long size = ftell(fp);
+  fclose(fp);
+  delete_file(out_path);
+  return size;
+}
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(368);
+#endif
+
+  if (check_half() != Status_OK || check_encodings() != Status_OK) return -1;
+
+  string path = "data/a1a";
+  if (argc == 2) path = argv[1];
+  long long v1_size = convert_size(path, "bin", "");
+  long long v2_size = convert_size(path, "bin2", "codec=none");
+  if (v1_size <= 0 || v2_size <= 0) return -1;
+  cout << path << ": bin " << v1_size << " bytes, bin2 (no compression) "
+       << v2_size << " bytes\n";
+  cout << "test value codec succeed\n";
+  return 0;
+}
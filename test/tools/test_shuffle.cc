@@ -0,0 +1,204 @@
+/*********************************************************************************
+*     File Name           :     test_shuffle.cc
+*     Created By          :     yuewu
+*     Description         :     test the external shuffle and split of data
+**********************************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#include <sol/sol.h>
+#include <sol/tools.h>
+
+using namespace std;
+using namespace sol;
+using namespace sol::pario;
+
+// small shards, so that the data is written to several shards by each writer
+static const int64_t kShardSize = 16 << 10;
+// number of writer threads of the shuffler
+static const int kWriterNum = 2;
+
+/// \brief  read the data points as lines of "label index:feature ..."
+int read_points(const string& path, vector<string>& points) {
+  unique_ptr<DataReader> reader(DataReader::Create("svm"));
+  if (reader == nullptr || reader->Open(path) != Status_OK) {
+    return Status_IO_Error;
+  }
+  DataPoint dp;
+  int ret = Status_OK;
+  while ((ret = reader->Next(dp)) == Status_OK) {
+    ostringstream oss;
+    oss << dp.label();
+    for (size_t i = 0; i < dp.size(); ++i) {
+      oss << " " << dp.index(i) << ":" << dp.feature(i);
+    }
+    points.push_back(oss.str());
+  }
+  return ret == Status_EndOfFile ? Status_OK : ret;
+}
+
+/// \brief  check that the output is a permutation of the input
+int check_permutation(vector<string> src, vector<string> dst) {
+  if (src.size() != dst.size()) {
+    fprintf(stderr, "expect %zu points, got %zu\n", src.size(), dst.size());
+    return Status_Error;
+  }
+  sort(src.begin(), src.end());
+  sort(dst.begin(), dst.end());
+  if (src != dst) {
+    fprintf(stderr, "output is not a permutation of the input\n");
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  check that the temporary shards with the prefix are removed
+int check_shards_removed(const string& prefix, int64_t src_size) {
+  int shard_num = int((src_size + kShardSize - 1) / kShardSize);
+  int ret = Status_OK;
+  for (int w = 0; w < kWriterNum; ++w) {
+    for (int s = 0; s < shard_num; ++s) {
+      ostringstream path;
+      path << prefix << ".shard" << w << "_" << s;
+      FILE* file = fopen(path.str().c_str(), "rb");
+      if (file != nullptr) {
+        fclose(file);
+        remove(path.str().c_str());
+        fprintf(stderr, "shard %s is not removed\n", path.str().c_str());
+        ret = Status_Error;
+      }
+    }
+  }
+  return ret;
+}
+
+int test_shuffle(const string& src_path, const vector<string>& src,
+                 int64_t src_size,
+                 const string& output_path = "test_shuffle.tmp") {
+  vector<string> dst;
+  int ret = shuffle(src_path, "svm", output_path, "svm", kShardSize);
+  if (ret == Status_OK) ret = read_points(output_path, dst);
+  if (ret == Status_OK) ret = check_permutation(src, dst);
+  if (ret == Status_OK && dst == src) {
+    fprintf(stderr, "data is not shuffled\n");
+    ret = Status_Error;
+  }
+  if (check_shards_removed(output_path, src_size) != Status_OK) {
+    ret = Status_Error;
+  }
+  remove(output_path.c_str());
+  return ret;
+}
+
+int test_split(const string& src_path, const vector<string>& src,
+               int64_t src_size, bool shuffle) {
+  string prefix = "test_shuffle.split";
+  int fold_num = 3;
+  int ret = split(src_path, "svm", fold_num, prefix, "svm", shuffle,
+                  kShardSize);
+  vector<string> dst;
+  size_t fold_size = (src.size() + fold_num - 1) / fold_num;
+  for (int fold = 0; fold < fold_num; ++fold) {
+    string path = prefix + to_string(fold) + ".svm";
+    size_t data_num = dst.size();
+    if (ret == Status_OK) ret = read_points(path, dst);
+    size_t expect_num = min(fold_size, src.size() - data_num);
+    if (ret == Status_OK && dst.size() - data_num != expect_num) {
+      fprintf(stderr, "expect %zu points in fold %d, got %zu\n", expect_num,
+              fold, dst.size() - data_num);
+      ret = Status_Error;
+    }
+    remove(path.c_str());
+  }
+  if (ret == Status_OK) ret = check_permutation(src, dst);
+  // without shuffling, the folds keep the original order
+  if (ret == Status_OK && (dst == src) != (shuffle == false)) {
+    fprintf(stderr, "order of the split data is %s\n",
+            shuffle ? "not shuffled" : "changed");
+    ret = Status_Error;
+  }
+  if (check_shards_removed(prefix, src_size) != Status_OK) {
+    ret = Status_Error;
+  }
+  return ret;
+}
+
+/// \brief  compressed data is sharded by its decompressed size
+int test_shuffle_gzip(const string& src_path, const vector<string>& src,
+                      int64_t src_size) {
+#ifdef HAS_ZLIB
+  string gz_path = "test_shuffle.gz.tmp";
+  FILE* file = fopen(src_path.c_str(), "rb");
+  gzFile gz = gzopen(gz_path.c_str(), "wb");
+  if (file == nullptr || gz == nullptr) {
+    if (file != nullptr) fclose(file);
+    if (gz != nullptr) gzclose(gz);
+    return Status_IO_Error;
+  }
+  char buf[4096];
+  size_t len = 0;
+  while ((len = fread(buf, 1, sizeof(buf), file)) > 0) {
+    gzwrite(gz, buf, unsigned(len));
+  }
+  fclose(file);
+  gzclose(gz);
+  int ret = test_shuffle(gz_path, src, src_size, "test_shuffle.gz.out.tmp");
+  remove(gz_path.c_str());
+  return ret;
+#else
+  return Status_OK;
+#endif
+}
+
+/// \brief  the shards are removed when writing the folds fails
+int test_split_error(const string& src_path, int64_t src_size) {
+  string prefix = "test_shuffle.error";
+  // the shards are written before the writer of the folds is created
+  if (split(src_path, "svm", 2, prefix, "nonexist", true, kShardSize) ==
+      Status_OK) {
+    fprintf(stderr, "split to an unknown format succeeded\n");
+    return Status_Error;
+  }
+  return check_shards_removed(prefix, src_size);
+}
+
+int main(int argc, char** argv) {
+  string src_path = "data/a1a";
+  if (argc == 2) src_path = argv[1];
+
+  vector<string> src;
+  int64_t src_size = FileReader(src_path.c_str(), "rb").Size();
+  if (read_points(src_path, src) != Status_OK || src_size <= kShardSize) {
+    cerr << "load " << src_path << " failed, or it fits into one shard\n";
+    return -1;
+  }
+
+  int ret = Status_OK;
+  if (test_shuffle(src_path, src, src_size) != Status_OK ||
+      test_shuffle_gzip(src_path, src, src_size) != Status_OK) {
+    cerr << "test shuffle failed\n";
+    ret = Status_Error;
+  }
+  if (test_split(src_path, src, src_size, true) != Status_OK ||
+      test_split(src_path, src, src_size, false) != Status_OK) {
+    cerr << "test split failed\n";
+    ret = Status_Error;
+  }
+  if (test_split_error(src_path, src_size) != Status_OK) {
+    cerr << "test split with errors failed\n";
+    ret = Status_Error;
+  }
+  if (ret != Status_OK) return -1;
+  cout << "test shuffle succeed\n";
+  return 0;
+}
@@ -0,0 +1,235 @@
+/*********************************************************************************
+*     File Name           :     test_sol_server.cc
+*     Created By          :     yuewu
+*     Description         :     test the scoring server over stdin and stdout
+**********************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !_WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <sol/sol.h>
+
+using namespace std;
+using namespace sol;
+using namespace sol::pario;
+using namespace sol::model;
+
+#if _WIN32
+int main(int argc, char** argv) {
+  cout << "test sol server is skipped on this platform\n";
+  return 0;
+}
+#else
+
+int read_lines(const string& path, vector<string>& lines) {
+  ifstream in(path.c_str());
+  if (!in) return Status_IO_Error;
+  string line;
+  while (getline(in, line)) lines.push_back(line);
+  return Status_OK;
+}
+
+/// \brief  train a model on data/a1a and save it
+int train(const string& algo, const string& path) {
+  unique_ptr<Model> model(Model::Create(algo, 2));
+  if (model == nullptr) return Status_Invalid_Argument;
+  DataIter iter;
+  if (iter.AddReader("data/a1a", "svm") != Status_OK) return Status_IO_Error;
+  model->Train(iter);
+  return model->Save(path);
+}
+
+/// \brief  predictions of sol_test without the true labels, in the format of
+/// the responses of the server
+int sol_test(const string& bin_dir, const string& model_path,
+             const string& data_path, vector<string>& results) {
+  string output_path = "test_sol_server.predict.tmp";
+  string cmd = bin_dir + "/sol_test " + model_path + " " + data_path + " " +
+               output_path + " > /dev/null";
+  vector<string> lines;
+  if (system(cmd.c_str()) != 0 || read_lines(output_path, lines) != Status_OK) {
+    return Status_Error;
+  }
+  remove(output_path.c_str());
+  // skip the header
+  for (size_t i = 1; i < lines.size(); ++i) {
+    results.push_back(lines[i].substr(lines[i].find('\t') + 1));
+  }
+  return Status_OK;
+}
+
+/// \brief  run the server with the requests as stdin, and return the lines of
+/// stdout
+///
+/// \param before_reload called before the line "#reload" is sent
+int run_server(const string& bin_dir, const string& model_path,
+               const vector<string>& requests,
+               const function<void()>& before_reload,
+               vector<string>& responses) {
+  int in_pipe[2], out_pipe[2];
+  if (pipe(in_pipe) != 0 || pipe(out_pipe) != 0) return Status_IO_Error;
+  pid_t pid = fork();
+  if (pid < 0) return Status_Error;
+  if (pid == 0) {
+    dup2(in_pipe[0], 0);
+    dup2(out_pipe[1], 1);
+    close(in_pipe[0]);
+    close(in_pipe[1]);
+    close(out_pipe[0]);
+    close(out_pipe[1]);
+    string server = bin_dir + "/sol_server";
+    execl(server.c_str(), "sol_server", "--reload", "0", "-t", "2",
+          model_path.c_str(), (char*)nullptr);
+    _exit(127);
+  }
+  close(in_pipe[0]);
+  close(out_pipe[1]);
+
+  // requests are written in a separate thread, so that neither side blocks
+  // on a full pipe
+  thread writer([&]() {
+    for (const string& request : requests) {
+      if (request == "#reload") before_reload();
+      string line = request + "\n";
+      if (write(in_pipe[1], line.data(), line.size()) != ssize_t(line.size())) {
+        break;
+      }
+    }
+    close(in_pipe[1]);
+  });
+
+  string output;
+  char buf[1 << 16];
+  ssize_t len = 0;
+  while ((len = read(out_pipe[0], buf, sizeof(buf))) > 0) {
+    output.append(buf, size_t(len));
+  }
+  close(out_pipe[0]);
+  writer.join();
+
+  int status = 0;
+  if (waitpid(pid, &status, 0) != pid || WIFEXITED(status) == false ||
+      WEXITSTATUS(status) != 0) {
+    cerr << "sol_server exits abnormally\n";
+    return Status_Error;
+  }
+  size_t begin = 0, end = 0;
+  while ((end = output.find('\n', begin)) != string::npos) {
+    responses.push_back(output.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+  // the server and sol_test are built in the same directory as the test
+  string bin_dir = argv[0];
+  size_t pos = bin_dir.find_last_of('/');
+  bin_dir = pos == string::npos ? "." : bin_dir.substr(0, pos);
+  if (argc == 2) bin_dir = argv[1];
+
+  string model_path = "test_sol_server.tmp";
+  string new_model_path = "test_sol_server.new.tmp";
+  string long_data_path = "test_sol_server.data.tmp";
+
+  // a request longer than the initial read buffer of the server
+  string long_request = "1";
+  for (int i = 1; i <= 20000; ++i) {
+    long_request += " " + to_string(i) + ":0.25";
+  }
+  ofstream(long_data_path.c_str()) << long_request << "\n";
+
+  vector<string> data, expected, new_expected;
+  int ret = Status_OK;
+  if (train("ogd", model_path) != Status_OK ||
+      train("arow", new_model_path) != Status_OK ||
+      read_lines("data/a1a.t", data) != Status_OK ||
+      sol_test(bin_dir, model_path, "data/a1a.t", expected) != Status_OK ||
+      sol_test(bin_dir, model_path, long_data_path, expected) != Status_OK ||
+      sol_test(bin_dir, new_model_path, "data/a1a.t", new_expected) !=
+          Status_OK) {
+    cerr << "prepare the models and expected results failed\n";
+    ret = Status_Error;
+  }
+
+  // a1a.t is much larger than the read buffer, so that many requests are
+  // split by the reads
+  vector<string> requests = data;
+  requests.push_back("#stats");
+  requests.push_back(long_request);
+  requests.push_back("1 abc");
+  requests.push_back("#unknown");
+  requests.push_back("#reload");
+  size_t reload_num = 1000;
+  requests.insert(requests.end(), data.begin(), data.begin() + reload_num);
+  requests.push_back("#shutdown");
+  requests.push_back(data[0]);
+
+  vector<string> responses;
+  if (ret == Status_OK &&
+      run_server(bin_dir, model_path, requests,
+                 [&]() {
+                   // the server is started with --reload 0, so the new model
+                   // is only loaded by the command
+                   rename(new_model_path.c_str(), model_path.c_str());
+                 },
+                 responses) != Status_OK) {
+    ret = Status_Error;
+  }
+
+  if (ret == Status_OK) {
+    vector<string> answers(expected.begin(), expected.end() - 1);
+    // only the number of requests is checked in the latencies
+    size_t stats_idx = answers.size();
+    answers.push_back("requests " + to_string(data.size()) + " ");
+    answers.push_back(expected.back());
+    answers.push_back("error: invalid request");
+    answers.push_back("error: unknown command");
+    answers.push_back("ok");
+    answers.insert(answers.end(), new_expected.begin(),
+                   new_expected.begin() + reload_num);
+    answers.push_back("ok");
+
+    bool changed = false;
+    for (size_t i = 0; i < reload_num; ++i) {
+      changed = changed || new_expected[i] != expected[i];
+    }
+    if (changed == false) {
+      cerr << "the new model predicts the same as the old one\n";
+      ret = Status_Error;
+    } else if (responses.size() != answers.size()) {
+      cerr << "expect " << answers.size() << " responses, got "
+           << responses.size() << "\n";
+      ret = Status_Error;
+    }
+    for (size_t i = 0; ret == Status_OK && i < answers.size(); ++i) {
+      if (i == stats_idx
+              ? responses[i].compare(0, answers[i].size(), answers[i]) != 0
+              : responses[i] != answers[i]) {
+        cerr << "response " << i << " is (" << responses[i].substr(0, 64)
+             << "), expect (" << answers[i].substr(0, 64) << ")\n";
+        ret = Status_Error;
+      }
+    }
+  }
+
+  remove(model_path.c_str());
+  remove(new_model_path.c_str());
+  remove(long_data_path.c_str());
+  if (ret != Status_OK) return -1;
+  cout << "test sol server succeed\n";
+  return 0;
+}
+#endif
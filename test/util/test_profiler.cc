@@ -0,0 +1,122 @@
+/*********************************************************************************
+*     File Name           :     test_profiler.cc
+*     Created By          :     yuewu
+*     Description         :     test the timing counters of the pipeline stages
+**********************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <json/json.h>
+#include <sol/util/error_code.h>
+#include <sol/util/profiler.h>
+#include <sol/util/util.h>
+
+using namespace sol;
+using namespace std;
+
+int parse_report(Json::Value& root) {
+  Json::Reader reader;
+  if (reader.parse(Profiler::Report(), root) == false) {
+    cerr << "parse the report failed\n";
+    return Status_Invalid_Format;
+  }
+  return Status_OK;
+}
+
+/// \brief  nothing is counted if profiling is disabled
+int test_disabled() {
+  Profiler::Enable(false);
+  Profiler::Reset();
+  for (int i = 0; i < 100; ++i) {
+    ProfileScope scope(kStageUpdate);
+  }
+  Json::Value root;
+  if (parse_report(root) != Status_OK) return Status_Error;
+  if (root["enabled"].asBool() || root["stages"].size() != 0 ||
+      root["threads"].size() != 0) {
+    cerr << "stages are counted when profiling is disabled\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  counters of several threads are summed up
+int test_threads(int thread_num, int call_num) {
+  Profiler::Enable(true);
+  Profiler::Reset();
+  vector<thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([call_num]() {
+      volatile double val = 0;
+      for (int i = 0; i < call_num; ++i) {
+        ProfileScope scope(kStageUpdate);
+        for (int j = 0; j < 100; ++j) val = val + j;
+      }
+    });
+  }
+  for (thread& t : threads) t.join();
+  {
+    ProfileScope scope(kStageWait);
+    this_thread::sleep_for(chrono::milliseconds(50));
+  }
+  Profiler::Enable(false);
+
+  Json::Value root;
+  if (parse_report(root) != Status_OK) return Status_Error;
+  const Json::Value& stages = root["stages"];
+  if (stages["update"]["calls"].asUInt64() !=
+          Json::UInt64(thread_num) * call_num ||
+      stages["update"]["seconds"].asDouble() <= 0 ||
+      stages["wait"]["calls"].asUInt64() != 1 ||
+      root["threads"].size() != Json::ArrayIndex(thread_num + 1)) {
+    cerr << "counters of the threads are not correct\n" << root;
+    return Status_Error;
+  }
+  double seconds = stages["wait"]["seconds"].asDouble();
+  if (seconds < 0.04 || seconds > 1) {
+    cerr << "ticks are not converted to seconds correctly: " << seconds
+         << "\n";
+    return Status_Error;
+  }
+  if (Profiler::Summary().find("update") == string::npos) {
+    cerr << "stage names are not in the summary\n";
+    return Status_Error;
+  }
+
+  // counters of the exited threads are dropped
+  Profiler::Reset();
+  if (parse_report(root) != Status_OK) return Status_Error;
+  if (root["stages"].size() != 0 || root["threads"].size() != 0) {
+    cerr << "counters are not cleared\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  cost of a scope with profiling enabled or not
+void bench(bool enable, int call_num) {
+  Profiler::Enable(enable);
+  double start_time = get_current_time();
+  for (int i = 0; i < call_num; ++i) {
+    ProfileScope scope(kStagePredict);
+  }
+  double seconds = get_current_time() - start_time;
+  Profiler::Enable(false);
+  printf("%s scope: %.2f ns\n", enable ? "enabled" : "disabled",
+         seconds * 1e9 / call_num);
+}
+
+int main(int argc, char** argv) {
+  if (test_disabled() != Status_OK || test_threads(4, 10000) != Status_OK) {
+    return -1;
+  }
+  bench(false, 10000000);
+  bench(true, 10000000);
+  Profiler::Reset();
+  cout << "test profiler succeed\n";
+  return 0;
+}
@@ -0,0 +1,165 @@
+/*********************************************************************************
+*     File Name           :     test_ring_queue.cc
+*     Created By          :     yuewu
+*     Description         :     test and benchmark the lock-free ring queue
+**********************************************************************************/
+
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <sol/util/block_queue.h>
+#include <sol/util/ring_queue.h>
+#include <sol/util/error_code.h>
+#include <sol/util/util.h>
+#include <sol/pario/data_iter.h>
+
+using namespace sol;
+using namespace std;
+
+/// \brief  pass values 1..item_num from each producer to the consumers, the
+/// consumers stop at 0
+///
+/// \return Status_OK if every value is received once and in the order of its
+/// producer
+template <typename Queue>
+int run(Queue& queue, int producer_num, int consumer_num, size_t item_num,
+        double& seconds) {
+  // sum of the received values and the last value of each producer
+  vector<size_t> sums(consumer_num, 0);
+  vector<vector<size_t>> last_values(consumer_num,
+                                     vector<size_t>(producer_num, 0));
+  vector<int> errors(consumer_num, 0);
+
+  double start_time = get_current_time();
+  vector<thread> threads;
+  for (int c = 0; c < consumer_num; ++c) {
+    threads.emplace_back([&, c]() {
+      for (;;) {
+        size_t val = queue.Dequeue();
+        if (val == 0) break;
+        size_t producer = val % producer_num;
+        size_t seq = val / producer_num;
+        if (seq <= last_values[c][producer]) ++errors[c];
+        last_values[c][producer] = seq;
+        sums[c] += seq;
+      }
+    });
+  }
+  for (int p = 0; p < producer_num; ++p) {
+    threads.emplace_back([&, p]() {
+      for (size_t i = 1; i <= item_num; ++i) {
+        queue.Enqueue(i * producer_num + p);
+      }
+    });
+  }
+  for (int p = 0; p < producer_num; ++p) threads[consumer_num + p].join();
+  for (int c = 0; c < consumer_num; ++c) queue.Enqueue(0);
+  for (int c = 0; c < consumer_num; ++c) threads[c].join();
+  seconds = get_current_time() - start_time;
+
+  size_t sum = 0;
+  int error = 0;
+  for (int c = 0; c < consumer_num; ++c) {
+    sum += sums[c];
+    error += errors[c];
+  }
+  if (error > 0 || sum != producer_num * item_num * (item_num + 1) / 2) {
+    cerr << producer_num << " producers, " << consumer_num
+         << " consumers: values are lost or out of order\n";
+    return Status_Error;
+  }
+  return queue.size() == 0 ? Status_OK : Status_Error;
+}
+
+int test_queues(int producer_num, int consumer_num, int queue_size,
+                size_t item_num) {
+  double ring_time = 0, block_time = 0;
+  RingQueue<size_t> ring_queue(queue_size, producer_num == 1,
+                               consumer_num == 1);
+  BlockQueue<size_t> block_queue(queue_size);
+  if (run(ring_queue, producer_num, consumer_num, item_num, ring_time) !=
+          Status_OK ||
+      run(block_queue, producer_num, consumer_num, item_num, block_time) !=
+          Status_OK) {
+    return Status_Error;
+  }
+  double item_total = double(item_num * producer_num);
+  printf("%d producers, %d consumers, size %d: ring %.2f M/s, block %.2f M/s\n",
+         producer_num, consumer_num, queue_size, item_total / ring_time / 1e6,
+         item_total / block_time / 1e6);
+  return Status_OK;
+}
+
+/// \brief  the consumer parks on an empty queue and is woken up
+int test_park() {
+  RingQueue<int> queue(4, true, true);
+  int val = 0;
+  thread consumer([&]() { val = queue.Dequeue(); });
+  this_thread::sleep_for(chrono::milliseconds(50));
+  queue.Enqueue(7);
+  consumer.join();
+
+  // the producer parks on a full queue
+  for (int i = 0; i < queue.capacity(); ++i) queue.Enqueue(i);
+  thread producer([&]() { queue.Enqueue(100); });
+  this_thread::sleep_for(chrono::milliseconds(50));
+  int first = queue.Dequeue();
+  producer.join();
+  int last = 0;
+  while (queue.size() > 0) last = queue.Dequeue();
+  if (val != 7 || first != 0 || last != 100) {
+    cerr << "wake up parked threads failed\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  a queue of size 1 never overwrites an unread element
+int test_small_queue() {
+  RingQueue<int> queue(1);
+  int first = 0, second = 0, third = 0;
+  if (queue.TryEnqueue(1) == false || queue.TryEnqueue(2) == false ||
+      queue.TryEnqueue(3) || queue.TryDequeue(first) == false ||
+      queue.TryDequeue(second) == false || queue.TryDequeue(third) ||
+      first != 1 || second != 2) {
+    cerr << "queue of size 1 is not correct\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+/// \brief  iterate data with a single buffered mini-batch
+int test_data_iter(const char* path, size_t data_num) {
+  pario::DataIter iter(8, 1);
+  int pass_num = 2;
+  if (iter.AddReader(path, "svm", pass_num) != Status_OK) {
+    return Status_IO_Error;
+  }
+  size_t num = 0;
+  pario::MiniBatch* mb = nullptr;
+  while ((mb = iter.Next(mb)) != nullptr) num += mb->size();
+  if (num != data_num * pass_num) {
+    cerr << "iterate data with one buffered mini-batch failed\n";
+    return Status_Error;
+  }
+  return Status_OK;
+}
+
+int main(int argc, char** argv) {
+  if (test_park() != Status_OK || test_small_queue() != Status_OK ||
+      test_data_iter("data/a1a", 1605) != Status_OK) {
+    return -1;
+  }
+
+  size_t item_num = 200000;
+  if (argc == 2) item_num = size_t(atol(argv[1]));
+  int cases[][3] = {{1, 1, 1}, {1, 1, 2}, {1, 1, 64},
+                    {4, 1, 8}, {1, 4, 8}, {4, 4, 8}};
+  for (auto& c : cases) {
+    if (test_queues(c[0], c[1], c[2], item_num) != Status_OK) return -1;
+  }
+  cout << "test ring queue succeed\n";
+  return 0;
+}
@@ -0,0 +1,160 @@
+/*********************************************************************************
+*     File Name           :     test_simd.cc
+*     Created By          :     yuewu
+*     Description         :     test the SIMD kernels of sparse-dense operations
+**********************************************************************************/
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <sol/math/vector.h>
+#include <sol/math/sparse_vector.h>
+#include <sol/util/error_code.h>
+#include <sol/util/util.h>
+
+using namespace sol;
+using namespace sol::math;
+using namespace sol::math::expr;
+using namespace std;
+
+const char* level_name(SIMDLevel level) {
+  switch (level) {
+    case SIMDLevel::AVX512:
+      return "avx512";
+    case SIMDLevel::AVX2:
+      return "avx2";
+    default:
+      return "scalar";
+  }
+}
+
+/// \brief  check the kernels against the scalar loops on random data
+int check_kernels(size_t dim, size_t nnz, bool duplicate, mt19937& gen) {
+  uniform_real_distribution<float> dis(-1, 1);
+  uniform_int_distribution<index_t> idx_dis(1, index_t(dim - 1));
+
+  Vector<float> w(dim);
+  w.slice_op([&](float& val) { val = dis(gen); });
+  SVector<float> x;
+  for (size_t i = 0; i < nnz; ++i) {
+    index_t idx = duplicate && i % 5 == 1 ? x.index(i - 1) : idx_dis(gen);
+    x.push_back(idx, dis(gen));
+  }
+  if (duplicate == false) {
+    // keep the indexes sorted and unique like the parsed data
+    vector<index_t> indexes(nnz);
+    for (size_t i = 0; i < nnz; ++i) indexes[i] = index_t(1 + i * (dim - 1) / nnz);
+    for (size_t i = 0; i < nnz; ++i) x.index(i) = indexes[i];
+  }
+
+  double expected_dot = 0;
+  vector<float> expected_w(w.begin(), w.end());
+  float eta = 0.3f;
+  for (size_t i = 0; i < nnz; ++i) {
+    expected_dot += double(w[x.index(i)]) * x.value(i);
+    expected_w[x.index(i)] -= eta * x.value(i);
+  }
+
+  float dot = dotmul(w, x);
+  if (fabs(dot - expected_dot) > 1e-4 * (1 + fabs(expected_dot))) {
+    cerr << "dot product failed: " << dot << " vs " << expected_dot << "\n";
+    return -1;
+  }
+  w -= eta * x;
+  for (size_t d = 0; d < dim; ++d) {
+    if (w[d] != expected_w[d]) {
+      cerr << "axpy failed at " << d << ": " << w[d] << " vs "
+           << expected_w[d] << "\n";
+      return -1;
+    }
+  }
+  w += x;
+  w -= x;
+  w += x * eta;
+  return Status_OK;
+}
+
+/// \brief  indexes not less than 2^31 are out of the range of the gather
+/// offsets, the dense array is shifted so that they address a small array
+int check_large_indexes(size_t nnz) {
+  if (sizeof(void*) < 8 || sizeof(index_t) != 4) return Status_OK;
+  const index_t base = index_t(1) << 31;
+  vector<float> buf(nnz), values(nnz);
+  vector<index_t> indexes(nnz);
+  double expected_dot = 0;
+  for (size_t i = 0; i < nnz; ++i) {
+    buf[i] = float(i) * 0.5f;
+    values[i] = 1.f - float(i) * 0.25f;
+    indexes[i] = base + index_t(i);
+    expected_dot += double(buf[i]) * values[i];
+  }
+  float* dense = reinterpret_cast<float*>(
+      reinterpret_cast<uintptr_t>(buf.data()) - uintptr_t(base) * sizeof(float));
+
+  float dot = sparse_dot(dense, indexes.data(), values.data(), nnz);
+  if (fabs(dot - expected_dot) > 1e-4 * (1 + fabs(expected_dot))) {
+    cerr << "dot product with large indexes failed: " << dot << " vs "
+         << expected_dot << "\n";
+    return Status_Error;
+  }
+  sparse_axpy(0.5f, indexes.data(), values.data(), nnz, dense);
+  for (size_t i = 0; i < nnz; ++i) {
+    if (buf[i] != float(i) * 0.5f + 0.5f * values[i]) {
+      cerr << "axpy with large indexes failed at " << i << "\n";
+      return Status_Error;
+    }
+  }
+  return Status_OK;
+}
+
+int main() {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(231);
+#endif
+  SIMDLevel best_level = simd_level();
+  cout << "cpu simd level: " << level_name(best_level) << "\n";
+
+  mt19937 gen(0);
+  size_t nnzs[] = {0, 1, 7, 8, 15, 16, 17, 33, 200, 1001};
+  SIMDLevel levels[] = {SIMDLevel::Scalar, SIMDLevel::AVX2, SIMDLevel::AVX512};
+  for (SIMDLevel level : levels) {
+    if (int(level) > int(best_level)) break;
+    if (set_simd_level(level) != level) {
+      cerr << "set simd level " << level_name(level) << " failed\n";
+      return -1;
+    }
+    for (size_t nnz : nnzs) {
+      if (check_kernels(4096, nnz, false, gen) != Status_OK ||
+          check_kernels(4096, nnz, true, gen) != Status_OK ||
+          check_large_indexes(nnz) != Status_OK) {
+        cerr << "check " << level_name(level) << " kernels with " << nnz
+             << " features failed\n";
+        return -1;
+      }
+    }
+
+    // benchmark
+    SVector<float> x;
+    Vector<float> w(1 << 20);
+    w = 0.5f;
+    for (index_t i = 0; i < 200; ++i) x.push_back(i * 5000 + 1, 0.1f);
+    float sum = 0;
+    double start_time = get_current_time();
+    for (int iter = 0; iter < 200000; ++iter) {
+      sum += dotmul(w, x);
+      w -= 1e-6f * x;
+    }
+    cout << level_name(level) << ": 200000 dot and axpy with 200 features in "
+         << get_current_time() - start_time << " seconds (" << sum << ")\n";
+  }
+  set_simd_level(best_level);
+  cout << "test simd succeed\n";
+  return 0;
+}
@@ -84,9 +84,13 @@ int train(cmdline::parser& parser) {
   if (ret == Status_OK) {
     data_iter = sol_CreateDataIter(parser.get<int>("batchsize"),
                                    parser.get<int>("bufsize"));
-    ret = sol_LoadData(data_iter, parser.get<string>("input").c_str(),
-                       parser.get<string>("format").c_str(),
-                       parser.get<int>("pass"));
+    sol_SetMaxRunningReaderNum(data_iter, parser.get<int>("readers"));
+    for (const string& path : split(parser.get<string>("input"), ',')) {
+      ret = sol_LoadData(data_iter, path.c_str(),
+                         parser.get<string>("format").c_str(),
+                         parser.get<int>("pass"));
+      if (ret != Status_OK) break;
+    }
   }
 
   if (ret == Status_OK) {
@@ -95,7 +99,11 @@ int train(cmdline::parser& parser) {
 
     // save model
     if (parser.exist("output")) {
-      ret = sol_SaveModel(model, parser.get<string>("output").c_str());
+      if (parser.exist("binary")) {
+        ret = sol_SaveModelBinary(model, parser.get<string>("output").c_str());
+      } else {
+        ret = sol_SaveModel(model, parser.get<string>("output").c_str());
+      }
     }
   }
 
@@ -125,8 +133,12 @@ int test(cmdline::parser& parser) {
   if (ret == Status_OK) {
     data_iter = sol_CreateDataIter(parser.get<int>("batchsize"),
                                    parser.get<int>("bufsize"));
-    ret = sol_LoadData(data_iter, parser.get<string>("input").c_str(),
-                       parser.get<string>("format").c_str(), 1);
+    sol_SetMaxRunningReaderNum(data_iter, parser.get<int>("readers"));
+    for (const string& path : split(parser.get<string>("input"), ',')) {
+      ret = sol_LoadData(data_iter, path.c_str(),
+                         parser.get<string>("format").c_str(), 1);
+      if (ret != Status_OK) break;
+    }
   }
   if (ret == Status_OK) {
     const char* output_path = nullptr;
@@ -164,15 +176,19 @@ void getparser(int argc, char** argv, cmdline::parser& parser) {
   parser.add<string>("task", 't', "task(train or test)", false, "", "train",
                      cmdline::oneof<string>("train", "test"));
   // input & output
-  parser.add<string>("input", 'i', "input file", true, "io");
+  parser.add<string>("input", 'i', "input files, separated by commas", true,
+                     "io");
   parser.add<string>("format", 'f', "dataset format", false, "io", "svm",
-                     cmdline::oneof<string>("csv", "svm", "bin"));
+                     cmdline::oneof<string>("csv", "svm", "bin", "bin2",
+                                            "mmapbin"));
   parser.add<int>("classes", 'c', "class number", false, "io", 2);
   parser.add<int>("pass", 'p', "number of passes", false, "io", 1);
   parser.add<string>("dim", 'd', "dimension of features", false, "io");
   parser.add<int>("batchsize", 'b', "batch size", false, "io", 256);
   parser.add<int>("bufsize", 0, "number of buffered minibatches", false, "io",
                   2);
+  parser.add<int>("readers", 0, "maximum number of input files read at the "
+                  "same time", false, "io", 1);
   parser.add<string>("output", 'o',
                      "output model(train) or predict results(test)", false,
                      "io");
@@ -182,6 +198,7 @@ void getparser(int argc, char** argv, cmdline::parser& parser) {
   parser.add<string>("model", 'm', "model to preload, required for test", false,
                      "model");
   parser.add<string>("filter", 0, "filtered features", false, "model");
+  parser.add("binary", 0, "save the model in the memory-mappable binary format");
   parser.add<string>(
       "params", 0, "model parameters, in the format 'param=val;param=val;...'",
       false, "model");
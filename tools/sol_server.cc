@@ -0,0 +1,539 @@
+/*********************************************************************************
+*     File Name           :     sol_server.cc
+*     Created By          :     yuewu
+*     Description         :     scoring server of sol, the model is loaded once
+*                                 and reloaded when the model file changes
+**********************************************************************************/
+
+#include <string>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#if _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include <sol/sol.h>
+#include <sol/pario/svm_reader.h>
+#include <sol/pario/numeric_parser.h>
+#include <sol/util/monitor.h>
+#include <sol/util/thread_task.h>
+#include <cmdline/cmdline.h>
+
+using namespace sol;
+using namespace sol::pario;
+using namespace sol::model;
+using namespace std;
+
+void getparser(int argc, char** argv, cmdline::parser&);
+int serve(cmdline::parser& parser);
+
+int main(int argc, char** argv) {
+// check memory leak in VC++
+#if defined(_MSC_VER) && defined(_DEBUG)
+  int tmpFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
+  tmpFlag |= _CRTDBG_LEAK_CHECK_DF;
+  _CrtSetDbgFlag(tmpFlag);
+//_CrtSetBreakAlloc(231);
+#endif
+
+  cmdline::parser parser;
+  getparser(argc, argv, parser);
+
+  return serve(parser);
+}
+
+/// \brief  microseconds from a fixed time point, for latencies
+inline double now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// \brief  a line of request, and its response once predicted
+struct Request {
+  DataPoint x;
+  std::string response;
+  // time when the request is received
+  double start_time;
+  // number of unfinished requests of the connection
+  int* pending_num;
+  Monitor* done;
+};
+
+/// \brief  latencies of the recent requests
+class LatencyStats {
+ public:
+  LatencyStats(size_t window = 100000)
+      : window_(window), next_(0), total_num_(0) {}
+
+  void Add(double latency) {
+    this->lock_.lock();
+    if (this->latencies_.size() < this->window_) {
+      this->latencies_.push_back(latency);
+    } else {
+      this->latencies_[this->next_] = latency;
+      this->next_ = (this->next_ + 1) % this->window_;
+    }
+    ++this->total_num_;
+    this->lock_.unlock();
+  }
+
+  /// \brief  number of requests, and p50 and p99 latencies in microseconds
+  std::string Report() {
+    this->lock_.lock();
+    vector<double> latencies = this->latencies_;
+    size_t total_num = this->total_num_;
+    this->lock_.unlock();
+
+    double p50 = 0, p99 = 0;
+    if (latencies.size() > 0) {
+      size_t k50 = latencies.size() / 2;
+      size_t k99 = latencies.size() * 99 / 100;
+      nth_element(latencies.begin(), latencies.begin() + k50, latencies.end());
+      p50 = latencies[k50];
+      nth_element(latencies.begin(), latencies.begin() + k99, latencies.end());
+      p99 = latencies[k99];
+    }
+    char buf[128];
+    snprintf(buf, sizeof(buf), "requests %llu p50 %.1fus p99 %.1fus",
+             (unsigned long long)total_num, p50, p99);
+    return buf;
+  }
+
+ protected:
+  Mutex lock_;
+  vector<double> latencies_;
+  size_t window_;
+  size_t next_;
+  size_t total_num_;
+};
+
+/// \brief  the model in service, replaced when the model file changes
+class ModelHolder {
+ public:
+  ModelHolder(const string& path) : path_(path), mtime_(0), size_(0) {}
+
+  /// \brief  load the model if the file is changed
+  ///
+  /// \param force whether to load even if the file is not changed
+  ///
+  /// \return Status_OK if the model in service is valid
+  int Reload(bool force = false) {
+    struct stat st;
+    if (stat(this->path_.c_str(), &st) != 0) {
+      fprintf(stderr, "stat model file %s failed\n", this->path_.c_str());
+      return this->get() != nullptr ? Status_OK : Status_IO_Error;
+    }
+    if (force == false && this->get() != nullptr &&
+        st.st_mtime == this->mtime_ && st.st_size == this->size_) {
+      return Status_OK;
+    }
+
+    shared_ptr<Model> model(Model::Load(this->path_));
+    if (model == nullptr) {
+      // keep serving the old model
+      fprintf(stderr, "load model %s failed\n", this->path_.c_str());
+      return this->get() != nullptr ? Status_OK : Status_Invalid_Format;
+    }
+    model->BeginPredict();
+    this->lock_.lock();
+    this->model_ = model;
+    this->mtime_ = st.st_mtime;
+    this->size_ = st.st_size;
+    this->lock_.unlock();
+    fprintf(stderr, "model %s is loaded\n", this->path_.c_str());
+    return Status_OK;
+  }
+
+  /// \brief  the model in service, kept valid by the returned pointer
+  shared_ptr<Model> get() {
+    this->lock_.lock();
+    shared_ptr<Model> model = this->model_;
+    this->lock_.unlock();
+    return model;
+  }
+
+ protected:
+  string path_;
+  Mutex lock_;
+  shared_ptr<Model> model_;
+  time_t mtime_;
+  off_t size_;
+};
+
+/// \brief  predict the requests with worker threads, concurrent requests are
+/// predicted in batches
+class Scorer {
+ public:
+  Scorer(ModelHolder& models, int thread_num, int batch_size)
+      : models_(models), batch_size_(batch_size), stop_(false) {
+    for (int i = 0; i < thread_num; ++i) {
+      this->workers_.push_back(
+          make_shared<FunctionTask>([this]() { this->Work(); }));
+      this->workers_.back()->Start();
+    }
+  }
+
+  ~Scorer() {
+    this->queue_.lock();
+    this->stop_ = true;
+    this->queue_.notify_all();
+    this->queue_.unlock();
+    for (shared_ptr<FunctionTask>& worker : this->workers_) worker->Join();
+  }
+
+  /// \brief  predict the requests, return when all are done
+  void Predict(vector<Request>& requests, size_t num) {
+    if (num == 0) return;
+    int pending_num = int(num);
+    Monitor done;
+    this->queue_.lock();
+    for (size_t i = 0; i < num; ++i) {
+      requests[i].pending_num = &pending_num;
+      requests[i].done = &done;
+      this->requests_.push_back(&requests[i]);
+    }
+    this->queue_.notify_all();
+    this->queue_.unlock();
+
+    done.lock();
+    while (pending_num > 0) done.wait();
+    done.unlock();
+  }
+
+  LatencyStats& stats() { return this->stats_; }
+
+ protected:
+  void Work() {
+    vector<Request*> batch;
+    vector<float> scores;
+    while (true) {
+      // take the queued requests, up to a batch
+      this->queue_.lock();
+      while (this->requests_.empty() && this->stop_ == false) {
+        this->queue_.wait();
+      }
+      if (this->requests_.empty()) {
+        this->queue_.unlock();
+        break;
+      }
+      size_t num = (std::min)(this->requests_.size(), this->batch_size_);
+      batch.assign(this->requests_.begin(), this->requests_.begin() + num);
+      this->requests_.erase(this->requests_.begin(),
+                            this->requests_.begin() + num);
+      this->queue_.unlock();
+
+      // the model is not replaced during the batch
+      shared_ptr<Model> model = this->models_.get();
+      scores.resize(model->clf_num());
+      char buf[64];
+      for (Request* request : batch) {
+        model->PreProcess(request->x);
+        label_t label = model->Predict(request->x, scores.data());
+        string& response = request->response;
+        response.assign(buf, snprintf(buf, sizeof(buf), "%lld",
+                                      (long long)label));
+        for (float score : scores) {
+          response.append(buf,
+                          snprintf(buf, sizeof(buf), "\t%g", double(score)));
+        }
+        response.push_back('\n');
+      }
+
+      double end_time = now_us();
+      for (Request* request : batch) {
+        this->stats_.Add(end_time - request->start_time);
+        request->done->lock();
+        if (--(*request->pending_num) == 0) request->done->notify();
+        request->done->unlock();
+      }
+    }
+  }
+
+ protected:
+  ModelHolder& models_;
+  size_t batch_size_;
+  Monitor queue_;
+  std::deque<Request*> requests_;
+  bool stop_;
+  vector<shared_ptr<FunctionTask>> workers_;
+  LatencyStats stats_;
+};
+
+/// \brief  write all the data to the file descriptor
+bool write_all(int fd, const char* data, size_t len) {
+  while (len > 0) {
+#if _WIN32
+    int ret = _write(fd, data, (unsigned int)len);
+#else
+    ssize_t ret = write(fd, data, len);
+#endif
+    if (ret <= 0) return false;
+    data += ret;
+    len -= size_t(ret);
+  }
+  return true;
+}
+
+/// \brief  serve the requests of a connection until it is closed
+///
+/// Each line is a request in libsvm format (the label is ignored), answered
+/// by a line of the predicted label and the scores separated by tabs. The
+/// lines received together are predicted together and answered in order.
+/// Lines starting with '#' are commands: '#stats' for the latencies, '#reload'
+/// to reload the model, and '#shutdown' to stop the server.
+///
+/// \return false if the server is asked to shut down
+bool serve_connection(int in_fd, int out_fd, Scorer& scorer,
+                      ModelHolder& models) {
+  // the parser reads kPadding bytes after the end of a line
+  size_t buf_size = 1 << 16;
+  vector<char> buf(buf_size + NumericParser::kPadding, 0);
+  size_t buf_len = 0;
+  vector<Request> requests;
+  string output;
+  bool running = true;
+  while (running) {
+    if (buf_len == buf_size) {
+      buf_size *= 2;
+      buf.resize(buf_size + NumericParser::kPadding, 0);
+    }
+#if _WIN32
+    int len = _read(in_fd, buf.data() + buf_len,
+                    (unsigned int)(buf_size - buf_len));
+#else
+    ssize_t len = read(in_fd, buf.data() + buf_len, buf_size - buf_len);
+#endif
+    if (len <= 0) break;
+    buf_len += size_t(len);
+
+    // parse the complete lines
+    size_t num = 0;
+    char* line = buf.data();
+    char* end = buf.data() + buf_len;
+    output.clear();
+    while (true) {
+      char* eol = (char*)memchr(line, '\n', end - line);
+      if (eol == nullptr) break;
+      char* p = eol;
+      while (p > line && isspace((unsigned char)p[-1])) --p;
+      *p = '\0';
+      char* next = eol + 1;
+      if (*line == '#') {
+        // answer the requests before the command
+        scorer.Predict(requests, num);
+        for (size_t i = 0; i < num; ++i) output += requests[i].response;
+        num = 0;
+        string cmd(line);
+        if (cmd == "#stats") {
+          output += scorer.stats().Report() + "\n";
+        } else if (cmd == "#reload") {
+          output += models.Reload(true) == Status_OK ? "ok\n"
+                                                     : "error: reload\n";
+        } else if (cmd == "#shutdown") {
+          output += "ok\n";
+          running = false;
+          break;
+        } else {
+          output += "error: unknown command\n";
+        }
+      } else if (*line != '\0') {
+        if (num == requests.size()) requests.resize(num + 1);
+        Request& request = requests[num];
+        request.start_time = now_us();
+        if (SVMReader::ParseLine(line, request.x) == Status_OK) {
+          ++num;
+        } else {
+          scorer.Predict(requests, num);
+          for (size_t i = 0; i < num; ++i) output += requests[i].response;
+          num = 0;
+          output += "error: invalid request\n";
+        }
+      }
+      line = next;
+    }
+    scorer.Predict(requests, num);
+    for (size_t i = 0; i < num; ++i) output += requests[i].response;
+    if (write_all(out_fd, output.data(), output.size()) == false) break;
+
+    // keep the incomplete line
+    buf_len = size_t(end - line);
+    memmove(buf.data(), line, buf_len);
+  }
+  return running;
+}
+
+#if _WIN32
+int serve_socket(const string& path, Scorer& scorer, ModelHolder& models) {
+  fprintf(stderr, "unix domain socket is not supported on this platform\n");
+  return Status_Invalid_Argument;
+}
+#else
+int serve_socket(const string& path, Scorer& scorer, ModelHolder& models) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  if (path.size() >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "socket path %s is too long\n", path.c_str());
+    return Status_Invalid_Argument;
+  }
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(path.c_str());
+  if (listen_fd < 0 ||
+      ::bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+      listen(listen_fd, 128) != 0) {
+    fprintf(stderr, "listen on %s failed\n", path.c_str());
+    if (listen_fd >= 0) close(listen_fd);
+    return Status_IO_Error;
+  }
+  fprintf(stderr, "listening on %s\n", path.c_str());
+
+  // connections are served by their own threads, each flagged when it is done
+  struct Connection {
+    shared_ptr<FunctionTask> task;
+    shared_ptr<std::atomic<bool>> done;
+  };
+  Mutex conn_lock;
+  vector<int> conn_fds;
+  vector<Connection> conns;
+  std::atomic<bool> running(true);
+  while (running) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    // reclaim the threads of the closed connections
+    auto finished = [](const Connection& conn) {
+      if (conn.done->load() == false) return false;
+      conn.task->Join();
+      return true;
+    };
+    conns.erase(remove_if(conns.begin(), conns.end(), finished), conns.end());
+
+    conn_lock.lock();
+    conn_fds.push_back(fd);
+    conn_lock.unlock();
+    Connection conn;
+    conn.done = make_shared<std::atomic<bool>>(false);
+    shared_ptr<std::atomic<bool>> done = conn.done;
+    conn.task = make_shared<FunctionTask>([&, fd, done]() {
+      if (serve_connection(fd, fd, scorer, models) == false) {
+        running = false;
+        // wake up the accept
+        shutdown(listen_fd, SHUT_RDWR);
+      }
+      conn_lock.lock();
+      conn_fds.erase(find(conn_fds.begin(), conn_fds.end(), fd));
+      close(fd);
+      conn_lock.unlock();
+      *done = true;
+    });
+    conn.task->Start();
+    conns.push_back(conn);
+  }
+
+  // stop the other connections
+  conn_lock.lock();
+  for (int fd : conn_fds) shutdown(fd, SHUT_RDWR);
+  conn_lock.unlock();
+  for (Connection& conn : conns) conn.task->Join();
+  close(listen_fd);
+  unlink(path.c_str());
+  return Status_OK;
+}
+#endif
+
+int serve(cmdline::parser& parser) {
+  if (parser.rest().size() != 1) {
+    fprintf(stderr, "%s\n", parser.usage().c_str());
+    return Status_Invalid_Argument;
+  }
+#if !_WIN32
+  // closed connections are detected by the failed writes
+  signal(SIGPIPE, SIG_IGN);
+#endif
+
+  ModelHolder models(parser.rest()[0]);
+  int ret = models.Reload();
+  if (ret != Status_OK) return ret;
+
+  // check the model file for changes
+  std::atomic<bool> running(true);
+  int interval = parser.get<int>("reload");
+  FunctionTask watcher([&]() {
+    int waited = 0;
+    while (running) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      waited += 10;
+      if (waited >= interval) {
+        models.Reload();
+        waited = 0;
+      }
+    }
+  });
+  if (interval > 0) watcher.Start();
+
+  {
+    Scorer scorer(models, (std::max)(parser.get<int>("threads"), 1),
+                  size_t((std::max)(parser.get<int>("batchsize"), 1)));
+    if (parser.exist("socket")) {
+      ret = serve_socket(parser.get<string>("socket"), scorer, models);
+    } else {
+      serve_connection(0, 1, scorer, models);
+    }
+    fprintf(stderr, "%s\n", scorer.stats().Report().c_str());
+  }
+
+  running = false;
+  watcher.Join();
+  return ret;
+}
+
+void getparser(int argc, char** argv, cmdline::parser& parser) {
+  parser.add<string>("socket", 's',
+                     "unix domain socket to listen on, requests are read from "
+                     "stdin if not set",
+                     false);
+  parser.add<int>("threads", 't', "number of threads to predict the requests",
+                  false, "", 1);
+  parser.add<int>("batchsize", 'b',
+                  "maximum number of requests predicted together", false, "",
+                  256);
+  parser.add<int>("reload", 0,
+                  "interval in milliseconds to check the model file for "
+                  "changes, 0 to disable",
+                  false, "", 1000);
+  parser.add("help", 'h', "print this message");
+  parser.footer("model_file");
+
+  bool ok = parser.parse(argc, argv);
+
+  if ((argc == 1 && !ok) || parser.exist("help")) {
+    fprintf(stderr, "%s\n", parser.usage().c_str());
+    exit(0);
+  }
+
+  if (!ok) {
+    fprintf(stderr, "%s\n", parser.error().c_str());
+    fprintf(stderr, "%s\n", parser.usage().c_str());
+    exit(1);
+  }
+}
@@ -9,6 +9,7 @@
 #include <string>
 #include <cstdlib>
 #include <memory>
+#include <algorithm>
 
 #include <sol/sol.h>
 #include <sol/util/str_util.h>
@@ -54,19 +55,24 @@ int test(cmdline::parser& parser) {
 
   shared_ptr<Model> model(Model::Load(model_path));
   if (model == nullptr) return Status_Invalid_Argument;
-  if (parser.exist("filter")) {
-    try {
+  try {
+    model->SetParameter("threads", to_string(parser.get<int>("threads")));
+    if (parser.exist("filter")) {
       model->SetParameter("filter", parser.get<string>("filter"));
     }
-    catch (invalid_argument& err) {
-      fprintf(stderr, "%s\n", err.what());
-      return Status_Invalid_Argument;
-    }
+  }
+  catch (invalid_argument& err) {
+    fprintf(stderr, "%s\n", err.what());
+    return Status_Invalid_Argument;
   }
 
-  // load data
-  DataIter iter(parser.get<int>("batchsize"), parser.get<int>("bufsize"));
-  int ret = iter.AddReader(input_path, parser.get<string>("format"));
+  // load data, each thread needs at least a mini-batch to predict
+  int thread_num = parser.get<int>("threads");
+  DataIter iter(parser.get<int>("batchsize"),
+                (std::max)(parser.get<int>("bufsize"), 2 * thread_num));
+  // predictions are written in the original data order
+  int ret = iter.AddReader(input_path, parser.get<string>("format"), 1,
+                           parser.get<int>("parsers"), true);
   if (ret != Status_OK) return ret;
 
   double start_time = sol::get_current_time();
@@ -87,9 +93,14 @@ int test(cmdline::parser& parser) {
 void getparser(int argc, char** argv, cmdline::parser& parser) {
   // pario related options
   parser.add<string>("format", 'f', "dataset format", false, "", "svm",
-                     cmdline::oneof<string>("csv", "svm", "bin"));
+                     cmdline::oneof<string>("csv", "svm", "bin", "bin2",
+                                            "mmapbin"));
   parser.add<int>("batchsize", 'b', "batch size", false, "", 256);
   parser.add<int>("bufsize", 0, "number of buffered minibatches", false, "", 2);
+  parser.add<int>("parsers", 0, "number of threads to parse the text data",
+                  false, "", 1);
+  parser.add<int>("threads", 't', "number of threads to predict the data",
+                  false, "", 1);
 
   parser.add<string>("filter", 0, "filtered features", false);
   parser.add("help", 'h', "print this message");
@@ -12,6 +12,7 @@
 
 #include <sol/sol.h>
 #include <sol/util/str_util.h>
+#include <sol/util/profiler.h>
 #include <cmdline/cmdline.h>
 
 using namespace sol;
@@ -80,21 +81,49 @@ int train(cmdline::parser& parser) {
 
   // load data
   DataIter iter(parser.get<int>("batchsize"), parser.get<int>("bufsize"));
-  int ret = iter.AddReader(input_path, parser.get<string>("format"),
-                           parser.get<int>("pass"));
+  iter.set_shuffle_window(size_t(parser.get<int>("window")));
+  iter.set_max_running_reader_num(parser.get<int>("readers"));
+  // each data file is read by its own reader
+  const vector<string>& input_paths = split(input_path, ',');
+  int ret = Status_OK;
+  for (size_t i = 0; i < input_paths.size() && ret == Status_OK; ++i) {
+    if (parser.exist("cache")) {
+      string cache_path = parser.get<string>("cachefile");
+      if (cache_path.length() > 0 && input_paths.size() > 1) {
+        cache_path += "." + to_string(i);
+      }
+      ret = iter.AddCachedReader(input_paths[i], parser.get<string>("format"),
+                                 parser.get<int>("pass"),
+                                 parser.exist("reshuffle"),
+                                 size_t(parser.get<int>("cachesize")) << 20,
+                                 cache_path);
+    } else {
+      ret = iter.AddReader(input_paths[i], parser.get<string>("format"),
+                           parser.get<int>("pass"), parser.get<int>("parsers"),
+                           parser.exist("keeporder"));
+    }
+  }
   if (ret != Status_OK) return ret;
 
   cout << "Model Information: \n" << model->model_info() << "\n";
+  if (parser.exist("profile")) {
+    Profiler::Reset();
+    Profiler::Enable(true);
+  }
   double start_time = sol::get_current_time();
   float err_rate = model->Train(iter);
   double end_time = sol::get_current_time();
   fprintf(stdout, "training accuracy: %.4f\n", 1.f - err_rate);
   fprintf(stdout, "training time: %.3f seconds\n", end_time - start_time);
+  if (parser.exist("profile")) {
+    Profiler::Enable(false);
+    fprintf(stdout, "pipeline profile:\n%s", Profiler::Report().c_str());
+  }
   fprintf(stdout, "model sparsity: %.4f%%\n", model->model_sparsity() * 100.f);
 
   // save model
   if (!output_path.empty()) {
-    model->Save(output_path);
+    model->Save(output_path, parser.exist("binary"));
     fprintf(stdout, "save time: %.3f seconds\n", get_current_time() - end_time);
   }
 
@@ -121,17 +150,44 @@ void getparser(int argc, char** argv, cmdline::parser& parser) {
 
   // input & output
   parser.add<string>("format", 'f', "dataset format", false, "io", "svm",
-                     cmdline::oneof<string>("csv", "svm", "bin"));
+                     cmdline::oneof<string>("csv", "svm", "bin", "bin2",
+                                            "mmapbin"));
   parser.add<int>("classes", 'c', "class number", false, "io", 2);
   parser.add<int>("pass", 'p', "number of passes", false, "io", 1);
   parser.add<string>("dim", 'd', "dimension of features", false, "io");
   parser.add<int>("batchsize", 'b', "batch size", false, "io", 256);
   parser.add<int>("bufsize", 0, "number of buffered minibatches", false, "io",
                   2);
+  parser.add<int>("parsers", 0, "number of threads to parse the text data",
+                  false, "io", 1);
+  parser.add<int>("readers", 0,
+                  "maximum number of data files read at the same time, the "
+                  "files are separated by commas in the input",
+                  false, "io", 1);
+  parser.add("keeporder", 0,
+             "keep the original data order when parsed by multiple threads");
+  parser.add("cache", 0,
+             "parse the data in the first pass and read later passes from "
+             "the cache");
+  parser.add<int>("cachesize", 0,
+                  "maximum size of the in-memory cache in MB, 0 for no limit",
+                  false, "io", 0);
+  parser.add<string>("cachefile", 0,
+                     "file to spill the cache if it exceeds cachesize", false,
+                     "io", "");
+  parser.add("reshuffle", 0, "shuffle the cached data before each pass");
+  parser.add<int>("window", 0,
+                  "number of instances in the window to shuffle the data, "
+                  "refilled by whole mini-batches, 0 to read the data in "
+                  "order",
+                  false, "io", 0);
 
   // model setting
   parser.add<string>("algo", 'a', "learning algorithm", false, "model", "ogd");
   parser.add<string>("model", 'm', "path to pre-trained model", false, "model");
+  parser.add("binary", 0, "save the model in the memory-mappable binary format");
+  parser.add("profile", 0,
+             "show the time spent in each stage of the training pipeline");
   parser.add<string>(
       "params", 0, "model parameters, in the format 'param=val;param=val;...'",
       false, "model");